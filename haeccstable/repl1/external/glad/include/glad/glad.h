@@ -2,6 +2,7 @@
 #define GLAD_GL_H_
 
 #include <stddef.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -41,8 +42,17 @@ typedef double GLclampd;
 typedef char GLchar;
 typedef ptrdiff_t GLsizeiptr;
 typedef ptrdiff_t GLintptr;
+typedef uint64_t GLuint64;
+typedef struct __GLsync *GLsync;
 
 #define GL_FALSE 0
+#define GL_SYNC_GPU_COMMANDS_COMPLETE 0x9117
+#define GL_ALREADY_SIGNALED 0x911A
+#define GL_TIMEOUT_EXPIRED 0x911B
+#define GL_CONDITION_SATISFIED 0x911C
+#define GL_WAIT_FAILED 0x911D
+#define GL_EXTENSIONS 0x1F03
+#define GL_NUM_EXTENSIONS 0x821D
 #define GL_TRUE 1
 #define GL_COLOR_BUFFER_BIT 0x00004000
 #define GL_DEPTH_BUFFER_BIT 0x00000100
@@ -130,6 +140,19 @@ typedef GLenum (APIENTRYP PFNGLCHECKFRAMEBUFFERSTATUSPROC)(GLenum target);
 typedef void (APIENTRYP PFNGLDELETETEXTURESPROC)(GLsizei n, const GLuint *textures);
 typedef void (APIENTRYP PFNGLDELETEPROGRAMPROC)(GLuint program);
 typedef void (APIENTRYP PFNGLGETINTEGERVPROC)(GLenum pname, GLint *data);
+typedef void (APIENTRYP PFNGLFLUSHPROC)(void);
+typedef void (APIENTRYP PFNGLBUFFERSUBDATAPROC)(GLenum target, GLintptr offset, GLsizeiptr size, const void *data);
+typedef GLuint (APIENTRYP PFNGLGETUNIFORMBLOCKINDEXPROC)(GLuint program, const GLchar *uniformBlockName);
+typedef void (APIENTRYP PFNGLUNIFORMBLOCKBINDINGPROC)(GLuint program, GLuint uniformBlockIndex, GLuint uniformBlockBinding);
+typedef void (APIENTRYP PFNGLBINDBUFFERBASEPROC)(GLenum target, GLuint index, GLuint buffer);
+typedef void (APIENTRYP PFNGLGETACTIVEUNIFORMPROC)(GLuint program, GLuint index, GLsizei bufSize, GLsizei *length, GLint *size, GLenum *type, GLchar *name);
+typedef void (APIENTRYP PFNGLREADPIXELSPROC)(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, void *pixels);
+typedef void (APIENTRYP PFNGLFINISHPROC)(void);
+typedef void (APIENTRYP PFNGLTEXSUBIMAGE2DPROC)(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const void *pixels);
+typedef GLsync (APIENTRYP PFNGLFENCESYNCPROC)(GLenum condition, GLbitfield flags);
+typedef GLenum (APIENTRYP PFNGLCLIENTWAITSYNCPROC)(GLsync sync, GLbitfield flags, GLuint64 timeout);
+typedef void (APIENTRYP PFNGLDELETESYNCPROC)(GLsync sync);
+typedef const GLubyte* (APIENTRYP PFNGLGETSTRINGIPROC)(GLenum name, GLuint index);
 
 GLAPI PFNGLCLEARPROC glClear;
 GLAPI PFNGLCLEARCOLORPROC glClearColor;
@@ -181,6 +204,19 @@ GLAPI PFNGLCHECKFRAMEBUFFERSTATUSPROC glCheckFramebufferStatus;
 GLAPI PFNGLDELETETEXTURESPROC glDeleteTextures;
 GLAPI PFNGLDELETEPROGRAMPROC glDeleteProgram;
 GLAPI PFNGLGETINTEGERVPROC glGetIntegerv;
+GLAPI PFNGLFLUSHPROC glFlush;
+GLAPI PFNGLBUFFERSUBDATAPROC glBufferSubData;
+GLAPI PFNGLGETUNIFORMBLOCKINDEXPROC glGetUniformBlockIndex;
+GLAPI PFNGLUNIFORMBLOCKBINDINGPROC glUniformBlockBinding;
+GLAPI PFNGLBINDBUFFERBASEPROC glBindBufferBase;
+GLAPI PFNGLGETACTIVEUNIFORMPROC glGetActiveUniform;
+GLAPI PFNGLREADPIXELSPROC glReadPixels;
+GLAPI PFNGLFINISHPROC glFinish;
+GLAPI PFNGLTEXSUBIMAGE2DPROC glTexSubImage2D;
+GLAPI PFNGLFENCESYNCPROC glFenceSync;
+GLAPI PFNGLCLIENTWAITSYNCPROC glClientWaitSync;
+GLAPI PFNGLDELETESYNCPROC glDeleteSync;
+GLAPI PFNGLGETSTRINGIPROC glGetStringi;
 
 typedef void* (*GLADloadproc)(const char *name);
 int gladLoadGLLoader(GLADloadproc load);
@@ -51,7 +51,20 @@ PFNGLFRAMEBUFFERRENDERBUFFERPROC glFramebufferRenderbuffer;
 PFNGLCHECKFRAMEBUFFERSTATUSPROC glCheckFramebufferStatus;
 PFNGLDELETETEXTURESPROC glDeleteTextures;
 PFNGLDELETEPROGRAMPROC glDeleteProgram;
+PFNGLFLUSHPROC glFlush;
 PFNGLGETINTEGERVPROC glGetIntegerv;
+PFNGLGETUNIFORMBLOCKINDEXPROC glGetUniformBlockIndex;
+PFNGLBUFFERSUBDATAPROC glBufferSubData;
+PFNGLBINDBUFFERBASEPROC glBindBufferBase;
+PFNGLUNIFORMBLOCKBINDINGPROC glUniformBlockBinding;
+PFNGLREADPIXELSPROC glReadPixels;
+PFNGLGETACTIVEUNIFORMPROC glGetActiveUniform;
+PFNGLTEXSUBIMAGE2DPROC glTexSubImage2D;
+PFNGLFINISHPROC glFinish;
+PFNGLFENCESYNCPROC glFenceSync;
+PFNGLCLIENTWAITSYNCPROC glClientWaitSync;
+PFNGLDELETESYNCPROC glDeleteSync;
+PFNGLGETSTRINGIPROC glGetStringi;
 
 int gladLoadGLLoader(GLADloadproc load) {
     glClear = (PFNGLCLEARPROC)load("glClear");
@@ -104,6 +117,19 @@ int gladLoadGLLoader(GLADloadproc load) {
     glDeleteTextures = (PFNGLDELETETEXTURESPROC)load("glDeleteTextures");
     glDeleteProgram = (PFNGLDELETEPROGRAMPROC)load("glDeleteProgram");
     glGetIntegerv = (PFNGLGETINTEGERVPROC)load("glGetIntegerv");
+    glFlush = (PFNGLFLUSHPROC)load("glFlush");
+    glBufferSubData = (PFNGLBUFFERSUBDATAPROC)load("glBufferSubData");
+    glGetUniformBlockIndex = (PFNGLGETUNIFORMBLOCKINDEXPROC)load("glGetUniformBlockIndex");
+    glUniformBlockBinding = (PFNGLUNIFORMBLOCKBINDINGPROC)load("glUniformBlockBinding");
+    glBindBufferBase = (PFNGLBINDBUFFERBASEPROC)load("glBindBufferBase");
+    glGetActiveUniform = (PFNGLGETACTIVEUNIFORMPROC)load("glGetActiveUniform");
+    glReadPixels = (PFNGLREADPIXELSPROC)load("glReadPixels");
+    glFinish = (PFNGLFINISHPROC)load("glFinish");
+    glTexSubImage2D = (PFNGLTEXSUBIMAGE2DPROC)load("glTexSubImage2D");
+    glFenceSync = (PFNGLFENCESYNCPROC)load("glFenceSync");
+    glClientWaitSync = (PFNGLCLIENTWAITSYNCPROC)load("glClientWaitSync");
+    glDeleteSync = (PFNGLDELETESYNCPROC)load("glDeleteSync");
+    glGetStringi = (PFNGLGETSTRINGIPROC)load("glGetStringi");
 
     return glClear != NULL;
 }
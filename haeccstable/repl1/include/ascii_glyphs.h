@@ -0,0 +1,41 @@
+#ifndef ASCII_GLYPHS_H
+#define ASCII_GLYPHS_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Glyph atlas for the ascii process: the ramp's characters (darkest first) from
+// the bitmap font, then four edge glyphs drawn across the whole cell. Each glyph
+// is an 8x8 cell of 0/255 coverage; the atlas image puts them side by side.
+class AsciiGlyphs {
+public:
+    static const int cellSize = 8;
+    static const int edgeGlyphCount = 4;
+    static const int maxRampLength = 64;
+
+    AsciiGlyphs();
+
+    // Returns false with error set if the ramp is empty, too long or has a character
+    // the font can't draw
+    bool build(const std::string& ramp, std::string& error);
+
+    int getRampLength() const { return rampLength; }
+    int getGlyphCount() const { return rampLength + edgeGlyphCount; }
+
+    // Edge glyph for a Sobel orientation (ImageKernels::sobel angle / 64): | / - backslash
+    int getEdgeGlyph(int orientation) const { return rampLength + orientation; }
+
+    // Atlas image, getAtlasWidth() x cellSize, top row first
+    int getAtlasWidth() const { return getGlyphCount() * cellSize; }
+    const std::vector<uint8_t>& getPixels() const { return pixels; }
+    const uint8_t* glyphRow(int glyph, int row) const {
+        return pixels.data() + (size_t)row * getAtlasWidth() + glyph * cellSize;
+    }
+
+private:
+    int rampLength;
+    std::vector<uint8_t> pixels;
+};
+
+#endif // ASCII_GLYPHS_H
@@ -0,0 +1,19 @@
+#ifndef BITMAP_FONT_H
+#define BITMAP_FONT_H
+
+#include <cstdint>
+
+// 5x7 bitmap font covering printable ASCII, shared by the editor's text atlas
+// and the ascii process glyph atlas
+static const int bitmapFontWidth = 5;
+static const int bitmapFontHeight = 7;
+
+int bitmapFontGlyphCount();
+
+// bitmapFontHeight rows, top to bottom; bit 4 is the leftmost pixel
+const uint32_t* bitmapFontGlyph(int index);
+
+// Glyph index for c, or -1 if the font has no glyph for it
+int bitmapFontIndex(char c);
+
+#endif // BITMAP_FONT_H
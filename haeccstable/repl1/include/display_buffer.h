@@ -14,6 +14,8 @@ public:
     void unbind();
     void clear(float r, float g, float b, float a);
     GLuint getTexture() const { return texture; }
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
 
 private:
     int width;
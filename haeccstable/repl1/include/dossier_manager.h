@@ -1,13 +1,20 @@
 #ifndef DOSSIER_MANAGER_H
 #define DOSSIER_MANAGER_H
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <string>
 #include <vector>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <thread>
+#include "dossier_stream.h"
 #include "video_source.h"
 #include "layer.h"
 #include "output_variable.h"
+#include "session_snapshot.h"
 
 // Forward declaration
 struct GLFWmonitor;
@@ -55,17 +62,30 @@ struct LayerInfo {
 };
 
 // Dossier manager for tracking and serializing all state
+// Each top-level JSON section is cached as text and re-serialized only after it
+// changes. Saving is asynchronous: a writer thread serializes the changed sections
+// and replaces the file (write to a temp file, then rename) once changes have
+// settled, so registering objects from the render thread never touches the disk.
 class DossierManager {
 public:
     DossierManager();
+    ~DossierManager();  // Writes pending changes before returning
+
+    DossierManager(const DossierManager&) = delete;
+    DossierManager& operator=(const DossierManager&) = delete;
 
     // Device enumeration
     void updateVideoDevices();
+    void setVideoDevices(std::vector<VideoSource::DeviceInfo> devices);  // Enumerated elsewhere (e.g. on the pool)
     const std::vector<VideoSource::DeviceInfo>& getVideoDevices() const { return videoDevices; }
 
     // Monitor enumeration
     void updateMonitors();
     const std::vector<MonitorInfo>& getMonitors() const { return monitors; }
+    int getPhysicalMonitorCount() const { return physicalMonitorCount; }
+
+    // Resolve an out_var target to a physical monitor (index or name), -1 if virtual/unknown
+    int findPhysicalMonitor(const std::string& target) const;
 
     // Variable tracking
     void registerInputVariable(const std::string& name, int deviceIndex, std::shared_ptr<VideoSource> source);
@@ -84,12 +104,61 @@ public:
     // JSON serialization
     std::string toJSON() const;
 
-    // Save to file
-    bool saveToFile(const std::string& filename) const;
+    // Keep filename up to date: changes are written debounceMillis after they
+    // stop (at most 4x that after the first), on the writer thread
+    void setAutoSave(const std::string& filename, int debounceMillis = 250);
+
+    // Queue a write of filename now (returns without waiting for it); auto-saves
+    // go to filename from then on
+    void saveToFile(const std::string& filename);
+
+    // Encode and write a session snapshot on the writer thread (only the latest
+    // queued one is written)
+    void saveSnapshot(const std::string& filename, SessionSnapshot snapshot);
+
+    // Wait until queued writes are on disk
+    void flush();
+
+    // Stream changes to clients of a Unix domain socket (see DossierStream): the
+    // whole dossier on connect, then a message per change --
+    //   {"seq":N,"type":"set","section":"layers","name":"a","fields":{"opacity":40.00}}
+    //   {"seq":N,"type":"remove","section":"layers","name":"a"}
+    //   {"seq":N,"type":"section","section":{"monitors":[...]}}
+    // set carries only the fields that changed (all of them for a new object),
+    // named as in dossier.json. Messages are built only while someone is connected.
+    bool startStream(const std::string& socketPath);
+    const DossierStream* getStream() const { return stream.get(); }
+
+    // Performance section: sampled hz times a second on the writer thread from
+    // the objects' lock-free counters and the values recorded below, then written
+    // right away, so dossier viewers can poll the file as a live dashboard.
+    // 0 turns it off. Needs the writer thread (setAutoSave or saveToFile).
+    void setPerformanceRate(float hz);
+
+    // Main-loop timings and GPU memory (bytes, -1 = unknown) from the render thread
+    void recordFrame(float millis, float uiMillis);
+    void recordGpuMemory(int64_t bytesInUse);
+
+    // A frame whose video work was skipped because the GPU was still behind
+    void recordSkippedVideoFrame() { skippedVideoFrames.fetch_add(1, std::memory_order_relaxed); }
+
+    // The main loop is waiting for events instead of rendering every vsync
+    void recordLoopIdle(bool idle) { loopIdle.store(idle, std::memory_order_relaxed); }
 
 private:
+    enum Section {
+        SECTION_VIDEO_DEVICES,
+        SECTION_MONITORS,
+        SECTION_INPUT_VARIABLES,
+        SECTION_OUTPUT_VARIABLES,
+        SECTION_LAYERS,
+        SECTION_PERFORMANCE,
+        SECTION_COUNT
+    };
+
     std::vector<VideoSource::DeviceInfo> videoDevices;
     std::vector<MonitorInfo> monitors;
+    int physicalMonitorCount;
 
     std::map<std::string, InputVariableInfo> inputVariables;
     std::map<std::string, OutputVariableInfo> outputVariables;
@@ -100,11 +169,85 @@ private:
     std::map<std::string, std::shared_ptr<OutputVariable>> outputObjects;
     std::map<std::string, std::shared_ptr<Layer>> layerObjects;
 
+    // Serialized sections; stale ones are rebuilt by the next toJSON/write.
+    // The tracked maps are only modified under mutex (by the owning thread), so
+    // the writer thread can serialize them while holding it.
+    mutable std::mutex mutex;
+    mutable std::string sectionText[SECTION_COUNT];
+    mutable bool sectionStale[SECTION_COUNT];
+
+    // Writer thread
+    std::thread writer;
+    std::condition_variable wake;
+    std::condition_variable written;
+    std::string saveFilename;
+    std::chrono::milliseconds debounce;
+    std::chrono::steady_clock::time_point firstChange;  // Since the last write
+    std::chrono::steady_clock::time_point saveDeadline;
+    bool autoSave;
+    bool fileDirty;        // Changes not written yet
+    bool writing;          // Writer thread is between serializing and renaming
+    bool stopping;
+    std::string document;  // Reused serialization buffer (writer thread)
+    std::unique_ptr<SessionSnapshot> pendingSnapshot;
+    std::string snapshotFilename;
+    std::string snapshotBuffer;  // Reused encoding buffer (writer thread)
+
+    // Render-thread timings, read by the writer without locks
+    static constexpr int FRAME_SAMPLES = 512;  // Frames kept for the percentiles
+    std::atomic<float> frameMillis[FRAME_SAMPLES];
+    std::atomic<uint64_t> frameCount;
+    std::atomic<float> uiRenderMillis;
+    std::atomic<int64_t> gpuMemoryBytes;
+    std::atomic<uint64_t> skippedVideoFrames;
+    std::atomic<bool> loopIdle;
+
+    // Performance sampling (under mutex)
+    struct CounterSample {
+        uint64_t delivered = 0;
+        uint64_t dropped = 0;
+        uint64_t uploaded = 0;
+    };
+    std::chrono::steady_clock::duration performanceInterval;  // Zero = off
+    std::chrono::steady_clock::time_point performanceDeadline;
+    std::chrono::steady_clock::time_point lastSampleTime;
+    uint64_t lastSampleFrames;
+    uint64_t lastSampleSkipped;
+    std::map<std::string, CounterSample> lastSourceCounts;
+    std::map<std::string, CounterSample> lastLayerCounts;
+    std::vector<float> frameScratch;
+    std::string performanceText;  // Serialized at sampling time
+
+    void samplePerformance(std::chrono::steady_clock::time_point now);
+
+    // Change stream (messages built under mutex, so sequence numbers follow the maps)
+    std::unique_ptr<DossierStream> stream;
+    uint64_t streamSequence;
+    std::string streamMessage;  // Reused message buffer
+
+    bool streaming() const { return stream && stream->hasClients(); }
+    void beginMessage(const char* type);
+    void publishMessage();
+    void publishSection(Section section);
+    void publishRemove(const char* section, const std::string& name);
+    void publishInputVariable(const InputVariableInfo& info, const InputVariableInfo* previous);
+    void publishOutputVariable(const OutputVariableInfo& info, const OutputVariableInfo* previous);
+    void publishLayer(const LayerInfo& info, const LayerInfo* previous);
+
+    // Mark a section changed (mutex held)
+    void markChanged(Section section);
+
+    // Rebuild stale sections and join them into out (mutex held)
+    void serialize(std::string& out) const;
+    void serializeSection(Section section, std::string& out) const;
+
+    void writerLoop();
+
     // Helper: escape JSON string
-    std::string escapeJSON(const std::string& str) const;
+    static void appendEscaped(std::string& out, const std::string& str);
 
     // Helper: format JSON number
-    std::string formatNumber(float value) const;
+    static void appendNumber(std::string& out, float value);
 };
 
 #endif // DOSSIER_MANAGER_H
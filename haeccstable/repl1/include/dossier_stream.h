@@ -0,0 +1,78 @@
+#ifndef DOSSIER_STREAM_H
+#define DOSSIER_STREAM_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Dossier changes streamed to local clients over a Unix domain socket
+// Each message is a 4-byte big-endian length followed by that many bytes of
+// JSON. A client first gets the whole dossier, then every change after it in
+// order (sequence numbers continue from the snapshot's). Sockets are serviced
+// on the stream's own thread with non-blocking writes: publish() only queues,
+// and a client that falls more than MAX_CLIENT_BACKLOG behind is disconnected
+// instead of holding up anyone else.
+class DossierStream {
+public:
+    // Returns the snapshot message and the sequence number of the last change it includes
+    using SnapshotProvider = std::function<std::string(uint64_t& sequence)>;
+
+    static constexpr size_t MAX_CLIENT_BACKLOG = 1 << 20;  // Unsent bytes
+
+    DossierStream();
+    ~DossierStream();  // Closes the socket and disconnects clients
+
+    DossierStream(const DossierStream&) = delete;
+    DossierStream& operator=(const DossierStream&) = delete;
+
+    // Listen on socketPath (a stale socket file is replaced)
+    bool start(const std::string& socketPath, SnapshotProvider provider);
+    void stop();
+
+    bool isRunning() const { return listenFd >= 0; }
+    const std::string& getSocketPath() const { return socketPath; }
+
+    // Cheap check before building a change message
+    bool hasClients() const { return clientCount.load(std::memory_order_relaxed) > 0; }
+
+    // Queue a change for every client whose snapshot predates it (any thread, never blocks on I/O)
+    void publish(uint64_t sequence, const std::string& message);
+
+    uint64_t getDroppedClientCount() const { return droppedClients.load(std::memory_order_relaxed); }
+
+private:
+    struct Client {
+        int fd;
+        uint64_t after;       // Changes up to this sequence are in its snapshot
+        std::string pending;  // Framed messages not written yet
+        size_t sent;          // Bytes of pending already written
+    };
+
+    std::string socketPath;
+    SnapshotProvider snapshotProvider;
+    int listenFd;
+    int wakeFds[2];  // Self-pipe: publish() and stop() wake the poll loop
+    std::thread thread;
+    std::atomic<bool> stopping;
+    std::atomic<int> clientCount;
+    std::atomic<uint64_t> droppedClients;
+
+    std::mutex mutex;  // Guards queue
+    std::vector<std::pair<uint64_t, std::string>> queue;  // Framed changes not handed to clients yet
+
+    std::vector<Client> clients;  // Stream thread only
+
+    void run();
+    void acceptClients();
+    bool writePending(Client& client);  // False if the client is gone
+    void closeClient(size_t index);
+
+    static void appendFrame(std::string& out, const std::string& message);
+};
+
+#endif // DOSSIER_STREAM_H
@@ -0,0 +1,36 @@
+#ifndef FRAME_GENERATOR_H
+#define FRAME_GENERATOR_H
+
+#include "video_source.h"
+#include <fstream>
+#include <memory>
+#include <string>
+
+// Stand-in for a capture device in headless runs
+// Synthetic: moving color bars and gradient (deterministic per frame index)
+// File: binary PPM (P6) frames read back to back, looping at end of file,
+//       e.g. ffmpeg -i clip.mp4 -f image2pipe -vcodec ppm clip.ppm
+class FrameGenerator {
+public:
+    FrameGenerator();
+
+    bool openSynthetic(int width, int height);
+    bool openFile(const std::string& path);
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+
+    // Produce the frame for frameIndex, stamped with timestamp
+    std::shared_ptr<VideoFrame> next(int frameIndex, double timestamp);
+
+private:
+    int width;
+    int height;
+    std::string path;
+    std::ifstream file;  // Open only in file mode
+
+    bool readPPMHeader(int& w, int& h);
+    void fillSynthetic(VideoFrame& frame, int frameIndex);
+};
+
+#endif // FRAME_GENERATOR_H
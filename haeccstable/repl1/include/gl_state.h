@@ -0,0 +1,49 @@
+#ifndef GL_STATE_H
+#define GL_STATE_H
+
+#include <glad/glad.h>
+
+// Shadow copy of the editor context's GL bindings
+// Binds that match the shadow are skipped; every GL call issued through here
+// (or reported with countCall) is tallied per frame for debugging.
+// Only describes the main window's context - presentation windows bind directly.
+class GLState {
+public:
+    static GLState& get();
+
+    void useProgram(GLuint program);
+    void bindVertexArray(GLuint vao);
+    void bindBuffer(GLenum target, GLuint buffer);  // GL_ARRAY_BUFFER or GL_UNIFORM_BUFFER
+    void bindBufferBase(GLenum target, GLuint index, GLuint buffer);
+    void bindTexture(GLuint texture);                // GL_TEXTURE_2D on unit 0
+    void setBlend(bool enabled);
+
+    // Tally GL calls that are not cached (draws, uploads)
+    void countCall(int calls = 1) { callsThisFrame += calls; }
+
+    // Forget all shadowed bindings (e.g. after GL code that bypasses the cache)
+    void invalidate();
+
+    // Latch this frame's counters and reset them
+    void endFrame();
+    int getCallsLastFrame() const { return callsLastFrame; }
+    int getSkippedLastFrame() const { return skippedLastFrame; }
+
+private:
+    GLState();
+
+    // ~0u means unknown: the next bind always goes through
+    GLuint program;
+    GLuint vertexArray;
+    GLuint arrayBuffer;
+    GLuint uniformBuffer;
+    GLuint texture;
+    int blend;  // -1 unknown, 0 disabled, 1 enabled
+
+    int callsThisFrame;
+    int skippedThisFrame;
+    int callsLastFrame;
+    int skippedLastFrame;
+};
+
+#endif // GL_STATE_H
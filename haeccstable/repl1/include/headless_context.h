@@ -0,0 +1,23 @@
+#ifndef HEADLESS_CONTEXT_H
+#define HEADLESS_CONTEXT_H
+
+// OpenGL 3.3 core context with no window or display server
+// Surfaceless EGL (Mesa/NVIDIA) on Linux, CGL on macOS
+// Rendering goes to framebuffer objects only (there is no default framebuffer)
+class HeadlessContext {
+public:
+    HeadlessContext();
+    ~HeadlessContext();
+
+    // Create the context and make it current; logs and returns false on failure
+    bool init();
+
+    // Loader for gladLoadGLLoader
+    static void* getProcAddress(const char* name);
+
+private:
+    void* display;  // EGLDisplay (unused on macOS)
+    void* context;  // EGLContext or CGLContextObj
+};
+
+#endif // HEADLESS_CONTEXT_H
@@ -0,0 +1,32 @@
+#ifndef HEADLESS_RUNNER_H
+#define HEADLESS_RUNNER_H
+
+#include <string>
+
+// Options for repl1 --headless (CI / render node compositor benchmark)
+struct HeadlessOptions {
+    std::string scriptPath;     // --script FILE: REPL code to run
+    std::string presetName;     // --preset NAME: ../presets/NAME
+    int frames = 300;           // --frames N: executeVideoPipeline iterations
+    std::string source = "synthetic";  // --source synthetic|FILE.ppm: feeds every in_var
+    int sourceWidth = 1920;     // --size WxH: synthetic frame size
+    int sourceHeight = 1080;
+    double fps = 30.0;          // --fps F: frame timestamp spacing
+    std::string dumpDir;        // --dump DIR: write each output as DIR/<out_var>_<frame>.ppm
+    int dumpEvery = 1;          // --dump-every N: only dump every Nth frame
+    bool benchKernels = false;  // --bench-kernels: time the CPU image kernels instead (no GL)
+    int threads = 0;            // --threads N: CPU kernel threads (0 = all cores)
+    bool gpuOnly = false;       // --gpu-only: run ascii process steps on the GPU too
+    int benchBindings = 0;      // --bench-bindings N: generated scene with N bindings instead of a script
+};
+
+// Parse argv (after --headless); prints usage and returns false on bad input
+bool parseHeadlessOptions(int argc, char** argv, HeadlessOptions& options);
+
+// Run the script and N pipeline frames without a window; returns process exit code
+int runHeadless(const HeadlessOptions& options);
+
+// Check the SIMD/threaded CPU kernels against the scalar reference and report Mpix/s
+int runKernelBenchmark(const HeadlessOptions& options);
+
+#endif // HEADLESS_RUNNER_H
@@ -0,0 +1,129 @@
+#ifndef IMAGE_KERNELS_H
+#define IMAGE_KERNELS_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "ascii_glyphs.h"
+#include "thread_pool.h"
+#include "video_source.h"
+
+// Single-channel 8-bit image (luminance, blur, edge and angle outputs)
+struct ImagePlane {
+    int width = 0;
+    int height = 0;
+    std::vector<uint8_t> pixels;  // Row-major, tightly packed
+
+    void resize(int w, int h) {
+        width = w;
+        height = h;
+        pixels.resize((size_t)w * h);
+    }
+    uint8_t* row(int y) { return pixels.data() + (size_t)y * width; }
+    const uint8_t* row(int y) const { return pixels.data() + (size_t)y * width; }
+};
+
+// CPU versions of the process builtins, for headless nodes and CPU-side logic
+// (motion detection, histograms). Rows are split into tiles across a ThreadPool
+// and each row runs through AVX2 (x86-64, picked at runtime) or NEON (arm64) code.
+//
+// All arithmetic is fixed-point, so the SIMD and scalar paths produce identical
+// bytes; SCALAR is the reference the benchmark checks SIMD against.
+//  - luminance: (54 R + 183 G + 19 B + 128) >> 8 (BT.709 weights summing to 256)
+//  - Gaussian: integer taps summing to 256, vertical then horizontal, rounded once
+//  - difference of Gaussians: 255 where blur(sigma1) >= tau * blur(sigma2), else 0
+//  - Sobel: edges 255 where |gradient| >= threshold (luminance units, 0-1), angles
+//    quantized to four orientations: 0 = vertical edge, 64 = diagonal (/ in image
+//    rows top down), 128 = horizontal edge, 192 = the other diagonal
+// Borders clamp to the nearest pixel, like the GPU passes.
+class ImageKernels {
+public:
+    enum class Backend {
+        SCALAR,  // Reference: plain C++ loops
+        SIMD     // AVX2/NEON when available, scalar otherwise
+    };
+
+    // threads: total worker count including the caller (0 = the shared pool)
+    explicit ImageKernels(Backend backend = Backend::SIMD, int threads = 0);
+
+    // Instruction set actually used: "AVX2", "NEON" or "scalar"
+    const char* getSimdName() const;
+    int getThreadCount() const { return pool->getThreadCount(); }
+
+    void luminance(const VideoFrame& frame, ImagePlane& out);
+
+    // Box average over factor x factor blocks; output is (width / factor) x (height / factor)
+    void downscale(const ImagePlane& in, int factor, ImagePlane& out);
+
+    // Separable Gaussian cut at 3 sigma (sigma in (0, 10])
+    void gaussianBlur(const ImagePlane& in, float sigma, ImagePlane& out);
+
+    // XDoG edges (tau clamped to [0, 1])
+    void differenceOfGaussians(const ImagePlane& in, float sigma1, float sigma2, float tau,
+                               ImagePlane& out);
+
+    void sobel(const ImagePlane& in, float threshold, ImagePlane& edges, ImagePlane& angles);
+
+    struct AsciiParams {
+        int cellSize = 8;            // Tile size in pixels; glyphs scale to it
+        float threshold = 0.2f;      // Sobel magnitude of an edge pixel (luminance units)
+        int edgeThreshold = 8;       // Edge pixels a tile needs for an edge glyph
+        bool useEdges = true;
+        bool invertLuminance = false;
+    };
+
+    // ASCII art: each tile of luminance becomes the ramp glyph for its mean, or,
+    // when enough of edgeSource's pixels in it are edges, the edge glyph of their
+    // most common orientation. Output is whole tiles, white glyphs on black.
+    // The render graph's GPU passes make the same choice.
+    void ascii(const ImagePlane& luminance, const ImagePlane& edgeSource, const AsciiGlyphs& glyphs,
+               const AsciiParams& params, ImagePlane& out);
+
+    // Row kernels; the backend picks an implementation of each
+    struct RowKernels {
+        void (*luminance)(const uint8_t* rgb, uint8_t* out, int count);
+        // out[x] = sum of weights[k] * rows[k][x]
+        void (*blurColumns)(const uint8_t* const* rows, const uint16_t* weights, int taps,
+                            uint16_t* out, int count);
+        // out[x] = (sum of weights[k] * padded[x + k] + 32768) >> 16
+        void (*blurRow)(const uint16_t* padded, const uint16_t* weights, int taps,
+                        uint8_t* out, int count);
+        // acc[x] += in[x]
+        void (*accumulate)(const uint8_t* in, uint16_t* acc, int count);
+        // out[x] = blur1[x] * 256 >= tau256 * blur2[x] ? 255 : 0
+        void (*dogThreshold)(const uint8_t* blur1, const uint8_t* blur2, int tau256,
+                             uint8_t* out, int count);
+        // Rows padded by one pixel on each side; above[x + 1] is above pixel x
+        void (*sobel)(const uint8_t* above, const uint8_t* center, const uint8_t* below,
+                      int32_t thresholdSquared, uint8_t* edges, uint8_t* angles, int count);
+    };
+
+private:
+    Backend backend;
+    RowKernels kernels;
+    const char* simdName;
+    std::unique_ptr<ThreadPool> ownPool;  // Only for an explicit thread count
+    ThreadPool* pool;
+
+    // Per-worker scratch rows, reused across calls
+    struct Scratch {
+        std::vector<uint16_t> wide;
+        std::vector<uint8_t> bytes;
+        std::vector<uint32_t> tileSums;
+    };
+    std::vector<Scratch> scratch;
+    ImagePlane asciiEdges;  // ascii's Sobel pass
+    ImagePlane asciiAngles;
+
+    // Gaussian taps (integers summing to 256) for sigma
+    static std::vector<uint16_t> gaussianWeights(float sigma);
+
+    // One output row of a separable blur
+    void blurOutputRow(const ImagePlane& in, int y, const std::vector<uint16_t>& weights,
+                       Scratch& rows, uint8_t* out) const;
+
+    // Rows per parallel chunk for a given width (about 64 KB of output)
+    static int rowGrain(int width);
+};
+
+#endif // IMAGE_KERNELS_H
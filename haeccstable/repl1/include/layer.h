@@ -1,12 +1,16 @@
 #ifndef LAYER_H
 #define LAYER_H
 
+#include <atomic>
+#include <cstdint>
 #include <string>
 #include <memory>
 #include <glad/glad.h>
 #include "video_source.h"
 #include "video_texture.h"
 
+class RenderGraph;
+
 // Layer object for video composition
 // Supports transforms, opacity, and aspect-ratio preserving scaling
 class Layer {
@@ -29,19 +33,36 @@ public:
     void rot(float xyDegrees, float yDegrees);         // Rotation (xy plane, y axis)
     void setOpacity(float opacityPercent);             // 0-100, default=100
 
-    // Get transform properties
-    float getPosX() const { return posX; }
-    float getPosY() const { return posY; }
-    float getScaleX() const { return scaleX; }
-    float getScaleY() const { return scaleY; }
-    float getRotXY() const { return rotXY; }
-    float getRotY() const { return rotY; }
-    float getOpacity() const { return opacity; }
+    // Back to a fresh layer_obj (default canvas, transforms, no source)
+    // The framebuffer and video texture are kept for reuse
+    void reset();
+
+    // Per-frame animated contributions (REPL bindings such as rot(t*30, 0))
+    // Same semantics as the methods above, applied on top of the static values;
+    // cleared and re-applied every frame
+    void clearAnimation();
+    void animateTransform(float changeX, float changeY);
+    void animateScale(float scaleW, float scaleH);
+    void animateRot(float xyDegrees, float yDegrees);
+    void animateOpacity(float opacityPercent);
+
+    // Get transform properties (static and animated combined)
+    float getPosX() const { return posX + animPosX; }
+    float getPosY() const { return posY + animPosY; }
+    float getScaleX() const { return scaleX * animScaleX; }
+    float getScaleY() const { return scaleY * animScaleY; }
+    float getRotXY() const;
+    float getRotY() const;
+    float getOpacity() const { return animOpacity >= 0.0f ? animOpacity : opacity; }
 
     // Video source binding
     void setSource(std::shared_ptr<VideoSource> src);
     std::shared_ptr<VideoSource> getSource() const { return source; }
 
+    // Process output binding (in_var x = $process(...)); replaces any video source
+    void setProcess(std::shared_ptr<RenderGraph> graph);
+    std::shared_ptr<RenderGraph> getProcess() const { return process; }
+
     // Texture access (lazy - creates on first access)
     std::shared_ptr<VideoTexture> getTexture();
 
@@ -54,6 +75,26 @@ public:
 
     // Get framebuffer texture ID
     GLuint getFramebufferTexture() const { return renderTexture; }
+    int getFramebufferWidth() const { return framebufferWidth; }
+    int getFramebufferHeight() const { return framebufferHeight; }
+
+    // Static transform (what the REPL methods set, without animation), for session snapshots
+    struct Transform {
+        float posX, posY;
+        float scaleX, scaleY;
+        float rotXY, rotY;
+        float opacity;
+    };
+    Transform getTransform() const { return {posX, posY, scaleX, scaleY, rotXY, rotY, opacity}; }
+    void setTransform(const Transform& transform);
+
+    // Allocate the framebuffer (and the video texture, for a video source) at
+    // known sizes now rather than on the first frames; 0 sizes are skipped
+    void prepare(int framebufferW, int framebufferH, int sourceW, int sourceH);
+
+    // Bytes uploaded for this layer's texture so far, including its process's
+    // uploads (relaxed atomic, sampled by the dossier's performance section)
+    uint64_t getUploadedBytes() const { return uploadedBytes.load(std::memory_order_relaxed); }
 
 private:
     std::string name;
@@ -70,14 +111,26 @@ private:
     float rotY;                // Rotation around Y axis (degrees clockwise)
     float opacity;             // 0-100 (default 100 = fully opaque)
 
+    // Animated contributions (identity when no binding is active)
+    float animPosX, animPosY;
+    float animScaleX, animScaleY;
+    float animRotXY, animRotY;
+    float animOpacity;         // -1 = not animated
+
     // Video source
     std::shared_ptr<VideoSource> source;
     std::shared_ptr<VideoTexture> texture;
+    std::shared_ptr<RenderGraph> process;  // Texture comes from the graph's last pass
+
+    std::atomic<uint64_t> uploadedBytes;
+    uint64_t processUploadedBytes;  // process->getUploadedBytes() when last counted
 
     // Offscreen rendering
     GLuint framebuffer;
     GLuint renderTexture;
     GLuint depthBuffer;
+    int framebufferWidth;
+    int framebufferHeight;
 
     // Initialize framebuffer for offscreen rendering
     void initFramebuffer(int width, int height);
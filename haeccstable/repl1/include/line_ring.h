@@ -0,0 +1,75 @@
+#ifndef LINE_RING_H
+#define LINE_RING_H
+
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Line storage for TextBuffer: a ring of fixed-size chunks
+// push_back/pop_front are O(1) (no line is ever shifted), indexing is O(1),
+// and evicted chunks are recycled so steady-state scrollback doesn't allocate.
+// Middle insert/erase shift only the lines after the edit point, like a vector.
+class LineRing {
+public:
+    static const size_t chunkLines = 1024;
+
+    LineRing();
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    std::string& operator[](size_t index) { return at(index); }
+    const std::string& operator[](size_t index) const { return at(index); }
+    std::string& front() { return at(0); }
+    const std::string& front() const { return at(0); }
+    std::string& back() { return at(count - 1); }
+    const std::string& back() const { return at(count - 1); }
+
+    void push_back(const std::string& line);
+    void pop_front();
+    void pop_back();
+    void insert(size_t index, const std::string& line);
+    void erase(size_t index);
+
+    // Bulk versions: the lines after index move once, not once per line
+    void insert(size_t index, std::vector<std::string>&& newLines);
+    void erase(size_t index, size_t lineCount);
+    void clear();
+
+    // Read-only iteration (range-for over all lines)
+    class const_iterator {
+    public:
+        const_iterator(const LineRing* ring, size_t index) : ring(ring), index(index) {}
+        const std::string& operator*() const { return ring->at(index); }
+        const std::string* operator->() const { return &ring->at(index); }
+        const_iterator& operator++() { index++; return *this; }
+        bool operator!=(const const_iterator& other) const { return index != other.index; }
+        bool operator==(const const_iterator& other) const { return index == other.index; }
+    private:
+        const LineRing* ring;
+        size_t index;
+    };
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, count); }
+
+private:
+    struct Chunk {
+        std::string lines[chunkLines];
+    };
+
+    std::deque<std::unique_ptr<Chunk>> chunks;
+    std::vector<std::unique_ptr<Chunk>> spareChunks;  // Evicted chunks kept for reuse
+    size_t head;   // Slot of line 0 within chunks.front()
+    size_t count;
+
+    std::string& at(size_t index) const {
+        size_t slot = head + index;
+        return chunks[slot / chunkLines]->lines[slot % chunkLines];
+    }
+
+    void releaseChunk(std::unique_ptr<Chunk> chunk);
+};
+
+#endif // LINE_RING_H
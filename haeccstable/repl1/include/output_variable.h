@@ -1,6 +1,7 @@
 #ifndef OUTPUT_VARIABLE_H
 #define OUTPUT_VARIABLE_H
 
+#include <atomic>
 #include <string>
 #include <vector>
 #include <memory>
@@ -41,7 +42,10 @@ public:
     void clearLayers();
 
     // Get layer stack (sorted by z-index for rendering)
-    const std::vector<LayerStackEntry>& getLayerStack() const { return layerStack; }
+    const std::vector<LayerStackEntry>& getLayerStack() const {
+        sortLayerStack();
+        return layerStack;
+    }
 
     // Execute all layers in the stack (fetch frames, update textures)
     void executeLayers();
@@ -50,18 +54,29 @@ public:
     // parentW/parentH: dimensions of the output display
     void composite(int parentW, int parentH);
 
+    // Allocate the output framebuffer at the size composite() will use, ahead of the first frame
+    void prepare(int width, int height);
+
     // Get composited output texture
     GLuint getOutputTexture() const { return outputTexture; }
+    GLuint getOutputFramebuffer() const { return outputFramebuffer; }
 
     // Get output dimensions
     int getOutputWidth() const { return outputWidth; }
     int getOutputHeight() const { return outputHeight; }
 
+    // CPU time of the last composite() including its layers (relaxed atomic,
+    // sampled by the dossier's performance section)
+    float getCompositeMillis() const { return compositeMillis.load(std::memory_order_relaxed); }
+
 private:
     std::string name;
     std::string target;  // Display target (monitor1, monitor2, etc.)
 
-    std::vector<LayerStackEntry> layerStack;  // Layers with z-indices
+    // Layers with z-indices. project() only marks the stack unsorted; it is sorted
+    // once when next read, so a script projecting many layers sorts once.
+    mutable std::vector<LayerStackEntry> layerStack;
+    mutable bool stackSorted;
 
     // Compositor output
     GLuint outputFramebuffer;
@@ -69,6 +84,7 @@ private:
     GLuint outputDepthBuffer;
     int outputWidth;
     int outputHeight;
+    std::atomic<float> compositeMillis;
 
     // Initialize output framebuffer
     void initOutputFramebuffer(int width, int height);
@@ -76,8 +92,8 @@ private:
     // Cleanup output framebuffer
     void cleanupOutputFramebuffer();
 
-    // Sort layer stack by z-index (back-to-front)
-    void sortLayerStack();
+    // Sort layer stack by z-index (back-to-front) if it changed; equal z-indices keep projection order
+    void sortLayerStack() const;
 };
 
 #endif // OUTPUT_VARIABLE_H
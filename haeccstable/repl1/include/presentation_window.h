@@ -0,0 +1,47 @@
+#ifndef PRESENTATION_WINDOW_H
+#define PRESENTATION_WINDOW_H
+
+#include <glad/glad.h>
+#define GLFW_INCLUDE_NONE
+#include <GLFW/glfw3.h>
+#include <string>
+
+// Borderless fullscreen window that shows one out_var on a physical monitor
+// Shares the editor's GL context so the composite texture is sampled directly (no copy)
+class PresentationWindow {
+public:
+    PresentationWindow(const std::string& outputName, int monitorIndex);
+    ~PresentationWindow();
+
+    // Create the window on the monitor, sharing objects with shareContext
+    bool init(GLFWwindow* shareContext);
+
+    // Draw texture to fill the window and swap (restores the previous context)
+    void present(GLuint texture);
+
+    // Swap interval for this window only (1 = vsync, 0 = unthrottled)
+    void setSwapInterval(int interval);
+    int getSwapInterval() const { return swapInterval; }
+
+    const std::string& getOutputName() const { return outputName; }
+    int getMonitorIndex() const { return monitorIndex; }
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+
+private:
+    std::string outputName;
+    int monitorIndex;      // Index into glfwGetMonitors()
+    int width;
+    int height;
+    int swapInterval;
+
+    GLFWwindow* window;
+
+    // VAOs are not shared between contexts, so each window owns its quad
+    GLuint shaderProgram;
+    GLuint VAO, VBO;
+
+    bool initQuad();
+};
+
+#endif // PRESENTATION_WINDOW_H
@@ -0,0 +1,65 @@
+#ifndef PRESET_LIBRARY_H
+#define PRESET_LIBRARY_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Preset files (#import and the import command), cached in memory
+// A preset is read from disk once and again only after it changes: on Linux an
+// inotify watch on the directory marks changed files, elsewhere each load
+// compares the file's mtime and size (one stat instead of a read).
+class PresetLibrary {
+public:
+    explicit PresetLibrary(const std::string& directory = "../presets");
+    ~PresetLibrary();
+
+    PresetLibrary(const PresetLibrary&) = delete;
+    PresetLibrary& operator=(const PresetLibrary&) = delete;
+
+    const std::string& getDirectory() const { return directory; }
+
+    // File contents, or nullptr if it can't be read. Valid until name is loaded again.
+    const std::string* load(const std::string& name);
+
+    // Replace each "#import NAME" line of text with NAME's contents, their own
+    // imports expanded, in one pass: every preset is expanded once per call and
+    // reused, so nested libraries cost time linear in the output. A missing file
+    // or an import cycle leaves its #import line as is and adds an error.
+    // Returns how many of text's own #import lines were replaced.
+    int expandImports(const std::string& text, std::string& out, std::vector<std::string>& errors);
+
+    // Statistics for the console: disk reads vs cache hits since startup
+    uint64_t getReadCount() const { return reads; }
+    uint64_t getHitCount() const { return hits; }
+
+private:
+    struct Entry {
+        std::string contents;
+        int64_t mtime = 0;
+        int64_t size = -1;
+        bool stale = true;
+    };
+
+    std::string directory;
+    std::map<std::string, Entry> entries;  // By file name
+    int watchFd;                           // inotify descriptor, -1 without one
+    uint64_t reads;
+    uint64_t hits;
+
+    // Mark entries changed on disk since the last call (inotify events)
+    void drainEvents();
+
+    // expandImports for one text, appending to out; expanded maps presets done
+    // in this call to their (offset, length) in out, stack holds those in progress
+    int expandInto(const std::string& text, std::string& out,
+                   std::map<std::string, std::pair<size_t, size_t>>& expanded,
+                   std::vector<std::string>& stack, std::vector<std::string>& errors);
+};
+
+// Preset name of an "#import NAME" line (surrounding whitespace allowed), or ""
+std::string parseImportLine(const std::string& line);
+
+#endif // PRESET_LIBRARY_H
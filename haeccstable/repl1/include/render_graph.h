@@ -0,0 +1,169 @@
+#ifndef RENDER_GRAPH_H
+#define RENDER_GRAPH_H
+
+#include <glad/glad.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "ascii_glyphs.h"
+#include "image_kernels.h"
+#include "repl_program.h"
+#include "shader.h"
+#include "video_source.h"
+#include "video_texture.h"
+
+// GPU render graph for a process call (in_var name = $process(source))
+// build() expands process blocks into a graph of builtin operations and checks
+// their parameters; the first execute() plans passes once input sizes are known:
+//  - chains of per-pixel operations are fused into a single fragment shader,
+//    as is a blur/sobel whose only consumer is per-pixel
+//  - intermediate textures are pooled and reused once their last reader has run
+//  - with CPU kernels set, ascii steps that read device frames run on them instead
+// The result is a VideoTexture, so a Layer draws it like a camera texture.
+class RenderGraph {
+public:
+    RenderGraph();
+    ~RenderGraph();
+
+    RenderGraph(const RenderGraph&) = delete;
+    RenderGraph& operator=(const RenderGraph&) = delete;
+
+    // Expand call against the program's process blocks; names resolve to device in_vars
+    // Returns false with error set if the call can't be compiled
+    bool build(const ReplProcessCall& call,
+               const std::map<std::string, ReplProcessDef>& processes,
+               const std::map<std::string, std::shared_ptr<VideoSource>>& sources,
+               std::string& error);
+
+    // Run ascii steps whose inputs are device frames on CPU kernels (headless runs,
+    // where a software GL renders the passes slower). nullptr = everything on the GPU.
+    void setCpuKernels(std::shared_ptr<ImageKernels> kernels);
+
+    // Upload new input frames and run the passes (no-op when no input changed)
+    void execute();
+
+    // Plan for inputs of these sizes now (shaders, targets) instead of on the
+    // first frame; a first frame of another size re-plans as usual
+    bool prepare(const std::vector<std::pair<int, int>>& inputSizes);
+
+    // Final pass target (nullptr until the first frame has run)
+    std::shared_ptr<VideoTexture> getOutput() const { return output; }
+
+    int getWidth() const { return outputWidth; }
+    int getHeight() const { return outputHeight; }
+
+    // Plan statistics (valid after the first execute)
+    int getNodeCount() const { return (int)nodes.size(); }
+    int getPassCount() const { return (int)passes.size(); }
+    int getPooledTextureCount() const { return (int)pool.size(); }
+    int getIntermediateCount() const { return intermediateCount; }
+    int getCpuPassCount() const;
+
+    // Bytes uploaded to the GPU so far (input frames, CPU-computed passes)
+    uint64_t getUploadedBytes() const { return uploadedBytes; }
+
+    // Sources feeding the graph (for diffing REPL runs and teardown)
+    const std::vector<std::shared_ptr<VideoSource>>& getInputs() const { return inputs; }
+
+private:
+    enum class Op {
+        INPUT,
+        GLYPH_ATLAS,  // Constant texture of an ascii step's glyphs
+        // Per-pixel (fusable)
+        LUMINANCE, THRESHOLD, INVERT, MULTIPLY, ADD, BLEND, GOOCH, DOG_COMBINE,
+        // Neighborhood (read their input at offsets)
+        BLUR_H, BLUR_V, SOBEL, DOWNSCALE,
+        // ascii: a glyph index per tile, then glyphs drawn from the atlas
+        // (per output pixel, so the glyph step fuses into per-pixel readers)
+        ASCII_TILES, ASCII_GLYPHS
+    };
+
+    struct Node {
+        Op op;
+        std::vector<int> inputs;  // Node indices (always lower than this node's)
+        float params[8];
+        int inputIndex;           // INPUT: index into inputs
+        std::string text;         // GLYPH_ATLAS: the ramp characters
+        int width;
+        int height;
+        int consumers;
+        int consumer;             // The reader, when consumers == 1
+        int pass;                 // Pass that writes this node, -1 if fused into its consumer
+        bool cpu;                 // ascii step computed by cpuKernels
+    };
+
+    struct Pass {
+        int node;                      // Node whose value the pass writes
+        std::vector<int> textureNodes; // Materialized nodes it samples (sampler uTex<i>)
+        std::unique_ptr<Shader> shader;
+        int slot;                      // Pool slot written, -1 for the final output
+        int lastUse;                   // Last pass that reads this pass's result
+        bool cpu;                      // ASCII_GLYPHS on cpuKernels, uploaded (no shader)
+    };
+
+    // Lifetime-aliased intermediate target
+    struct Slot {
+        GLuint texture;
+        GLuint framebuffer;
+        int width;
+        int height;
+    };
+
+    std::vector<Node> nodes;
+    std::vector<Pass> passes;
+    std::vector<Slot> pool;
+    int outputNode;
+    int intermediateCount;  // Textures needed without aliasing
+
+    std::vector<std::shared_ptr<VideoSource>> inputs;
+    std::vector<std::unique_ptr<VideoTexture>> inputTextures;
+    std::vector<std::shared_ptr<VideoFrame>> inputFrames;  // Peeked once per execute
+    std::vector<double> inputTimestamps;
+    std::vector<int> inputWidths;  // Sizes the plan was made for
+    std::vector<int> inputHeights;
+    std::vector<bool> inputUploads;  // Some GPU pass samples the input
+
+    struct Atlas {
+        AsciiGlyphs glyphs;
+        GLuint texture;
+    };
+    std::map<int, Atlas> atlases;  // By GLYPH_ATLAS node
+
+    std::shared_ptr<ImageKernels> cpuKernels;
+    ImagePlane cpuLuminance;  // CPU pass planes, reused every frame
+    ImagePlane cpuEdgeLuminance;
+    ImagePlane cpuGlyphs;
+    std::vector<uint8_t> cpuUpload;
+
+    std::shared_ptr<VideoTexture> output;
+    GLuint outputFramebuffer;
+    int outputWidth;
+    int outputHeight;
+    GLuint emptyVAO;  // Core profile needs a VAO even for attribute-less draws
+    bool planned;
+    uint64_t uploadedBytes;
+
+    // Expansion state (build only)
+    const std::map<std::string, ReplProcessDef>* processDefs;
+    const std::map<std::string, std::shared_ptr<VideoSource>>* sourceVars;
+
+    int expandCall(const ReplProcessCall& call, const std::map<std::string, int>& scope,
+                   int depth, std::string& error);
+    int expandArg(const ReplProcessArg& arg, const std::map<std::string, int>& scope,
+                  int depth, std::string& error);
+    int addNode(Op op, std::vector<int> nodeInputs, const float* params = nullptr, int paramCount = 0);
+    int addBlur(int input, float sigma, bool horizontal);
+    void prune();
+
+    // Plan passes, generate shaders and allocate textures for the current input sizes
+    bool plan();
+    void releaseTargets();
+    void executeCpuPass(const Pass& pass);
+    std::string generateShader(int pass, std::vector<int>& textureNodes) const;
+    void emitNode(int node, int pass, std::vector<int>& textureNodes, std::string& body) const;
+    bool isFused(int node, int pass) const;
+    static bool isPerPixel(Op op) { return op >= Op::LUMINANCE && op <= Op::DOG_COMBINE; }
+};
+
+#endif // RENDER_GRAPH_H
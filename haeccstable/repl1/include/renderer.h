@@ -2,8 +2,11 @@
 #define RENDERER_H
 
 #include "layout_manager.h"
+#include "shader.h"
+#include "display_buffer.h"
 #include <glad/glad.h>
 #include <string>
+#include <vector>
 
 class Renderer {
 public:
@@ -12,24 +15,60 @@ public:
 
     bool init();
     void clear(float r, float g, float b, float a);
+
+    // Draw calls are batched: quads accumulate until flush()
     void drawRect(const Rect& rect, float r, float g, float b, float a);
     void drawBorder(const Rect& rect, float r, float g, float b, float a, int borderWidth);
     void drawText(const std::string& text, int x, int y, float r, float g, float b);
     void drawTexture(GLuint texture, const Rect& rect);
+
+    // Coordinates are framebuffer pixels; call once per frame before drawing
+    // (the projection UBO is only rewritten when the size changes)
     void setViewport(int x, int y, int width, int height);
 
+    // Redirect drawing into target, which covers region (framebuffer pixels),
+    // until endTarget() draws it; quads already batched for the frame are kept
+    void beginTarget(DisplayBuffer& target, const Rect& region);
+    void endTarget();
+
+    // Draw everything batched this frame (call once before swapping buffers)
+    void flush();
+
 private:
-    GLuint shaderProgram;
-    GLuint VAO, VBO;
+    // Contiguous run of quads sharing one texture
+    struct DrawBatch {
+        GLuint texture;
+        GLint first;     // First vertex
+        GLsizei count;   // Vertex count
+    };
+
+    // Retained vertex batch
+    Shader batchShader;
+    GLuint batchVAO, batchVBO;
+    GLsizeiptr batchCapacity;          // VBO size in bytes, grows as needed
+    std::vector<float> batchVertices;  // x, y, u, v, r, g, b, a per vertex
+    std::vector<DrawBatch> batches;
+
+    // Pixel-to-NDC projection shared through a uniform block
+    GLuint projectionUBO;
+    Rect projectionRegion;
+    int viewportWidth, viewportHeight;
+
+    // Offscreen target state
+    DisplayBuffer* activeTarget;
+    std::vector<float> stashedVertices;
+    std::vector<DrawBatch> stashedBatches;
 
-    // Texture rendering
-    GLuint textureShaderProgram;
-    GLuint textureVAO, textureVBO;
+    // Glyph atlas (also provides the white texel for solid rects)
+    GLuint glyphAtlas;
+    int atlasWidth, atlasHeight;
+    float whiteU, whiteV;
 
-    bool loadShaders();
-    bool loadTextureShaders();
-    GLuint compileShader(const char* source, GLenum shaderType);
-    GLuint createShaderProgram(const char* vertexSrc, const char* fragmentSrc);
+    bool buildGlyphAtlas();
+    void setProjection(const Rect& region);
+    void pushQuad(GLuint texture, float x1, float y1, float x2, float y2,
+                  float u1, float v1, float u2, float v2,
+                  float r, float g, float b, float a);
 };
 
 #endif // RENDERER_H
@@ -1,11 +1,18 @@
 #ifndef REPL_INTERPRETER_H
 #define REPL_INTERPRETER_H
 
+#include "repl_program.h"
+#include "session_snapshot.h"
+#include "thread_pool.h"
 #include <string>
 #include <map>
+#include <set>
+#include <unordered_map>
 #include <vector>
+#include <chrono>
 #include <functional>
 #include <memory>
+#include <mutex>
 
 // Forward declarations
 class VideoVariable;
@@ -13,13 +20,40 @@ class VideoSource;
 class Layer;
 class OutputVariable;
 class DossierManager;
+class RenderGraph;
+class ImageKernels;
 
 class ReplInterpreter {
 public:
     ReplInterpreter();
 
     // Execute REPL code and return output lines
+    // The code is compiled once and reused while its text is unchanged
     std::vector<std::string> execute(const std::string& code);
+    std::vector<std::string> execute(const ReplProgram& program);
+
+    // Compiled program for code, from the content-hash cache when possible
+    // (safe to call from the run worker thread)
+    std::shared_ptr<const ReplProgram> compile(const std::string& code);
+
+    // Asynchronous run, for the editor: code is compiled and the capture devices
+    // its new in_vars need are opened on a worker thread while frames keep
+    // rendering. applyPendingRun() then executes the program at a frame boundary,
+    // all at once, leaving only GL work (framebuffers, shaders) on the render thread.
+    // A submit while a run is pending is queued; only the latest queued code runs.
+    void submit(const std::string& code);
+    bool isRunPending() const { return pendingRun || hasQueuedCode; }
+
+    // Call once per frame before executeVideoPipeline(). Returns true, with the
+    // run's output lines, when a prepared run was applied.
+    bool applyPendingRun(std::vector<std::string>& outputs);
+
+    // Session snapshots: capture the live graph (after frames have run, so sizes
+    // are known), and rebuild one at startup in a single pass: the program runs
+    // once, layer transforms are set, and framebuffers, video textures and process
+    // passes are allocated at the recorded sizes before the first frame
+    void captureSnapshot(SessionSnapshot& snapshot);
+    std::vector<std::string> restoreSnapshot(const SessionSnapshot& snapshot);
 
     // Clear all variables
     void clear();
@@ -30,6 +64,14 @@ public:
     // Set dossier manager for state tracking
     void setDossierManager(std::shared_ptr<DossierManager> dossier);
 
+    // Override how in_var opens devices (headless runs substitute generated sources)
+    // The factory returns nullptr when the device cannot be opened
+    void setVideoSourceFactory(std::function<std::shared_ptr<VideoSource>(int deviceIndex)> factory);
+
+    // CPU kernels for process steps that can run off the GPU (headless runs); see
+    // RenderGraph::setCpuKernels. Applies to process in_vars created afterwards.
+    void setCpuKernels(std::shared_ptr<ImageKernels> kernels) { cpuKernels = std::move(kernels); }
+
     // Video variable management (legacy - will be replaced by layer system)
     std::shared_ptr<VideoVariable> getVideoVariable(const std::string& name);
     const std::map<std::string, std::shared_ptr<VideoVariable>>& getVideoVariables() const { return videoVariables; }
@@ -43,43 +85,131 @@ public:
     const std::map<std::string, std::shared_ptr<OutputVariable>>& getOutputVariables() const { return outputVariables; }
 
     // Execute all active video pipelines (fetch frames, update textures)
+    // Animated layer properties are evaluated first, at the pipeline time
     void executeVideoPipeline();
 
+    // Time t seen by animated expressions. By default wall-clock seconds since
+    // the interpreter was created; headless runs set the frame timestamp instead.
+    void setPipelineTime(double seconds);
+
+    // Animated property bindings, and the cost of evaluating them last frame
+    size_t getBindingCount() const;
+    double getLastBindingMicros() const { return lastBindingMicros; }
+
 private:
-    std::map<std::string, std::string> variables;  // String variable storage
+    std::vector<ReplValue> variables;  // var values, indexed by ReplSymbol (NONE = unset)
     std::map<std::string, std::shared_ptr<VideoVariable>> videoVariables;  // Video variable storage (legacy)
     std::map<std::string, std::shared_ptr<Layer>> layers;  // Layer objects
     std::map<std::string, std::shared_ptr<OutputVariable>> outputVariables;  // Output variables
     std::map<std::string, std::shared_ptr<VideoSource>> inputSources;  // Input sources (for layer casting)
+    std::map<std::string, std::shared_ptr<RenderGraph>> processSources;  // in_var x = $process(...)
 
     std::shared_ptr<DossierManager> dossierManager;  // State tracking
+    std::function<std::shared_ptr<VideoSource>(int)> videoSourceFactory;  // Optional in_var override
+    std::shared_ptr<ImageKernels> cpuKernels;  // Optional, for process graphs
+
+    std::string lastProgramSource;  // Code of the last executed program (for snapshots)
 
     std::vector<std::string> outputLines;
     std::function<void(const std::string&)> outputCallback;
     bool lastWasPrintln;  // Track if last output was println (completed line)
 
-    // Parse and execute a single line
-    void executeLine(const std::string& line);
+    // Compiled programs keyed by hashReplSource (source compared on hit)
+    std::unordered_map<uint64_t, std::shared_ptr<const ReplProgram>> programCache;
+    std::mutex programCacheMutex;
 
-    // Evaluate an expression
-    std::string evaluateExpression(const std::string& expr);
+    // A run prepared off the render thread
+    struct PreparedRun {
+        std::shared_ptr<const ReplProgram> program;
+        // Device in_vars opened ahead of time, by name (nullptr: the open failed)
+        std::map<std::string, std::shared_ptr<VideoSource>> sources;
+        double prepareMillis;
+    };
+    std::shared_ptr<PreparedRun> pendingRun;  // Filled in by the job in prepareTasks
+    TaskGroup prepareTasks;  // Destroyed (waited for) before what the job reads
+    std::string queuedCode;
+    bool hasQueuedCode;
+    std::map<std::string, std::shared_ptr<VideoSource>> preparedSources;  // While applying a run
+    std::map<std::string, std::shared_ptr<RenderGraph>> preparedGraphs;  // Built by checkGroup
+
+    // Start preparing code as a job on the shared pool
+    void startRun(const std::string& code);
+
+    // Incremental runs: the objects the last run declared, and per object the
+    // text of every statement that configured it. Objects whose text is unchanged
+    // keep their live state (open cameras, framebuffers) and their statements are skipped.
+    std::map<std::string, ReplStatementType> declaredObjects;  // name -> IN_VAR/OUT_VAR/LAYER_OBJ
+    std::map<std::string, std::string> sourceSignatures;
+    std::map<std::string, std::string> layerSignatures;
+    std::map<std::string, std::string> outputSignatures;
+
+    // Objects a run changed. Their dossier entries are refreshed once, when the
+    // run commits, however many statements touched them.
+    std::set<std::string> touchedLayers;
+    std::set<std::string> touchedOutputs;
+    void commitDossier();
+
+    // Check that every statement of a ';' group can be applied, before applying
+    // any (objects declared earlier in the group count). False with a message if not.
+    // Devices are opened and process graphs built here, into preparedSources and
+    // preparedGraphs, so executeStatement has nothing left that can fail.
+    bool checkGroup(const std::vector<const ReplStatement*>& group, const ReplProgram& program,
+                    std::string& error);
+
+    // Remove an object the new program no longer declares
+    void removeObject(const std::string& name, ReplStatementType kind);
+
+    // Layer method with per-frame arguments, e.g. videocat.rot(t*30, 0)
+    struct LayerBinding {
+        std::shared_ptr<Layer> layer;
+        ReplMethod method;
+        ReplBytecode x;
+        ReplBytecode y;  // Empty for opacity
+    };
+    std::map<std::string, std::vector<LayerBinding>> layerBindings;  // By layer name
+
+    // layerBindings flattened for the per-frame loop: all bytecode in one array,
+    // bindings grouped by layer. Rebuilt only when bindings change.
+    struct PackedBinding {
+        Layer* layer;
+        ReplMethod method;
+        bool firstOfLayer;  // Clear the layer's animation before applying
+        uint32_t x, xCount;
+        uint32_t y, yCount;
+    };
+    std::vector<ReplBytecode::Instruction> packedCode;
+    std::vector<PackedBinding> packedBindings;
+    bool bindingsChanged;
+    void packBindings();
 
-    // Helper to trim whitespace
-    std::string trim(const std::string& str);
+    std::chrono::steady_clock::time_point startTime;
+    double pipelineTime;
+    bool hasPipelineTime;
+    double lastBindingMicros;
 
-    // Parse tuple syntax: (x, y) -> vector of values
-    std::vector<std::string> parseTuple(const std::string& tupleStr);
+    // Apply every binding for time t (no allocation)
+    void evaluateBindings(float t);
 
-    // Parse method call: object.method(args) -> {object, method, args}
-    struct MethodCall {
-        std::string object;
-        std::string method;
-        std::vector<std::string> args;
-    };
-    bool parseMethodCall(const std::string& stmt, MethodCall& result);
+    // Open a capture device through the factory if one is set (nullptr on failure)
+    std::shared_ptr<VideoSource> openSource(int deviceIndex);
+
+    // Execute a single compiled statement (process in_vars expand the program's process blocks)
+    void executeStatement(const ReplStatement& statement, const ReplProgram& program);
+
+    // var value, or for a declared object its handle; nullptr if neither
+    // (object handles are built in objectValue, valid until the next call)
+    const ReplValue* lookupValue(ReplSymbol symbol);
+    ReplValue objectValue;
+
+    // Evaluate an expression
+    ReplValue evaluateExpression(const ReplExpression& expression);
+
+    // Replace LOAD_VAR with the variables' current values; false (after an
+    // error message) if one is undefined or not a number
+    bool resolveVariables(ReplBytecode& bytecode);
 
     // Execute a method call
-    void executeMethodCall(const MethodCall& call);
+    void executeMethodCall(const ReplStatement& call);
 };
 
 #endif // REPL_INTERPRETER_H
@@ -0,0 +1,187 @@
+#ifndef REPL_PROGRAM_H
+#define REPL_PROGRAM_H
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "repl_value.h"
+
+// Compiled form of REPL code
+// The source is tokenized and parsed once; ReplInterpreter then walks the
+// statements below with names, numbers and methods already resolved.
+// One statement per line; a trailing ';' is optional, '/' and '#' lines are comments.
+// Several statements on one line, separated by ';', form a group that is applied
+// as one transaction: all of it or (if any statement would fail) none of it.
+// process blocks span lines, from "process $name(...) {" to the matching '}'.
+
+enum class ReplTokenType {
+    IDENTIFIER,  // [A-Za-z_][A-Za-z0-9_]*
+    NUMBER,      // 1920, 0.5, .25 (sign is a separate symbol)
+    STRING,      // "..." or '...', text holds the contents without quotes
+    SYMBOL       // Any other single character: = . , ( ) ; + - ...
+};
+
+struct ReplToken {
+    ReplTokenType type;
+    std::string text;
+    double number;  // NUMBER only
+    size_t begin;   // Byte range in the line, quotes included
+    size_t end;
+};
+
+// Split one line into tokens (whitespace is dropped)
+std::vector<ReplToken> tokenizeReplLine(const std::string& line);
+
+// Numeric argument expression, compiled to bytecode over float registers
+// Grammar: + - * / unary -, parentheses, numbers, t (seconds), pi,
+// sin cos abs floor sqrt (one argument), min max (two arguments), and
+// var names. evaluate() uses a fixed register file on the stack, so per-frame
+// evaluation never allocates; the result is left in register 0.
+// Vars are LOAD_VAR by symbol; the interpreter substitutes their values
+// (LOAD_CONST) before running the code, so run() never sees one.
+struct ReplBytecode {
+    enum class Op : uint8_t {
+        LOAD_CONST, LOAD_TIME, LOAD_VAR,
+        ADD, SUB, MUL, DIV, NEG,
+        SIN, COS, ABS, FLOOR, SQRT,
+        MIN, MAX
+    };
+
+    struct Instruction {
+        Op op;
+        uint8_t dst;
+        uint8_t a;
+        uint8_t b;
+        union {
+            float constant;     // LOAD_CONST
+            ReplSymbol symbol;  // LOAD_VAR
+        };
+    };
+
+    static const int maxRegisters = 16;
+
+    std::vector<Instruction> code;
+    bool usesTime = false;       // False means the value is fixed (folded at compile time)
+    bool usesVariables = false;  // Has LOAD_VAR: resolved when the statement runs
+
+    float evaluate(float t) const { return run(code.data(), code.size(), t); }
+
+    // Evaluate count instructions at code (bytecode packed into a shared array)
+    static float run(const Instruction* code, size_t count, float t);
+};
+
+// var / print expression: operands joined with '+'
+// Identifiers are interned when the program is compiled. Operands add while
+// both are numbers and concatenate as text otherwise ("n=" + 1 + 2 is "n=12").
+// Anything else ("2 * pi", "w / 2") is a numeric expression compiled to bytecode.
+struct ReplExpression {
+    struct Part {
+        bool isVariable;
+        ReplSymbol symbol;  // Variable (or object) name
+        ReplValue value;    // Literal: string, number or constant tuple
+    };
+    std::vector<Part> parts;
+    bool isNumeric = false;  // Evaluate bytecode instead of parts
+    ReplBytecode bytecode;
+};
+
+// Method/tuple argument, converted to a number at compile time when it is one
+struct ReplArgument {
+    std::string text;  // Source text, e.g. a layer name
+    bool isNumber;     // Constant (bytecode holds it too)
+    double number;
+    bool isAnimated;   // Depends on t: re-evaluated every frame from bytecode
+                       // (false with bytecode.usesVariables until the interpreter resolves it)
+    ReplBytecode bytecode;
+};
+
+// Process call: $name(positional..., key=value...)
+// Arguments are textures (names or nested calls) or constant parameters
+struct ReplProcessCall;
+
+struct ReplProcessArg {
+    enum class Kind {
+        NAME,    // Texture variable (or true/false)
+        NUMBER,  // numbers[0]
+        TUPLE,   // (1.0, 0.8, 0.4)
+        STRING,  // "horizontal"
+        CALL     // Nested $op(...)
+    };
+    std::string key;  // Empty for positional arguments
+    Kind kind;
+    std::string text;  // NAME / STRING
+    std::vector<float> numbers;
+    std::shared_ptr<ReplProcessCall> call;
+};
+
+struct ReplProcessCall {
+    std::string name;  // Without the '$'
+    std::vector<ReplProcessArg> args;
+};
+
+// process $name(params) { out = $op(...) ... return value }
+struct ReplProcessDef {
+    std::string name;  // Without the '$'
+    std::vector<std::string> params;
+    std::vector<std::pair<std::string, ReplProcessCall>> steps;
+    ReplProcessArg result;
+    int line;
+    std::string text;  // Source of the whole block (used to diff runs)
+};
+
+enum class ReplMethod {
+    TRANSFORM,  // layer.transform(x, y)
+    SCALE,      // layer.scale(w, h)
+    ROT,        // layer.rot(xy, y)
+    OPACITY,    // layer.opacity(percent)
+    CAST,       // input.cast(layer)
+    PROJECT,    // output.project(layer, z)
+    UNKNOWN
+};
+
+enum class ReplStatementType {
+    IN_VAR,       // in_var name = device;  or  in_var name = $process(source);
+    OUT_VAR,      // out_var name = target;
+    VAR,          // var name = expression;
+    LAYER_OBJ,    // layer_obj name;
+    SET_CANVAS,   // name.canvas = (w, h);
+    METHOD_CALL,  // name.method(args);
+    PRINTLN,      // println(expression);
+    PRINT         // print(expression);
+};
+
+struct ReplStatement {
+    ReplStatementType type;
+    int line;                // 1-based source line
+    std::string text;        // Source text without the trailing ';' (used to diff runs)
+    int group = 0;           // Line of its ';' group ("a; b" runs as one transaction), 0 if alone
+    std::string name;        // Declared variable, or the object of a property/method
+    ReplSymbol symbol = 0;   // Interned name (VAR)
+    std::string target;      // OUT_VAR target
+    int deviceIndex = 0;     // IN_VAR
+    std::shared_ptr<ReplProcessCall> process;  // IN_VAR fed by a process instead of a device
+    int width = 0;           // SET_CANVAS
+    int height = 0;
+    ReplMethod method = ReplMethod::UNKNOWN;
+    std::string methodName;  // For error messages
+    std::vector<ReplArgument> args;
+    ReplExpression expression;  // VAR, PRINTLN, PRINT
+};
+
+struct ReplProgram {
+    std::string source;  // Kept so a hash hit can be confirmed
+    uint64_t hash;
+    std::vector<ReplStatement> statements;
+    std::map<std::string, ReplProcessDef> processes;  // process blocks, by name
+    std::vector<std::string> errors;  // "line N: ..." for statements that were dropped
+};
+
+// 64-bit FNV-1a of the source text (program cache key)
+uint64_t hashReplSource(const std::string& source);
+
+// Parse source into a program; bad statements are skipped and listed in errors
+std::shared_ptr<ReplProgram> compileReplProgram(const std::string& source);
+
+#endif // REPL_PROGRAM_H
@@ -0,0 +1,45 @@
+#ifndef REPL_VALUE_H
+#define REPL_VALUE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Interned identifier: a dense id per distinct name
+// Names are interned when a program is compiled, so statements and expressions
+// carry ids and the interpreter indexes its variable store with them instead of
+// looking names up. Ids are shared by all programs and never freed; programs
+// may be compiled on a worker thread (ReplInterpreter::submit), so access is locked.
+using ReplSymbol = uint32_t;
+
+ReplSymbol internReplSymbol(const std::string& name);
+const std::string& replSymbolName(ReplSymbol symbol);
+size_t replSymbolCount();
+
+// Value of a var or of an expression
+struct ReplValue {
+    enum class Type {
+        NONE,    // Unset
+        NUMBER,  // 1920, 0.5
+        STRING,  // "text"
+        TUPLE,   // (1920, 1080)
+        OBJECT   // Handle to an in_var, out_var or layer_obj (by name)
+    };
+
+    Type type = Type::NONE;
+    double number = 0.0;
+    std::string text;
+    std::vector<double> tuple;
+    ReplSymbol object = 0;
+
+    static ReplValue makeNumber(double number);
+    static ReplValue makeString(std::string text);
+    static ReplValue makeTuple(std::vector<double> tuple);
+    static ReplValue makeObject(ReplSymbol object);
+
+    // Printed form: integers without a decimal point, tuples as (a, b), objects by name
+    void appendTo(std::string& out) const;
+    std::string toString() const;
+};
+
+#endif // REPL_VALUE_H
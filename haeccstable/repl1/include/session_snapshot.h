@@ -0,0 +1,63 @@
+#ifndef SESSION_SNAPSHOT_H
+#define SESSION_SNAPSHOT_H
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Binary snapshot of a live show, for restoring it at startup
+// The program is what rebuilds the graph (runs are incremental, so the last
+// applied program determines every object); the records carry what it can't
+// know until frames arrive: negotiated source formats and framebuffer sizes,
+// so GL resources are allocated while restoring instead of on the first frames.
+struct SessionSnapshot {
+    static constexpr uint32_t VERSION = 1;
+
+    struct Source {
+        std::string name;
+        int deviceIndex = -1;   // -1 for a process in_var
+        std::string deviceName;
+        int width = 0;          // Negotiated frame size (0 = not open)
+        int height = 0;
+        std::vector<std::pair<int, int>> inputSizes;  // Process in_vars: their inputs' frame sizes
+    };
+
+    struct Layer {
+        std::string name;
+        int canvasWidth = -1;
+        int canvasHeight = -1;
+        int framebufferWidth = 0;
+        int framebufferHeight = 0;
+        float posX = 0.0f, posY = 0.0f;
+        float scaleX = 1.0f, scaleY = 1.0f;
+        float rotXY = 0.0f, rotY = 0.0f;
+        float opacity = 100.0f;
+        std::string sourceName;  // in_var cast onto the layer ("" = none)
+    };
+
+    struct Output {
+        std::string name;
+        std::string target;
+        int width = 0;  // Composite size (0 = not composited yet)
+        int height = 0;
+        std::vector<std::pair<std::string, int>> stack;  // Layer name, z-index
+    };
+
+    std::string program;  // REPL code of the last applied run
+    std::vector<Source> sources;
+    std::vector<Layer> layers;
+    std::vector<Output> outputs;
+};
+
+// Encode/decode: magic, version, payload size and checksum, then the payload
+// (little-endian fixed-width fields, length-prefixed strings). Decoding rejects
+// other versions and damaged files with a message in error.
+void encodeSessionSnapshot(const SessionSnapshot& snapshot, std::string& out);
+bool decodeSessionSnapshot(const std::string& data, SessionSnapshot& snapshot, std::string& error);
+
+// File helpers; writing goes through a temp file and a rename
+bool writeSessionSnapshot(const std::string& filename, const std::string& encoded, std::string& error);
+bool readSessionSnapshot(const std::string& filename, SessionSnapshot& snapshot, std::string& error);
+
+#endif // SESSION_SNAPSHOT_H
@@ -0,0 +1,35 @@
+#ifndef SHADER_H
+#define SHADER_H
+
+#include <glad/glad.h>
+#include <string>
+#include <unordered_map>
+
+// Linked GL program with uniform locations resolved once at link time
+class Shader {
+public:
+    Shader();
+    ~Shader();
+
+    Shader(const Shader&) = delete;
+    Shader& operator=(const Shader&) = delete;
+
+    // Compile and link; logs and returns false on failure
+    bool load(const char* vertexSrc, const char* fragmentSrc);
+
+    // Cached location, -1 if the uniform does not exist (or was optimized out)
+    GLint uniform(const std::string& name) const;
+
+    // Attach a named uniform block to a UBO binding point
+    bool bindUniformBlock(const char* blockName, GLuint binding);
+
+    GLuint getProgram() const { return program; }
+
+private:
+    GLuint program;
+    std::unordered_map<std::string, GLint> uniformLocations;
+
+    GLuint compileShader(const char* source, GLenum shaderType);
+};
+
+#endif // SHADER_H
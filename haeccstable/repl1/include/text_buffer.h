@@ -1,6 +1,8 @@
 #ifndef TEXT_BUFFER_H
 #define TEXT_BUFFER_H
 
+#include "line_ring.h"
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -12,6 +14,8 @@ enum class VimMode {
 
 class TextBuffer {
 public:
+    // maxLines bounds the buffer; the oldest lines are evicted in O(1) past it,
+    // so console/shell can keep scrollback of a million lines or more
     TextBuffer(int maxLines = 100);
 
     // Cursor operations
@@ -41,11 +45,21 @@ public:
     void deleteCharBefore();  // Backspace
     void deleteLine();        // Delete entire line (dd)
 
+    // Bulk operations: text may contain '\n'; each call is one edit (one revision)
+    void setText(const std::string& text);  // Replace everything; a final '\n' adds no empty line
+    void insertText(int row, int col, const std::string& text);  // Cursor ends after the text
+    void replaceRange(int startRow, int startCol, int endRow, int endCol, const std::string& text);
+    void clear();                            // One empty line, cursor and scroll reset
+    std::string getText() const;             // Lines joined, each ending in '\n'
+
     // Buffer access
-    const std::vector<std::string>& getLines() const { return lines; }
+    const LineRing& getLines() const { return lines; }
     std::string getCurrentLine() const;
     int getLineCount() const { return lines.size(); }
 
+    // Incremented on every text change (not cursor/mode/scroll changes)
+    uint64_t getRevision() const { return revision; }
+
     // Mode
     VimMode getMode() const { return mode; }
     void setMode(VimMode m) { mode = m; }
@@ -61,16 +75,23 @@ public:
     void ensureCursorVisible();  // Auto-scroll to keep cursor in view
 
     // History (for console/shell)
+    // Evicting the oldest line keeps scroll offset and cursor on the same text
     void addOutputLine(const std::string& line);
+    uint64_t getEvictedLineCount() const { return evictedLines; }
 
 private:
-    std::vector<std::string> lines;
+    LineRing lines;
     int cursorRow;
     int cursorCol;
     VimMode mode;
     int maxLines;  // Maximum number of lines to keep
     int scrollOffset;  // For scrolling
     int visibleLines;  // Number of visible lines in the viewport
+    uint64_t revision;  // Text change counter for render caching
+    uint64_t evictedLines;  // Lines dropped from the front since creation
+
+    void evictOldestLine();
+    void trimToMaxLines();
 
     void ensureCursorValid();
 };
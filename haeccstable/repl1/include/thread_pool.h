@@ -0,0 +1,117 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing job system shared by every CPU subsystem (image kernels, REPL
+// preparation, headless readahead, device enumeration, pixel conversion)
+// Each worker thread owns a deque: it pushes and pops its own tasks at the back
+// (newest first, still warm in cache) and, when that runs dry, steals the oldest
+// task from the front of another deque. Threads outside the pool submit through
+// deque 0. Tasks that touch GL go through the main-thread queue instead, which
+// the render loop drains once per frame.
+class ThreadPool {
+public:
+    // threads = total threads including the caller (0 = hardware concurrency)
+    explicit ThreadPool(int threads = 0);
+    ~ThreadPool();  // Runs what is still queued, then joins
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Process-wide pool sized to the core count, with at least one worker
+    // thread so background jobs progress while the main thread renders
+    static ThreadPool& shared();
+
+    int getThreadCount() const { return (int)queues.size(); }
+
+    // Index of the calling thread in [0, getThreadCount()): 1.. for this pool's
+    // workers, 0 for any other thread
+    int currentWorker() const;
+
+    // Queue a task without tracking it (use TaskGroup to wait for results)
+    void submit(std::function<void()> task);
+
+    // Call fn(begin, end, worker) over [0, count) in chunks of up to grain indices
+    // and return when all have run. Chunks come off a shared counter, so faster
+    // threads take more; the caller works too and never waits on a busy pool.
+    // worker is currentWorker() of the thread running the chunk. Reentrant: fn
+    // may itself call parallelFor.
+    void parallelFor(int count, int grain, const std::function<void(int, int, int)>& fn);
+
+    // GL work (or anything else bound to the main thread), from any thread
+    void runOnMainThread(std::function<void()> task);
+    // Main thread only, once per frame: returns how many tasks ran
+    int runMainThreadTasks();
+    // Called after a task is queued for the main thread (e.g. glfwPostEmptyEvent
+    // while the main loop is idle)
+    void setMainThreadWakeup(void (*wakeup)()) { mainThreadWakeup.store(wakeup); }
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    // One per thread slot; unique_ptr because the mutexes can't move
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::vector<std::thread> workers;
+
+    std::atomic<int> queuedTasks;  // Across all deques
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    bool stopping;
+
+    std::mutex mainThreadMutex;
+    std::vector<std::function<void()>> mainThreadTasks;
+    std::atomic<void (*)()> mainThreadWakeup;
+
+    void workerLoop(int worker);
+    bool popTask(int worker, std::function<void()>& task);  // Own deque first, then steal
+
+    friend class TaskGroup;
+    bool runOneTask();  // On a worker thread: false if nothing was queued
+};
+
+// Set of tasks to wait for together, with an optional continuation
+// wait() on one of the pool's workers runs queued tasks while it waits; any
+// other thread (the main thread in particular) just blocks, so a long job never
+// lands on the render loop by accident.
+class TaskGroup {
+public:
+    explicit TaskGroup(ThreadPool& pool = ThreadPool::shared());
+    ~TaskGroup();  // Waits
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    void run(std::function<void()> task);
+    void wait();
+    bool isDone() const { return pending.load(std::memory_order_acquire) == 0; }
+
+    // Runs once every task run so far has finished (right away if they have):
+    // on a worker, or on the main thread's next runMainThreadTasks(). wait()
+    // does not wait for it.
+    void then(std::function<void()> continuation, bool onMainThread = false);
+
+private:
+    ThreadPool& pool;
+    std::atomic<int> pending;
+    std::mutex mutex;
+    std::condition_variable finished;
+    std::function<void()> continuation;
+    bool continuationOnMainThread;
+
+    void finishTask();
+    void dispatch(std::function<void()> task, bool onMainThread);
+};
+
+#endif // THREAD_POOL_H
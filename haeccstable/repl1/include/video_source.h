@@ -1,6 +1,8 @@
 #ifndef VIDEO_SOURCE_H
 #define VIDEO_SOURCE_H
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
@@ -40,6 +42,9 @@ struct VideoFrame {
 };
 
 // Lazy video source - only captures frames when requested
+// Frames cross from the capture thread to the render thread through a lock-free
+// latest-frame mailbox (triple buffer): capture never waits for rendering, and
+// a frame replaced before the render thread took it is dropped, not queued.
 class VideoSource {
 public:
     // Device info for enumeration
@@ -70,9 +75,33 @@ public:
     // Returns nullptr if no new frame is available
     std::optional<std::shared_ptr<VideoFrame>> getFrame();
 
+    // Latest frame without consuming it (several render graphs may read one source)
+    // Render thread only, like getFrame()
+    std::shared_ptr<VideoFrame> peekFrame() {
+        takeNewFrame();
+        return isActive ? frameSlots[frontSlot] : nullptr;
+    }
+
     // Close the video source
     void close();
 
+    // Frame counters for the dossier's performance section (relaxed atomics:
+    // the capture thread bumps them, the dossier writer samples them)
+    uint64_t getDeliveredFrames() const { return deliveredFrames.load(std::memory_order_relaxed); }
+    uint64_t getDroppedFrames() const { return droppedFrames.load(std::memory_order_relaxed); }
+
+    // Called from the capture thread after every published frame, for all
+    // sources (the editor passes glfwPostEmptyEvent to wake its idle loop)
+    static void setFrameWakeup(void (*wakeup)()) { frameWakeup.store(wakeup, std::memory_order_relaxed); }
+
+    // Activate without a capture device; frames arrive through onNewFrame()
+    // (headless runs feed synthetic or file frames this way)
+    void openExternal(int width, int height) {
+        frameWidth = width;
+        frameHeight = height;
+        isActive = true;
+    }
+
 private:
     // Platform-specific capture session
     AVCaptureSession* captureSession;
@@ -85,9 +114,42 @@ private:
     int frameWidth;
     int frameHeight;
 
-    // Latest frame (shared ownership for zero-copy)
-    std::shared_ptr<VideoFrame> latestFrame;
-    bool hasNewFrame;
+    // Latest-frame mailbox (shared ownership for zero-copy): the capture thread
+    // owns backSlot, the render thread frontSlot; they trade through middleSlot,
+    // which carries NEW_FRAME until the render thread takes it
+    static constexpr int NEW_FRAME = 4;
+    std::shared_ptr<VideoFrame> frameSlots[3];
+    std::atomic<int> middleSlot;
+    int backSlot;
+    int frontSlot;
+    bool frontUnread;  // getFrame() hasn't returned frameSlots[frontSlot] yet
+
+    std::atomic<uint64_t> deliveredFrames;
+    std::atomic<uint64_t> droppedFrames;   // Replaced before the render thread took them
+
+    inline static std::atomic<void (*)()> frameWakeup{nullptr};
+
+    // Swap a newer frame into frontSlot, if the capture thread left one (render thread)
+    void takeNewFrame() {
+        if (middleSlot.load(std::memory_order_relaxed) & NEW_FRAME) {
+            frontSlot = middleSlot.exchange(frontSlot, std::memory_order_acq_rel) & 3;
+            frontUnread = true;
+        }
+    }
+
+    // Publish a frame (capture thread)
+    void putFrame(std::shared_ptr<VideoFrame> frame) {
+        frameSlots[backSlot] = std::move(frame);
+        int previous = middleSlot.exchange(backSlot | NEW_FRAME, std::memory_order_acq_rel);
+        if (previous & NEW_FRAME) {
+            droppedFrames.fetch_add(1, std::memory_order_relaxed);
+        }
+        backSlot = previous & 3;
+        deliveredFrames.fetch_add(1, std::memory_order_relaxed);
+        if (auto wakeup = frameWakeup.load(std::memory_order_relaxed)) {
+            wakeup();
+        }
+    }
 
 public:
     // Frame callback from delegate (must be public for Objective-C delegate)
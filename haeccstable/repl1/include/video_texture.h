@@ -34,8 +34,9 @@ public:
     bool init(int width, int height);
 
     // Upload video frame to GPU (lazy - only if frame changed)
-    // Uses PBO for async transfer
-    void update(std::shared_ptr<VideoFrame> frame);
+    // Streams through a PBO into storage allocated once, so the call returns
+    // without waiting for the GPU. Returns whether anything was uploaded.
+    bool update(std::shared_ptr<VideoFrame> frame);
 
     // Get OpenGL texture ID
     GLuint getTextureID() const { return textureID; }
@@ -14,7 +14,10 @@ public:
     bool shouldClose();
     void swapBuffers();
     void pollEvents();
+    void waitEvents(double timeoutSeconds);  // Sleeps until an event (or glfwPostEmptyEvent) or the timeout
+    void setSwapInterval(int interval);
     GLFWwindow* getWindow() { return window; }
+    int getMonitorIndex();  // Index in glfwGetMonitors() of the monitor holding the window's center (-1 if none)
     void getFramebufferSize(int* width, int* height);
 
 private:
@@ -24,6 +27,7 @@ private:
     int windowedPosX;
     int windowedPosY;
     bool isFullscreen;
+    int swapInterval;
 };
 
 #endif // WINDOW_MANAGER_H
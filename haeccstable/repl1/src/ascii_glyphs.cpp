@@ -0,0 +1,52 @@
+#include "ascii_glyphs.h"
+#include "bitmap_font.h"
+
+// Edge glyphs as one-pixel lines through the cell, rows top to bottom
+static const uint8_t edgeGlyphs[AsciiGlyphs::edgeGlyphCount][AsciiGlyphs::cellSize] = {
+    {0b00010000, 0b00010000, 0b00010000, 0b00010000, 0b00010000, 0b00010000, 0b00010000, 0b00010000},  // |
+    {0b00000001, 0b00000010, 0b00000100, 0b00001000, 0b00010000, 0b00100000, 0b01000000, 0b10000000},  // /
+    {0b00000000, 0b00000000, 0b00000000, 0b11111111, 0b00000000, 0b00000000, 0b00000000, 0b00000000},  // -
+    {0b10000000, 0b01000000, 0b00100000, 0b00010000, 0b00001000, 0b00000100, 0b00000010, 0b00000001},  // backslash
+};
+
+AsciiGlyphs::AsciiGlyphs() : rampLength(0) {
+}
+
+bool AsciiGlyphs::build(const std::string& ramp, std::string& error) {
+    if (ramp.empty() || (int)ramp.size() > maxRampLength) {
+        error = "ascii chars must have 1 to " + std::to_string(maxRampLength) + " characters";
+        return false;
+    }
+    for (char c : ramp) {
+        if (bitmapFontIndex(c) < 0) {
+            error = std::string("ascii chars: no glyph for '") + c + "'";
+            return false;
+        }
+    }
+
+    rampLength = (int)ramp.size();
+    pixels.assign((size_t)getAtlasWidth() * cellSize, 0);
+    int width = getAtlasWidth();
+
+    // Font glyphs sit one pixel in from the left, leaving a gap column and row
+    for (int i = 0; i < rampLength; i++) {
+        const uint32_t* rows = bitmapFontGlyph(bitmapFontIndex(ramp[i]));
+        for (int y = 0; y < bitmapFontHeight; y++) {
+            for (int x = 0; x < bitmapFontWidth; x++) {
+                if ((rows[y] >> (bitmapFontWidth - 1 - x)) & 1) {
+                    pixels[(size_t)y * width + i * cellSize + 1 + x] = 255;
+                }
+            }
+        }
+    }
+    for (int e = 0; e < edgeGlyphCount; e++) {
+        for (int y = 0; y < cellSize; y++) {
+            for (int x = 0; x < cellSize; x++) {
+                if ((edgeGlyphs[e][y] >> (cellSize - 1 - x)) & 1) {
+                    pixels[(size_t)y * width + (rampLength + e) * cellSize + x] = 255;
+                }
+            }
+        }
+    }
+    return true;
+}
@@ -0,0 +1,223 @@
+#include "bitmap_font.h"
+#include <array>
+
+// Each character is 5 pixels wide, 7 pixels tall (row by row, top to bottom)
+static const uint32_t font[][bitmapFontHeight] = {
+    // '0' - index 0
+    {0b01110, 0b10001, 0b10011, 0b10101, 0b11001, 0b10001, 0b01110},
+    // '1' - index 1
+    {0b00100, 0b01100, 0b00100, 0b00100, 0b00100, 0b00100, 0b01110},
+    // '2' - index 2
+    {0b01110, 0b10001, 0b00001, 0b00010, 0b00100, 0b01000, 0b11111},
+    // '3' - index 3
+    {0b11111, 0b00010, 0b00100, 0b00010, 0b00001, 0b10001, 0b01110},
+    // '4' - index 4
+    {0b00010, 0b00110, 0b01010, 0b10010, 0b11111, 0b00010, 0b00010},
+    // '5' - index 5
+    {0b11111, 0b10000, 0b11110, 0b00001, 0b00001, 0b10001, 0b01110},
+    // '6' - index 6
+    {0b00110, 0b01000, 0b10000, 0b11110, 0b10001, 0b10001, 0b01110},
+    // '7' - index 7
+    {0b11111, 0b00001, 0b00010, 0b00100, 0b01000, 0b01000, 0b01000},
+    // '8' - index 8
+    {0b01110, 0b10001, 0b10001, 0b01110, 0b10001, 0b10001, 0b01110},
+    // '9' - index 9
+    {0b01110, 0b10001, 0b10001, 0b01111, 0b00001, 0b00010, 0b01100},
+    // 'A' - index 10
+    {0b01110, 0b10001, 0b10001, 0b11111, 0b10001, 0b10001, 0b10001},
+    // 'B' - index 11
+    {0b11110, 0b10001, 0b10001, 0b11110, 0b10001, 0b10001, 0b11110},
+    // 'C' - index 12
+    {0b01110, 0b10001, 0b10000, 0b10000, 0b10000, 0b10001, 0b01110},
+    // 'D' - index 13
+    {0b11110, 0b10001, 0b10001, 0b10001, 0b10001, 0b10001, 0b11110},
+    // 'E' - index 14
+    {0b11111, 0b10000, 0b10000, 0b11110, 0b10000, 0b10000, 0b11111},
+    // 'F' - index 15
+    {0b11111, 0b10000, 0b10000, 0b11110, 0b10000, 0b10000, 0b10000},
+    // 'G' - index 16
+    {0b01110, 0b10001, 0b10000, 0b10111, 0b10001, 0b10001, 0b01111},
+    // 'H' - index 17
+    {0b10001, 0b10001, 0b10001, 0b11111, 0b10001, 0b10001, 0b10001},
+    // 'I' - index 18
+    {0b01110, 0b00100, 0b00100, 0b00100, 0b00100, 0b00100, 0b01110},
+    // 'J' - index 19
+    {0b00111, 0b00010, 0b00010, 0b00010, 0b00010, 0b10010, 0b01100},
+    // 'K' - index 20
+    {0b10001, 0b10010, 0b10100, 0b11000, 0b10100, 0b10010, 0b10001},
+    // 'L' - index 21
+    {0b10000, 0b10000, 0b10000, 0b10000, 0b10000, 0b10000, 0b11111},
+    // 'M' - index 22
+    {0b10001, 0b11011, 0b10101, 0b10101, 0b10001, 0b10001, 0b10001},
+    // 'N' - index 23
+    {0b10001, 0b10001, 0b11001, 0b10101, 0b10011, 0b10001, 0b10001},
+    // 'O' - index 24
+    {0b01110, 0b10001, 0b10001, 0b10001, 0b10001, 0b10001, 0b01110},
+    // 'P' - index 25
+    {0b11110, 0b10001, 0b10001, 0b11110, 0b10000, 0b10000, 0b10000},
+    // 'Q' - index 26
+    {0b01110, 0b10001, 0b10001, 0b10001, 0b10101, 0b10010, 0b01101},
+    // 'R' - index 27
+    {0b11110, 0b10001, 0b10001, 0b11110, 0b10100, 0b10010, 0b10001},
+    // 'S' - index 28
+    {0b01111, 0b10000, 0b10000, 0b01110, 0b00001, 0b00001, 0b11110},
+    // 'T' - index 29
+    {0b11111, 0b00100, 0b00100, 0b00100, 0b00100, 0b00100, 0b00100},
+    // 'U' - index 30
+    {0b10001, 0b10001, 0b10001, 0b10001, 0b10001, 0b10001, 0b01110},
+    // 'V' - index 31
+    {0b10001, 0b10001, 0b10001, 0b10001, 0b10001, 0b01010, 0b00100},
+    // 'W' - index 32
+    {0b10001, 0b10001, 0b10001, 0b10101, 0b10101, 0b11011, 0b10001},
+    // 'X' - index 33
+    {0b10001, 0b10001, 0b01010, 0b00100, 0b01010, 0b10001, 0b10001},
+    // 'Y' - index 34
+    {0b10001, 0b10001, 0b10001, 0b01010, 0b00100, 0b00100, 0b00100},
+    // 'Z' - index 35
+    {0b11111, 0b00001, 0b00010, 0b00100, 0b01000, 0b10000, 0b11111},
+    // '.' - index 36
+    {0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b00100},
+    // ' ' - index 37 (space)
+    {0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000},
+    // 'a' - index 38
+    {0b00000, 0b00000, 0b01110, 0b00001, 0b01111, 0b10001, 0b01111},
+    // 'b' - index 39
+    {0b10000, 0b10000, 0b11110, 0b10001, 0b10001, 0b10001, 0b11110},
+    // 'c' - index 40
+    {0b00000, 0b00000, 0b01110, 0b10000, 0b10000, 0b10001, 0b01110},
+    // 'd' - index 41
+    {0b00001, 0b00001, 0b01111, 0b10001, 0b10001, 0b10001, 0b01111},
+    // 'e' - index 42
+    {0b00000, 0b00000, 0b01110, 0b10001, 0b11111, 0b10000, 0b01110},
+    // 'f' - index 43
+    {0b00110, 0b01001, 0b01000, 0b11110, 0b01000, 0b01000, 0b01000},
+    // 'g' - index 44
+    {0b00000, 0b00000, 0b01111, 0b10001, 0b01111, 0b00001, 0b01110},
+    // 'h' - index 45
+    {0b10000, 0b10000, 0b11110, 0b10001, 0b10001, 0b10001, 0b10001},
+    // 'i' - index 46
+    {0b00100, 0b00000, 0b01100, 0b00100, 0b00100, 0b00100, 0b01110},
+    // 'j' - index 47
+    {0b00010, 0b00000, 0b00110, 0b00010, 0b00010, 0b10010, 0b01100},
+    // 'k' - index 48
+    {0b10000, 0b10000, 0b10010, 0b10100, 0b11000, 0b10100, 0b10010},
+    // 'l' - index 49
+    {0b01100, 0b00100, 0b00100, 0b00100, 0b00100, 0b00100, 0b01110},
+    // 'm' - index 50
+    {0b00000, 0b00000, 0b11010, 0b10101, 0b10101, 0b10101, 0b10001},
+    // 'n' - index 51
+    {0b00000, 0b00000, 0b11110, 0b10001, 0b10001, 0b10001, 0b10001},
+    // 'o' - index 52
+    {0b00000, 0b00000, 0b01110, 0b10001, 0b10001, 0b10001, 0b01110},
+    // 'p' - index 53
+    {0b00000, 0b00000, 0b11110, 0b10001, 0b11110, 0b10000, 0b10000},
+    // 'q' - index 54
+    {0b00000, 0b00000, 0b01111, 0b10001, 0b01111, 0b00001, 0b00001},
+    // 'r' - index 55
+    {0b00000, 0b00000, 0b10110, 0b11001, 0b10000, 0b10000, 0b10000},
+    // 's' - index 56
+    {0b00000, 0b00000, 0b01111, 0b10000, 0b01110, 0b00001, 0b11110},
+    // 't' - index 57
+    {0b01000, 0b01000, 0b11110, 0b01000, 0b01000, 0b01001, 0b00110},
+    // 'u' - index 58
+    {0b00000, 0b00000, 0b10001, 0b10001, 0b10001, 0b10011, 0b01101},
+    // 'v' - index 59
+    {0b00000, 0b00000, 0b10001, 0b10001, 0b10001, 0b01010, 0b00100},
+    // 'w' - index 60
+    {0b00000, 0b00000, 0b10001, 0b10101, 0b10101, 0b10101, 0b01010},
+    // 'x' - index 61
+    {0b00000, 0b00000, 0b10001, 0b01010, 0b00100, 0b01010, 0b10001},
+    // 'y' - index 62
+    {0b00000, 0b00000, 0b10001, 0b10001, 0b01111, 0b00001, 0b01110},
+    // 'z' - index 63
+    {0b00000, 0b00000, 0b11111, 0b00010, 0b00100, 0b01000, 0b11111},
+    // '>' - index 64
+    {0b10000, 0b01000, 0b00100, 0b00010, 0b00100, 0b01000, 0b10000},
+    // '<' - index 65
+    {0b00001, 0b00010, 0b00100, 0b01000, 0b00100, 0b00010, 0b00001},
+    // ':' - index 66
+    {0b00000, 0b00100, 0b00000, 0b00000, 0b00000, 0b00100, 0b00000},
+    // ',' - index 67
+    {0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b00100, 0b01000},
+    // '/' - index 68
+    {0b00001, 0b00010, 0b00010, 0b00100, 0b01000, 0b01000, 0b10000},
+    // '-' - index 69
+    {0b00000, 0b00000, 0b00000, 0b11111, 0b00000, 0b00000, 0b00000},
+    // '_' - index 70
+    {0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b11111},
+    // '(' - index 71
+    {0b00010, 0b00100, 0b01000, 0b01000, 0b01000, 0b00100, 0b00010},
+    // ')' - index 72
+    {0b01000, 0b00100, 0b00010, 0b00010, 0b00010, 0b00100, 0b01000},
+    // '[' - index 73
+    {0b01110, 0b01000, 0b01000, 0b01000, 0b01000, 0b01000, 0b01110},
+    // ']' - index 74
+    {0b01110, 0b00010, 0b00010, 0b00010, 0b00010, 0b00010, 0b01110},
+    // '=' - index 75
+    {0b00000, 0b00000, 0b11111, 0b00000, 0b11111, 0b00000, 0b00000},
+    // '+' - index 76
+    {0b00000, 0b00100, 0b00100, 0b11111, 0b00100, 0b00100, 0b00000},
+    // '"' - index 77
+    {0b01010, 0b01010, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000},
+    // '\'' - index 78
+    {0b00100, 0b00100, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000},
+    // ';' - index 79
+    {0b00000, 0b00100, 0b00000, 0b00000, 0b00000, 0b00100, 0b01000},
+    // '*' - index 80
+    {0b00000, 0b00100, 0b10101, 0b01110, 0b10101, 0b00100, 0b00000},
+    // '#' - index 81
+    {0b01010, 0b01010, 0b11111, 0b01010, 0b11111, 0b01010, 0b01010},
+    // '%' - index 82
+    {0b11000, 0b11001, 0b00010, 0b00100, 0b01000, 0b10011, 0b00011},
+    // '@' - index 83
+    {0b01110, 0b10001, 0b10111, 0b10101, 0b10111, 0b10000, 0b01110},
+    // '|' - index 84
+    {0b00100, 0b00100, 0b00100, 0b00100, 0b00100, 0b00100, 0b00100},
+    // '\\' - index 85
+    {0b10000, 0b01000, 0b01000, 0b00100, 0b00010, 0b00010, 0b00001},
+    // '!' - index 86
+    {0b00100, 0b00100, 0b00100, 0b00100, 0b00100, 0b00000, 0b00100},
+    // '?' - index 87
+    {0b01110, 0b10001, 0b00001, 0b00010, 0b00100, 0b00000, 0b00100},
+    // '&' - index 88
+    {0b01100, 0b10010, 0b10100, 0b01000, 0b10101, 0b10010, 0b01101},
+    // '$' - index 89
+    {0b00100, 0b01111, 0b10100, 0b01110, 0b00101, 0b11110, 0b00100},
+    // '^' - index 90
+    {0b00100, 0b01010, 0b10001, 0b00000, 0b00000, 0b00000, 0b00000},
+    // '~' - index 91
+    {0b00000, 0b00000, 0b01000, 0b10101, 0b00010, 0b00000, 0b00000},
+    // '`' - index 92
+    {0b01000, 0b00100, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000},
+    // '{' - index 93
+    {0b00010, 0b00100, 0b00100, 0b01000, 0b00100, 0b00100, 0b00010},
+    // '}' - index 94
+    {0b01000, 0b00100, 0b00100, 0b00010, 0b00100, 0b00100, 0b01000},
+};
+
+static const int fontGlyphCount = sizeof(font) / sizeof(font[0]);
+
+int bitmapFontGlyphCount() {
+    return fontGlyphCount;
+}
+
+const uint32_t* bitmapFontGlyph(int index) {
+    return index >= 0 && index < fontGlyphCount ? font[index] : nullptr;
+}
+
+int bitmapFontIndex(char c) {
+    static const auto table = [] {
+        std::array<int8_t, 128> t;
+        t.fill(-1);
+        for (char d = '0'; d <= '9'; d++) t[d] = d - '0';
+        for (char u = 'A'; u <= 'Z'; u++) t[u] = 10 + (u - 'A');
+        for (char l = 'a'; l <= 'z'; l++) t[l] = 38 + (l - 'a');
+        t['.'] = 36;
+        t[' '] = 37;
+        const char symbols[] = "><:,/-_()[]=+\"';*#%@|\\!?&$^~`{}";
+        for (int i = 0; symbols[i]; i++) t[(unsigned char)symbols[i]] = 64 + i;
+        return t;
+    }();
+    unsigned char uc = (unsigned char)c;
+    return uc < 128 ? table[uc] : -1;
+}
@@ -2,20 +2,51 @@
 #include <glad/glad.h>  // Must include GLAD before GLFW
 #define GLFW_INCLUDE_NONE  // Prevent GLFW from including system OpenGL headers
 #include <GLFW/glfw3.h>
+#include <algorithm>
+#include <cstdio>
 #include <fstream>
-#include <sstream>
 #include <iostream>
-#include <iomanip>
 
-DossierManager::DossierManager() {
+DossierManager::DossierManager()
+    : physicalMonitorCount(0), debounce(250), autoSave(false), fileDirty(false),
+      writing(false), stopping(false), frameCount(0), uiRenderMillis(0.0f), gpuMemoryBytes(-1),
+      skippedVideoFrames(0), loopIdle(false), performanceInterval(0), lastSampleFrames(0), lastSampleSkipped(0),
+      streamSequence(0) {
+    for (int i = 0; i < SECTION_COUNT; i++) {
+        sectionStale[i] = true;
+    }
+    for (auto& millis : frameMillis) {
+        millis.store(0.0f, std::memory_order_relaxed);
+    }
+}
+
+DossierManager::~DossierManager() {
+    stream.reset();  // Its thread takes snapshots under mutex
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    if (writer.joinable()) {
+        writer.join();
+    }
 }
 
 void DossierManager::updateVideoDevices() {
-    videoDevices = VideoSource::enumerateDevices();
+    setVideoDevices(VideoSource::enumerateDevices());
+}
+
+void DossierManager::setVideoDevices(std::vector<VideoSource::DeviceInfo> devices) {
+    std::lock_guard<std::mutex> lock(mutex);
+    videoDevices = std::move(devices);
+    markChanged(SECTION_VIDEO_DEVICES);
+    if (streaming()) publishSection(SECTION_VIDEO_DEVICES);
     std::cout << "Enumerated " << videoDevices.size() << " video devices\n";
 }
 
 void DossierManager::updateMonitors() {
+    std::lock_guard<std::mutex> lock(mutex);
+    markChanged(SECTION_MONITORS);
     monitors.clear();
 
     int count;
@@ -42,6 +73,7 @@ void DossierManager::updateMonitors() {
 
         monitors.push_back(info);
     }
+    physicalMonitorCount = count;
 
     // Add virtual monitors
     // Virtual monitor1 (1920x1080 desktop display)
@@ -63,11 +95,35 @@ void DossierManager::updateMonitors() {
     virtualMonitor2.refreshRate = 60;
     virtualMonitor2.isPrimary = false;
     monitors.push_back(virtualMonitor2);
+    if (streaming()) publishSection(SECTION_MONITORS);
 
     std::cout << "Enumerated " << monitors.size() << " monitors ("
               << count << " physical, " << (monitors.size() - count) << " virtual)\n";
 }
 
+int DossierManager::findPhysicalMonitor(const std::string& target) const {
+    // Strip optional quotes: out_var show = "DELL U2720Q";
+    std::string name = target;
+    if (name.size() >= 2 && (name.front() == '"' || name.front() == '\'') && name.back() == name.front()) {
+        name = name.substr(1, name.size() - 2);
+    }
+    if (name.empty()) return -1;
+
+    // Numeric target: dossier monitor index (only physical monitors qualify)
+    if (name.size() <= 4 && name.find_first_not_of("0123456789") == std::string::npos) {
+        int index = std::stoi(name);
+        return (index < physicalMonitorCount) ? index : -1;
+    }
+
+    // Otherwise match the monitor name reported by GLFW
+    for (int i = 0; i < physicalMonitorCount && i < (int)monitors.size(); i++) {
+        if (monitors[i].name == name) {
+            return i;
+        }
+    }
+    return -1;
+}
+
 void DossierManager::registerInputVariable(const std::string& name, int deviceIndex,
                                             std::shared_ptr<VideoSource> source) {
     InputVariableInfo info;
@@ -90,8 +146,14 @@ void DossierManager::registerInputVariable(const std::string& name, int deviceIn
         info.height = 0;
     }
 
+    std::lock_guard<std::mutex> lock(mutex);
+    if (streaming()) {
+        auto previous = inputVariables.find(name);
+        publishInputVariable(info, previous != inputVariables.end() ? &previous->second : nullptr);
+    }
     inputVariables[name] = info;
     inputSources[name] = source;
+    markChanged(SECTION_INPUT_VARIABLES);
 
     std::cout << "Registered input variable '" << name << "' (device " << deviceIndex << ")\n";
 }
@@ -114,8 +176,14 @@ void DossierManager::registerOutputVariable(const std::string& name, const std::
         info.layerCount = 0;
     }
 
+    std::lock_guard<std::mutex> lock(mutex);
+    if (streaming()) {
+        auto previous = outputVariables.find(name);
+        publishOutputVariable(info, previous != outputVariables.end() ? &previous->second : nullptr);
+    }
     outputVariables[name] = info;
     outputObjects[name] = output;
+    markChanged(SECTION_OUTPUT_VARIABLES);
 
     std::cout << "Registered output variable '" << name << "' -> " << target << "\n";
 }
@@ -157,154 +225,682 @@ void DossierManager::registerLayer(const std::string& name, std::shared_ptr<Laye
         info.opacity = 100.0f;
     }
 
+    std::lock_guard<std::mutex> lock(mutex);
+    if (streaming()) {
+        auto previous = layers.find(name);
+        publishLayer(info, previous != layers.end() ? &previous->second : nullptr);
+    }
     layers[name] = info;
     layerObjects[name] = layer;
+    markChanged(SECTION_LAYERS);
 
     std::cout << "Registered layer '" << name << "'\n";
 }
 
 void DossierManager::unregisterInputVariable(const std::string& name) {
-    inputVariables.erase(name);
+    std::lock_guard<std::mutex> lock(mutex);
+    if (inputVariables.erase(name) > 0) {
+        markChanged(SECTION_INPUT_VARIABLES);
+        if (streaming()) publishRemove("inputVariables", name);
+    }
     inputSources.erase(name);
 }
 
 void DossierManager::unregisterOutputVariable(const std::string& name) {
-    outputVariables.erase(name);
+    std::lock_guard<std::mutex> lock(mutex);
+    if (outputVariables.erase(name) > 0) {
+        markChanged(SECTION_OUTPUT_VARIABLES);
+        if (streaming()) publishRemove("outputVariables", name);
+    }
     outputObjects.erase(name);
 }
 
 void DossierManager::unregisterLayer(const std::string& name) {
-    layers.erase(name);
+    std::lock_guard<std::mutex> lock(mutex);
+    if (layers.erase(name) > 0) {
+        markChanged(SECTION_LAYERS);
+        if (streaming()) publishRemove("layers", name);
+    }
     layerObjects.erase(name);
 }
 
-std::string DossierManager::escapeJSON(const std::string& str) const {
-    std::string escaped;
+void DossierManager::markChanged(Section section) {
+    sectionStale[section] = true;
+    if (!autoSave) return;
+
+    // Debounce: wait for changes to settle, but not forever
+    auto now = std::chrono::steady_clock::now();
+    if (!fileDirty) {
+        fileDirty = true;
+        firstChange = now;
+        saveDeadline = now + debounce;
+        wake.notify_one();
+    } else {
+        saveDeadline = std::min(now + debounce, firstChange + 4 * debounce);
+    }
+}
+
+void DossierManager::appendEscaped(std::string& out, const std::string& str) {
     for (char c : str) {
         switch (c) {
-            case '"':  escaped += "\\\""; break;
-            case '\\': escaped += "\\\\"; break;
-            case '\n': escaped += "\\n"; break;
-            case '\r': escaped += "\\r"; break;
-            case '\t': escaped += "\\t"; break;
-            default:   escaped += c; break;
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:   out += c; break;
         }
     }
-    return escaped;
 }
 
-std::string DossierManager::formatNumber(float value) const {
-    std::ostringstream oss;
-    oss << std::fixed << std::setprecision(2) << value;
-    return oss.str();
+void DossierManager::appendNumber(std::string& out, float value) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.2f", value);
+    out += buffer;
+}
+
+void DossierManager::serializeSection(Section section, std::string& out) const {
+    switch (section) {
+    case SECTION_VIDEO_DEVICES:
+        out += "  \"videoDevices\": [\n";
+        for (size_t i = 0; i < videoDevices.size(); i++) {
+            const auto& dev = videoDevices[i];
+            out += "    {\n";
+            out += "      \"index\": " + std::to_string(dev.index) + ",\n";
+            out += "      \"id\": \"";
+            appendEscaped(out, dev.id);
+            out += "\",\n      \"name\": \"";
+            appendEscaped(out, dev.name);
+            out += "\"\n    }";
+            if (i < videoDevices.size() - 1) out += ",";
+            out += "\n";
+        }
+        out += "  ]";
+        break;
+
+    case SECTION_MONITORS:
+        out += "  \"monitors\": [\n";
+        for (size_t i = 0; i < monitors.size(); i++) {
+            const auto& mon = monitors[i];
+            out += "    {\n";
+            out += "      \"index\": " + std::to_string(mon.index) + ",\n";
+            out += "      \"name\": \"";
+            appendEscaped(out, mon.name);
+            out += "\",\n";
+            out += "      \"width\": " + std::to_string(mon.width) + ",\n";
+            out += "      \"height\": " + std::to_string(mon.height) + ",\n";
+            out += "      \"refreshRate\": " + std::to_string(mon.refreshRate) + ",\n";
+            out += "      \"isPrimary\": ";
+            out += mon.isPrimary ? "true" : "false";
+            out += "\n    }";
+            if (i < monitors.size() - 1) out += ",";
+            out += "\n";
+        }
+        out += "  ]";
+        break;
+
+    case SECTION_INPUT_VARIABLES: {
+        out += "  \"inputVariables\": {\n";
+        size_t idx = 0;
+        for (const auto& [name, info] : inputVariables) {
+            out += "    \"";
+            appendEscaped(out, name);
+            out += "\": {\n";
+            out += "      \"deviceIndex\": " + std::to_string(info.deviceIndex) + ",\n";
+            out += "      \"deviceName\": \"";
+            appendEscaped(out, info.deviceName);
+            out += "\",\n";
+            out += "      \"width\": " + std::to_string(info.width) + ",\n";
+            out += "      \"height\": " + std::to_string(info.height) + "\n";
+            out += "    }";
+            if (idx < inputVariables.size() - 1) out += ",";
+            out += "\n";
+            idx++;
+        }
+        out += "  }";
+        break;
+    }
+
+    case SECTION_OUTPUT_VARIABLES: {
+        out += "  \"outputVariables\": {\n";
+        size_t idx = 0;
+        for (const auto& [name, info] : outputVariables) {
+            out += "    \"";
+            appendEscaped(out, name);
+            out += "\": {\n";
+            out += "      \"target\": \"";
+            appendEscaped(out, info.target);
+            out += "\",\n";
+            out += "      \"layerCount\": " + std::to_string(info.layerCount) + ",\n";
+            out += "      \"layers\": [";
+            for (size_t i = 0; i < info.layerNames.size(); i++) {
+                out += "\"";
+                appendEscaped(out, info.layerNames[i]);
+                out += "\"";
+                if (i < info.layerNames.size() - 1) out += ", ";
+            }
+            out += "]\n";
+            out += "    }";
+            if (idx < outputVariables.size() - 1) out += ",";
+            out += "\n";
+            idx++;
+        }
+        out += "  }";
+        break;
+    }
+
+    case SECTION_LAYERS: {
+        out += "  \"layers\": {\n";
+        size_t idx = 0;
+        for (const auto& [name, info] : layers) {
+            out += "    \"";
+            appendEscaped(out, name);
+            out += "\": {\n";
+            out += "      \"canvas\": [" + std::to_string(info.canvasWidth) + ", " +
+                   std::to_string(info.canvasHeight) + "],\n";
+            out += "      \"position\": [";
+            appendNumber(out, info.posX);
+            out += ", ";
+            appendNumber(out, info.posY);
+            out += "],\n      \"scale\": [";
+            appendNumber(out, info.scaleX);
+            out += ", ";
+            appendNumber(out, info.scaleY);
+            out += "],\n      \"rotation\": [";
+            appendNumber(out, info.rotXY);
+            out += ", ";
+            appendNumber(out, info.rotY);
+            out += "],\n      \"opacity\": ";
+            appendNumber(out, info.opacity);
+            out += ",\n      \"source\": \"";
+            appendEscaped(out, info.sourceName);
+            out += "\"\n    }";
+            if (idx < layers.size() - 1) out += ",";
+            out += "\n";
+            idx++;
+        }
+        out += "  }";
+        break;
+    }
+
+    case SECTION_PERFORMANCE:
+        out += performanceText.empty() ? "  \"performance\": {}" : performanceText;
+        break;
+
+    case SECTION_COUNT:
+        break;
+    }
+}
+
+void DossierManager::serialize(std::string& out) const {
+    out.clear();
+    out += "{\n";
+    for (int i = 0; i < SECTION_COUNT; i++) {
+        if (sectionStale[i]) {
+            sectionText[i].clear();  // Keeps its capacity
+            serializeSection((Section)i, sectionText[i]);
+            sectionStale[i] = false;
+        }
+        if (i > 0) out += ",\n";
+        out += sectionText[i];
+    }
+    out += "\n}\n";
 }
 
 std::string DossierManager::toJSON() const {
-    std::ostringstream json;
-    json << "{\n";
-
-    // Video devices
-    json << "  \"videoDevices\": [\n";
-    for (size_t i = 0; i < videoDevices.size(); i++) {
-        const auto& dev = videoDevices[i];
-        json << "    {\n";
-        json << "      \"index\": " << dev.index << ",\n";
-        json << "      \"id\": \"" << escapeJSON(dev.id) << "\",\n";
-        json << "      \"name\": \"" << escapeJSON(dev.name) << "\"\n";
-        json << "    }";
-        if (i < videoDevices.size() - 1) json << ",";
-        json << "\n";
-    }
-    json << "  ],\n";
-
-    // Monitors
-    json << "  \"monitors\": [\n";
-    for (size_t i = 0; i < monitors.size(); i++) {
-        const auto& mon = monitors[i];
-        json << "    {\n";
-        json << "      \"index\": " << mon.index << ",\n";
-        json << "      \"name\": \"" << escapeJSON(mon.name) << "\",\n";
-        json << "      \"width\": " << mon.width << ",\n";
-        json << "      \"height\": " << mon.height << ",\n";
-        json << "      \"refreshRate\": " << mon.refreshRate << ",\n";
-        json << "      \"isPrimary\": " << (mon.isPrimary ? "true" : "false") << "\n";
-        json << "    }";
-        if (i < monitors.size() - 1) json << ",";
-        json << "\n";
-    }
-    json << "  ],\n";
-
-    // Input variables
-    json << "  \"inputVariables\": {\n";
-    size_t idx = 0;
-    for (const auto& [name, info] : inputVariables) {
-        json << "    \"" << escapeJSON(name) << "\": {\n";
-        json << "      \"deviceIndex\": " << info.deviceIndex << ",\n";
-        json << "      \"deviceName\": \"" << escapeJSON(info.deviceName) << "\",\n";
-        json << "      \"width\": " << info.width << ",\n";
-        json << "      \"height\": " << info.height << "\n";
-        json << "    }";
-        if (idx < inputVariables.size() - 1) json << ",";
-        json << "\n";
-        idx++;
-    }
-    json << "  },\n";
-
-    // Output variables
-    json << "  \"outputVariables\": {\n";
-    idx = 0;
-    for (const auto& [name, info] : outputVariables) {
-        json << "    \"" << escapeJSON(name) << "\": {\n";
-        json << "      \"target\": \"" << escapeJSON(info.target) << "\",\n";
-        json << "      \"layerCount\": " << info.layerCount << ",\n";
-        json << "      \"layers\": [";
+    std::lock_guard<std::mutex> lock(mutex);
+    std::string json;
+    serialize(json);
+    return json;
+}
+
+void DossierManager::setAutoSave(const std::string& filename, int debounceMillis) {
+    std::lock_guard<std::mutex> lock(mutex);
+    saveFilename = filename;
+    debounce = std::chrono::milliseconds(std::max(0, debounceMillis));
+    autoSave = true;
+    if (!writer.joinable()) {
+        writer = std::thread(&DossierManager::writerLoop, this);
+    }
+
+    // The file may predate this run: write the current state once settled
+    if (!fileDirty) {
+        fileDirty = true;
+        firstChange = std::chrono::steady_clock::now();
+        saveDeadline = firstChange + debounce;
+        wake.notify_one();
+    }
+}
+
+void DossierManager::saveToFile(const std::string& filename) {
+    std::lock_guard<std::mutex> lock(mutex);
+    saveFilename = filename;
+    fileDirty = true;
+    firstChange = saveDeadline = std::chrono::steady_clock::now();
+    if (!writer.joinable()) {
+        writer = std::thread(&DossierManager::writerLoop, this);
+    }
+    wake.notify_one();
+}
+
+void DossierManager::saveSnapshot(const std::string& filename, SessionSnapshot snapshot) {
+    std::lock_guard<std::mutex> lock(mutex);
+    pendingSnapshot = std::make_unique<SessionSnapshot>(std::move(snapshot));
+    snapshotFilename = filename;
+    if (!writer.joinable()) {
+        writer = std::thread(&DossierManager::writerLoop, this);
+    }
+    wake.notify_one();
+}
+
+void DossierManager::flush() {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!writer.joinable()) return;
+    saveDeadline = std::chrono::steady_clock::now();
+    wake.notify_one();
+    written.wait(lock, [this] { return !fileDirty && !writing && !pendingSnapshot; });
+}
+
+bool DossierManager::startStream(const std::string& socketPath) {
+    auto newStream = std::make_unique<DossierStream>();
+    bool started = newStream->start(socketPath, [this](uint64_t& sequence) {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::string message = "{\"seq\":" + std::to_string(streamSequence) + ",\"type\":\"snapshot\",\"dossier\":";
+        std::string json;
+        serialize(json);
+        message += json;
+        message += "}";
+        sequence = streamSequence;
+        return message;
+    });
+    if (!started) return false;
+
+    // Swapped outside mutex: an old stream's thread may be waiting for it
+    std::unique_ptr<DossierStream> oldStream;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        oldStream = std::move(stream);
+        stream = std::move(newStream);
+    }
+    return true;
+}
+
+void DossierManager::beginMessage(const char* type) {
+    streamMessage.clear();
+    streamMessage += "{\"seq\":" + std::to_string(streamSequence + 1) + ",\"type\":\"";
+    streamMessage += type;
+    streamMessage += "\"";
+}
+
+void DossierManager::publishMessage() {
+    streamSequence++;
+    stream->publish(streamSequence, streamMessage);
+}
+
+void DossierManager::publishSection(Section section) {
+    beginMessage("section");
+    streamMessage += ",\"section\":{";
+    if (sectionStale[section]) {
+        sectionText[section].clear();
+        serializeSection(section, sectionText[section]);
+        sectionStale[section] = false;
+    }
+    streamMessage += sectionText[section];
+    streamMessage += "}}";
+    publishMessage();
+}
+
+void DossierManager::publishRemove(const char* section, const std::string& name) {
+    beginMessage("remove");
+    streamMessage += ",\"section\":\"";
+    streamMessage += section;
+    streamMessage += "\",\"name\":\"";
+    appendEscaped(streamMessage, name);
+    streamMessage += "\"}";
+    publishMessage();
+}
+
+namespace {
+
+// Start a field of a set message's "fields" object (which begins at fieldsStart)
+void appendField(std::string& out, size_t fieldsStart, const char* key) {
+    if (out.size() > fieldsStart) out += ',';
+    out += '"';
+    out += key;
+    out += "\":";
+}
+
+} // namespace
+
+void DossierManager::publishInputVariable(const InputVariableInfo& info, const InputVariableInfo* previous) {
+    beginMessage("set");
+    streamMessage += ",\"section\":\"inputVariables\",\"name\":\"";
+    appendEscaped(streamMessage, info.name);
+    streamMessage += "\",\"fields\":{";
+    size_t fieldsStart = streamMessage.size();
+
+    if (!previous || previous->deviceIndex != info.deviceIndex) {
+        appendField(streamMessage, fieldsStart, "deviceIndex");
+        streamMessage += std::to_string(info.deviceIndex);
+    }
+    if (!previous || previous->deviceName != info.deviceName) {
+        appendField(streamMessage, fieldsStart, "deviceName");
+        streamMessage += '"';
+        appendEscaped(streamMessage, info.deviceName);
+        streamMessage += '"';
+    }
+    if (!previous || previous->width != info.width) {
+        appendField(streamMessage, fieldsStart, "width");
+        streamMessage += std::to_string(info.width);
+    }
+    if (!previous || previous->height != info.height) {
+        appendField(streamMessage, fieldsStart, "height");
+        streamMessage += std::to_string(info.height);
+    }
+
+    if (streamMessage.size() == fieldsStart) return;  // Registered again unchanged
+    streamMessage += "}}";
+    publishMessage();
+}
+
+void DossierManager::publishOutputVariable(const OutputVariableInfo& info, const OutputVariableInfo* previous) {
+    beginMessage("set");
+    streamMessage += ",\"section\":\"outputVariables\",\"name\":\"";
+    appendEscaped(streamMessage, info.name);
+    streamMessage += "\",\"fields\":{";
+    size_t fieldsStart = streamMessage.size();
+
+    if (!previous || previous->target != info.target) {
+        appendField(streamMessage, fieldsStart, "target");
+        streamMessage += '"';
+        appendEscaped(streamMessage, info.target);
+        streamMessage += '"';
+    }
+    if (!previous || previous->layerCount != info.layerCount) {
+        appendField(streamMessage, fieldsStart, "layerCount");
+        streamMessage += std::to_string(info.layerCount);
+    }
+    if (!previous || previous->layerNames != info.layerNames) {
+        appendField(streamMessage, fieldsStart, "layers");
+        streamMessage += '[';
         for (size_t i = 0; i < info.layerNames.size(); i++) {
-            json << "\"" << escapeJSON(info.layerNames[i]) << "\"";
-            if (i < info.layerNames.size() - 1) json << ", ";
+            if (i > 0) streamMessage += ',';
+            streamMessage += '"';
+            appendEscaped(streamMessage, info.layerNames[i]);
+            streamMessage += '"';
         }
-        json << "]\n";
-        json << "    }";
-        if (idx < outputVariables.size() - 1) json << ",";
-        json << "\n";
-        idx++;
+        streamMessage += ']';
     }
-    json << "  },\n";
 
-    // Layers
-    json << "  \"layers\": {\n";
-    idx = 0;
-    for (const auto& [name, info] : layers) {
-        json << "    \"" << escapeJSON(name) << "\": {\n";
-        json << "      \"canvas\": [" << info.canvasWidth << ", " << info.canvasHeight << "],\n";
-        json << "      \"position\": [" << formatNumber(info.posX) << ", " << formatNumber(info.posY) << "],\n";
-        json << "      \"scale\": [" << formatNumber(info.scaleX) << ", " << formatNumber(info.scaleY) << "],\n";
-        json << "      \"rotation\": [" << formatNumber(info.rotXY) << ", " << formatNumber(info.rotY) << "],\n";
-        json << "      \"opacity\": " << formatNumber(info.opacity) << ",\n";
-        json << "      \"source\": \"" << escapeJSON(info.sourceName) << "\"\n";
-        json << "    }";
-        if (idx < layers.size() - 1) json << ",";
-        json << "\n";
-        idx++;
+    if (streamMessage.size() == fieldsStart) return;
+    streamMessage += "}}";
+    publishMessage();
+}
+
+void DossierManager::publishLayer(const LayerInfo& info, const LayerInfo* previous) {
+    beginMessage("set");
+    streamMessage += ",\"section\":\"layers\",\"name\":\"";
+    appendEscaped(streamMessage, info.name);
+    streamMessage += "\",\"fields\":{";
+    size_t fieldsStart = streamMessage.size();
+
+    auto appendPair = [this](float first, float second) {
+        streamMessage += '[';
+        appendNumber(streamMessage, first);
+        streamMessage += ',';
+        appendNumber(streamMessage, second);
+        streamMessage += ']';
+    };
+    if (!previous || previous->canvasWidth != info.canvasWidth || previous->canvasHeight != info.canvasHeight) {
+        appendField(streamMessage, fieldsStart, "canvas");
+        streamMessage += "[" + std::to_string(info.canvasWidth) + "," + std::to_string(info.canvasHeight) + "]";
+    }
+    if (!previous || previous->posX != info.posX || previous->posY != info.posY) {
+        appendField(streamMessage, fieldsStart, "position");
+        appendPair(info.posX, info.posY);
+    }
+    if (!previous || previous->scaleX != info.scaleX || previous->scaleY != info.scaleY) {
+        appendField(streamMessage, fieldsStart, "scale");
+        appendPair(info.scaleX, info.scaleY);
+    }
+    if (!previous || previous->rotXY != info.rotXY || previous->rotY != info.rotY) {
+        appendField(streamMessage, fieldsStart, "rotation");
+        appendPair(info.rotXY, info.rotY);
     }
-    json << "  }\n";
+    if (!previous || previous->opacity != info.opacity) {
+        appendField(streamMessage, fieldsStart, "opacity");
+        appendNumber(streamMessage, info.opacity);
+    }
+    if (!previous || previous->sourceName != info.sourceName) {
+        appendField(streamMessage, fieldsStart, "source");
+        streamMessage += '"';
+        appendEscaped(streamMessage, info.sourceName);
+        streamMessage += '"';
+    }
+
+    if (streamMessage.size() == fieldsStart) return;
+    streamMessage += "}}";
+    publishMessage();
+}
 
-    json << "}\n";
+void DossierManager::setPerformanceRate(float hz) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto now = std::chrono::steady_clock::now();
+    if (hz > 0.0f) {
+        performanceInterval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(1.0 / hz));
+        performanceDeadline = now + performanceInterval;
+        lastSampleTime = now;
+        lastSampleFrames = frameCount.load(std::memory_order_relaxed);
+        lastSampleSkipped = skippedVideoFrames.load(std::memory_order_relaxed);
+    } else {
+        performanceInterval = std::chrono::steady_clock::duration::zero();
+        performanceText.clear();
+        markChanged(SECTION_PERFORMANCE);
+        if (streaming()) publishSection(SECTION_PERFORMANCE);
+    }
+    wake.notify_one();
+}
 
-    return json.str();
+void DossierManager::recordFrame(float millis, float uiMillis) {
+    uint64_t frame = frameCount.load(std::memory_order_relaxed);
+    frameMillis[frame % FRAME_SAMPLES].store(millis, std::memory_order_relaxed);
+    uiRenderMillis.store(uiMillis, std::memory_order_relaxed);
+    frameCount.store(frame + 1, std::memory_order_release);
 }
 
-bool DossierManager::saveToFile(const std::string& filename) const {
-    std::string jsonContent = toJSON();
+void DossierManager::recordGpuMemory(int64_t bytesInUse) {
+    gpuMemoryBytes.store(bytesInUse, std::memory_order_relaxed);
+}
 
-    std::ofstream file(filename);
-    if (!file.is_open()) {
-        std::cerr << "ERROR: Failed to open " << filename << " for writing\n";
-        return false;
+void DossierManager::samplePerformance(std::chrono::steady_clock::time_point now) {
+    double seconds = std::chrono::duration<double>(now - lastSampleTime).count();
+    if (seconds <= 0.0) seconds = 1.0;
+    lastSampleTime = now;
+
+    // Main loop: rate since the last sample, percentiles over the last FRAME_SAMPLES frames
+    uint64_t frames = frameCount.load(std::memory_order_acquire);
+    double loopFps = (frames - lastSampleFrames) / seconds;
+    lastSampleFrames = frames;
+    uint64_t skipped = skippedVideoFrames.load(std::memory_order_relaxed);
+    double skippedFps = (skipped - lastSampleSkipped) / seconds;
+    lastSampleSkipped = skipped;
+    size_t samples = (size_t)std::min<uint64_t>(frames, FRAME_SAMPLES);
+    frameScratch.resize(samples);
+    for (size_t i = 0; i < samples; i++) {
+        frameScratch[i] = frameMillis[i].load(std::memory_order_relaxed);
+    }
+    auto percentile = [&](double p) {
+        if (frameScratch.empty()) return 0.0f;
+        size_t rank = std::min(frameScratch.size() - 1, (size_t)(p * frameScratch.size()));
+        std::nth_element(frameScratch.begin(), frameScratch.begin() + rank, frameScratch.end());
+        return frameScratch[rank];
+    };
+
+    std::string& out = performanceText;
+    out.clear();
+    out += "  \"performance\": {\n";
+    out += "    \"refreshHz\": ";
+    appendNumber(out, (float)(1.0 / std::chrono::duration<double>(performanceInterval).count()));
+    out += ",\n    \"mainLoop\": {\"fps\": ";
+    appendNumber(out, (float)loopFps);
+    out += ", \"frameMsP50\": ";
+    appendNumber(out, percentile(0.50));
+    out += ", \"frameMsP95\": ";
+    appendNumber(out, percentile(0.95));
+    out += ", \"frameMsP99\": ";
+    appendNumber(out, percentile(0.99));
+    out += ", \"frameMsMax\": ";
+    appendNumber(out, percentile(1.0));
+    out += ", \"frames\": " + std::to_string(samples);
+    out += ", \"videoSkippedFps\": ";
+    appendNumber(out, (float)skippedFps);
+    out += std::string(", \"idle\": ") + (loopIdle.load(std::memory_order_relaxed) ? "true" : "false");
+    out += "},\n";
+    out += "    \"uiRenderMs\": ";
+    appendNumber(out, uiRenderMillis.load(std::memory_order_relaxed));
+    out += ",\n    \"gpuMemoryMB\": ";
+    int64_t gpuBytes = gpuMemoryBytes.load(std::memory_order_relaxed);
+    if (gpuBytes >= 0) {
+        appendNumber(out, (float)(gpuBytes / 1e6));
+    } else {
+        out += "null";  // No driver query (e.g. macOS)
     }
 
-    file << jsonContent;
-    file.close();
+    // Sources: frames delivered by the device, and replaced before anything read them
+    out += ",\n    \"sources\": {";
+    size_t idx = 0;
+    for (const auto& [name, source] : inputSources) {
+        CounterSample current;
+        if (source) {
+            current.delivered = source->getDeliveredFrames();
+            current.dropped = source->getDroppedFrames();
+        }
+        auto last = lastSourceCounts.emplace(name, current).first;
+        out += idx++ == 0 ? "\n" : ",\n";
+        out += "      \"";
+        appendEscaped(out, name);
+        out += "\": {\"deliveredFps\": ";
+        appendNumber(out, (float)((current.delivered - last->second.delivered) / seconds));
+        out += ", \"droppedFps\": ";
+        appendNumber(out, (float)((current.dropped - last->second.dropped) / seconds));
+        out += "}";
+        last->second = current;
+    }
+    out += idx > 0 ? "\n    },\n" : "},\n";
 
-    std::cout << "Saved dossier to " << filename << "\n";
-    return true;
+    out += "    \"layers\": {";
+    idx = 0;
+    for (const auto& [name, layer] : layerObjects) {
+        CounterSample current;
+        if (layer) {
+            current.uploaded = layer->getUploadedBytes();
+        }
+        auto last = lastLayerCounts.emplace(name, current).first;
+        out += idx++ == 0 ? "\n" : ",\n";
+        out += "      \"";
+        appendEscaped(out, name);
+        out += "\": {\"uploadMBps\": ";
+        appendNumber(out, (float)((current.uploaded - last->second.uploaded) / seconds / 1e6));
+        out += "}";
+        last->second = current;
+    }
+    out += idx > 0 ? "\n    },\n" : "},\n";
+
+    out += "    \"outputs\": {";
+    idx = 0;
+    for (const auto& [name, output] : outputObjects) {
+        out += idx++ == 0 ? "\n" : ",\n";
+        out += "      \"";
+        appendEscaped(out, name);
+        out += "\": {\"compositeMs\": ";
+        appendNumber(out, output ? output->getCompositeMillis() : 0.0f);
+        out += "}";
+    }
+    out += idx > 0 ? "\n    }\n" : "}\n";
+    out += "  }";
+
+    // Forget objects that are gone
+    for (auto it = lastSourceCounts.begin(); it != lastSourceCounts.end();) {
+        it = inputSources.count(it->first) ? std::next(it) : lastSourceCounts.erase(it);
+    }
+    for (auto it = lastLayerCounts.begin(); it != lastLayerCounts.end();) {
+        it = layerObjects.count(it->first) ? std::next(it) : lastLayerCounts.erase(it);
+    }
+}
+
+void DossierManager::writerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        auto now = std::chrono::steady_clock::now();
+        bool sampling = performanceInterval.count() > 0;
+        if (sampling && now >= performanceDeadline && !stopping) {
+            samplePerformance(now);
+            sectionStale[SECTION_PERFORMANCE] = true;
+            if (streaming()) publishSection(SECTION_PERFORMANCE);
+            performanceDeadline += performanceInterval;
+            if (performanceDeadline <= now) performanceDeadline = now + performanceInterval;
+
+            // Live numbers go out now, along with anything still debouncing
+            fileDirty = true;
+            saveDeadline = now;
+        }
+
+        if (pendingSnapshot) {
+            std::unique_ptr<SessionSnapshot> snapshot = std::move(pendingSnapshot);
+            std::string filename = snapshotFilename;
+            writing = true;
+            lock.unlock();
+
+            std::string error;
+            encodeSessionSnapshot(*snapshot, snapshotBuffer);
+            if (!writeSessionSnapshot(filename, snapshotBuffer, error)) {
+                std::cerr << "ERROR: " << error << "\n";
+            }
+
+            lock.lock();
+            writing = false;
+            written.notify_all();
+            continue;
+        }
+
+        if (!fileDirty) {
+            if (stopping) return;
+            if (sampling) {
+                wake.wait_until(lock, performanceDeadline);
+            } else {
+                wake.wait(lock);
+            }
+            continue;
+        }
+        if (!stopping && now < saveDeadline) {
+            wake.wait_until(lock, sampling ? std::min(saveDeadline, performanceDeadline) : saveDeadline);
+            continue;
+        }
+
+        serialize(document);
+        std::string filename = saveFilename;
+        fileDirty = false;
+        writing = true;
+        lock.unlock();
+
+        // Write beside the file and rename over it: readers never see half a dossier
+        std::string tempFilename = filename + ".tmp";
+        std::ofstream file(tempFilename, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            std::cerr << "ERROR: Failed to open " << tempFilename << " for writing\n";
+        } else {
+            file.write(document.data(), (std::streamsize)document.size());
+            file.close();
+            if (!file) {
+                std::cerr << "ERROR: Failed to write " << tempFilename << "\n";
+            } else if (std::rename(tempFilename.c_str(), filename.c_str()) != 0) {
+                std::cerr << "ERROR: Failed to replace " << filename << "\n";
+            }
+        }
+
+        lock.lock();
+        writing = false;
+        written.notify_all();
+    }
 }
@@ -0,0 +1,245 @@
+#include "dossier_stream.h"
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+#ifdef MSG_NOSIGNAL
+const int sendFlags = MSG_NOSIGNAL;
+#else
+const int sendFlags = 0;  // macOS: SO_NOSIGPIPE is set on each client instead
+#endif
+
+bool setNonBlocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0 &&
+           fcntl(fd, F_SETFD, FD_CLOEXEC) == 0;
+}
+
+} // namespace
+
+DossierStream::DossierStream()
+    : listenFd(-1), wakeFds{-1, -1}, stopping(false), clientCount(0), droppedClients(0) {
+}
+
+DossierStream::~DossierStream() {
+    stop();
+}
+
+bool DossierStream::start(const std::string& path, SnapshotProvider provider) {
+    stop();
+
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+        std::cerr << "ERROR: Dossier stream socket path is empty or too long: " << path << "\n";
+        return false;
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || !setNonBlocking(fd)) {
+        std::cerr << "ERROR: Failed to create dossier stream socket: " << std::strerror(errno) << "\n";
+        if (fd >= 0) close(fd);
+        return false;
+    }
+    unlink(path.c_str());  // Left behind by a run that didn't exit cleanly
+    if (bind(fd, (sockaddr*)&address, sizeof(address)) != 0 || listen(fd, 8) != 0) {
+        std::cerr << "ERROR: Failed to listen on " << path << ": " << std::strerror(errno) << "\n";
+        close(fd);
+        return false;
+    }
+    if (pipe(wakeFds) != 0 || !setNonBlocking(wakeFds[0]) || !setNonBlocking(wakeFds[1])) {
+        std::cerr << "ERROR: Failed to create dossier stream wake pipe\n";
+        close(fd);
+        unlink(path.c_str());
+        for (int& wakeFd : wakeFds) {
+            if (wakeFd >= 0) close(wakeFd);
+            wakeFd = -1;
+        }
+        return false;
+    }
+
+    listenFd = fd;
+    socketPath = path;
+    snapshotProvider = std::move(provider);
+    stopping = false;
+    thread = std::thread(&DossierStream::run, this);
+
+    std::cout << "Streaming dossier changes on " << socketPath << "\n";
+    return true;
+}
+
+void DossierStream::stop() {
+    if (listenFd < 0) return;
+
+    stopping = true;
+    char byte = 0;
+    (void)!write(wakeFds[1], &byte, 1);
+    thread.join();
+
+    while (!clients.empty()) {
+        closeClient(clients.size() - 1);
+    }
+    close(listenFd);
+    close(wakeFds[0]);
+    close(wakeFds[1]);
+    listenFd = wakeFds[0] = wakeFds[1] = -1;
+    unlink(socketPath.c_str());
+
+    std::lock_guard<std::mutex> lock(mutex);
+    queue.clear();
+}
+
+void DossierStream::appendFrame(std::string& out, const std::string& message) {
+    uint32_t length = (uint32_t)message.size();
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        out += (char)((length >> shift) & 0xff);
+    }
+    out += message;
+}
+
+void DossierStream::publish(uint64_t sequence, const std::string& message) {
+    if (listenFd < 0) return;
+
+    std::string frame;
+    frame.reserve(4 + message.size());
+    appendFrame(frame, message);
+
+    bool wasEmpty;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        wasEmpty = queue.empty();
+        queue.emplace_back(sequence, std::move(frame));
+    }
+    if (wasEmpty) {
+        // Pipe full means a wake-up is pending already
+        char byte = 0;
+        (void)!write(wakeFds[1], &byte, 1);
+    }
+}
+
+void DossierStream::acceptClients() {
+    for (;;) {
+        int fd = accept(listenFd, nullptr, nullptr);
+        if (fd < 0) return;  // EAGAIN: no more pending connections
+        if (!setNonBlocking(fd)) {
+            close(fd);
+            continue;
+        }
+#ifdef SO_NOSIGPIPE
+        int on = 1;
+        setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+
+        // Counted first: changes published from here on are queued, and the
+        // snapshot tells which of them it already contains
+        clientCount.fetch_add(1, std::memory_order_relaxed);
+        Client client;
+        client.fd = fd;
+        client.after = 0;
+        client.sent = 0;
+        appendFrame(client.pending, snapshotProvider(client.after));
+        clients.push_back(std::move(client));
+        std::cout << "Dossier stream client connected (" << clients.size() << " connected)\n";
+    }
+}
+
+bool DossierStream::writePending(Client& client) {
+    while (client.sent < client.pending.size()) {
+        ssize_t written = send(client.fd, client.pending.data() + client.sent,
+                               client.pending.size() - client.sent, sendFlags);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        client.sent += (size_t)written;
+    }
+    client.pending.clear();  // Keeps its capacity
+    client.sent = 0;
+    return true;
+}
+
+void DossierStream::closeClient(size_t index) {
+    close(clients[index].fd);
+    clients.erase(clients.begin() + index);
+    clientCount.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void DossierStream::run() {
+    std::vector<pollfd> fds;
+    std::vector<std::pair<uint64_t, std::string>> changes;
+    char scratch[256];
+
+    while (!stopping) {
+        fds.clear();
+        fds.push_back({listenFd, POLLIN, 0});
+        fds.push_back({wakeFds[0], POLLIN, 0});
+        for (const auto& client : clients) {
+            fds.push_back({client.fd, (short)(POLLIN | (client.pending.empty() ? 0 : POLLOUT)), 0});
+        }
+        if (poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "ERROR: Dossier stream poll failed: " << std::strerror(errno) << "\n";
+            return;
+        }
+        if (stopping) return;
+
+        // Clients only listen: anything they send is discarded, a hangup closes them
+        for (size_t i = clients.size(); i-- > 0;) {
+            const pollfd& entry = fds[2 + i];
+            bool gone = (entry.revents & (POLLERR | POLLNVAL)) != 0;
+            if (!gone && (entry.revents & (POLLIN | POLLHUP))) {
+                ssize_t received = recv(clients[i].fd, scratch, sizeof(scratch), 0);
+                gone = received == 0 || (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK);
+            }
+            if (gone) {
+                closeClient(i);
+                std::cout << "Dossier stream client disconnected (" << clients.size() << " connected)\n";
+            }
+        }
+
+        if (fds[1].revents & POLLIN) {
+            while (read(wakeFds[0], scratch, sizeof(scratch)) > 0) {}
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            changes.swap(queue);
+        }
+        for (const auto& change : changes) {
+            for (auto& client : clients) {
+                if (change.first > client.after) client.pending += change.second;
+            }
+        }
+        changes.clear();
+
+        if (fds[0].revents & POLLIN) {
+            acceptClients();
+        }
+
+        // Back-pressure: a client that can't keep up is dropped, not waited for
+        for (size_t i = clients.size(); i-- > 0;) {
+            Client& client = clients[i];
+            bool alive = writePending(client);
+            if (alive && client.pending.size() - client.sent > MAX_CLIENT_BACKLOG) {
+                droppedClients.fetch_add(1, std::memory_order_relaxed);
+                std::cerr << "ERROR: Dropped dossier stream client (more than "
+                          << (MAX_CLIENT_BACKLOG >> 10) << " KB behind)\n";
+                alive = false;
+            }
+            if (!alive) {
+                closeClient(i);
+            } else if (client.sent > 0 && client.sent >= client.pending.size() / 2) {
+                client.pending.erase(0, client.sent);
+                client.sent = 0;
+            }
+        }
+    }
+}
@@ -0,0 +1,98 @@
+#include "frame_generator.h"
+#include <iostream>
+
+FrameGenerator::FrameGenerator() : width(0), height(0) {
+}
+
+bool FrameGenerator::openSynthetic(int w, int h) {
+    if (w <= 0 || h <= 0) {
+        std::cerr << "ERROR: Invalid synthetic frame size " << w << "x" << h << "\n";
+        return false;
+    }
+    width = w;
+    height = h;
+    return true;
+}
+
+bool FrameGenerator::openFile(const std::string& filePath) {
+    file.open(filePath, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "ERROR: Could not open frame file: " << filePath << "\n";
+        return false;
+    }
+    path = filePath;
+
+    // Size comes from the first frame; later frames must match
+    if (!readPPMHeader(width, height)) {
+        std::cerr << "ERROR: " << filePath << " is not a binary PPM (P6) stream\n";
+        file.close();
+        return false;
+    }
+    file.seekg(0);
+    return true;
+}
+
+bool FrameGenerator::readPPMHeader(int& w, int& h) {
+    std::string magic;
+    int maxValue = 0;
+    if (!(file >> magic) || magic != "P6") return false;
+
+    // Skip comments between header fields
+    auto readField = [this](int& value) {
+        file >> std::ws;
+        while (file.peek() == '#') {
+            std::string comment;
+            std::getline(file, comment);
+            file >> std::ws;
+        }
+        return (bool)(file >> value);
+    };
+    if (!readField(w) || !readField(h) || !readField(maxValue)) return false;
+    file.get();  // Single whitespace before pixel data
+
+    return w > 0 && h > 0 && maxValue == 255;
+}
+
+void FrameGenerator::fillSynthetic(VideoFrame& frame, int frameIndex) {
+    // Eight vertical color bars scrolling right, with a vertical brightness ramp
+    static const uint8_t bars[8][3] = {
+        {255, 255, 255}, {255, 255, 0}, {0, 255, 255}, {0, 255, 0},
+        {255, 0, 255}, {255, 0, 0}, {0, 0, 255}, {0, 0, 0}
+    };
+    int shift = (frameIndex * 8) % width;
+
+    for (int y = 0; y < height; y++) {
+        int ramp = 128 + (127 * y) / height;
+        uint8_t* row = frame.data.get() + (size_t)y * width * 3;
+        for (int x = 0; x < width; x++) {
+            const uint8_t* bar = bars[((x + shift) % width) * 8 / width];
+            row[x * 3 + 0] = (uint8_t)(bar[0] * ramp / 255);
+            row[x * 3 + 1] = (uint8_t)(bar[1] * ramp / 255);
+            row[x * 3 + 2] = (uint8_t)(bar[2] * ramp / 255);
+        }
+    }
+}
+
+std::shared_ptr<VideoFrame> FrameGenerator::next(int frameIndex, double timestamp) {
+    auto frame = std::make_shared<VideoFrame>(width, height);
+    frame->timestamp = timestamp;
+
+    if (!file.is_open()) {
+        fillSynthetic(*frame, frameIndex);
+        return frame;
+    }
+
+    // Loop back to the first frame at end of file
+    int w = 0, h = 0;
+    if (!readPPMHeader(w, h)) {
+        file.clear();
+        file.seekg(0);
+        if (!readPPMHeader(w, h)) return nullptr;
+    }
+    if (w != width || h != height) {
+        std::cerr << "ERROR: Frame size changed mid-stream in " << path << "\n";
+        return nullptr;
+    }
+    file.read((char*)frame->data.get(), frame->dataSize);
+    return file ? frame : nullptr;
+}
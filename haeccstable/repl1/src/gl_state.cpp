@@ -0,0 +1,97 @@
+#include "gl_state.h"
+
+#ifndef GL_UNIFORM_BUFFER
+#define GL_UNIFORM_BUFFER 0x8A11
+#endif
+
+static const GLuint unknownBinding = ~0u;
+
+GLState& GLState::get() {
+    static GLState state;
+    return state;
+}
+
+GLState::GLState()
+    : callsThisFrame(0), skippedThisFrame(0), callsLastFrame(0), skippedLastFrame(0) {
+    invalidate();
+}
+
+void GLState::invalidate() {
+    program = unknownBinding;
+    vertexArray = unknownBinding;
+    arrayBuffer = unknownBinding;
+    uniformBuffer = unknownBinding;
+    texture = unknownBinding;
+    blend = -1;
+}
+
+void GLState::useProgram(GLuint newProgram) {
+    if (program == newProgram) {
+        skippedThisFrame++;
+        return;
+    }
+    glUseProgram(newProgram);
+    program = newProgram;
+    callsThisFrame++;
+}
+
+void GLState::bindVertexArray(GLuint vao) {
+    if (vertexArray == vao) {
+        skippedThisFrame++;
+        return;
+    }
+    glBindVertexArray(vao);
+    vertexArray = vao;
+    callsThisFrame++;
+}
+
+void GLState::bindBuffer(GLenum target, GLuint buffer) {
+    GLuint* shadow = (target == GL_UNIFORM_BUFFER) ? &uniformBuffer : &arrayBuffer;
+    if (*shadow == buffer) {
+        skippedThisFrame++;
+        return;
+    }
+    glBindBuffer(target, buffer);
+    *shadow = buffer;
+    callsThisFrame++;
+}
+
+void GLState::bindBufferBase(GLenum target, GLuint index, GLuint buffer) {
+    // Indexed binds also replace the generic binding point
+    glBindBufferBase(target, index, buffer);
+    if (target == GL_UNIFORM_BUFFER) {
+        uniformBuffer = buffer;
+    }
+    callsThisFrame++;
+}
+
+void GLState::bindTexture(GLuint newTexture) {
+    if (texture == newTexture) {
+        skippedThisFrame++;
+        return;
+    }
+    glBindTexture(GL_TEXTURE_2D, newTexture);
+    texture = newTexture;
+    callsThisFrame++;
+}
+
+void GLState::setBlend(bool enabled) {
+    if (blend == (enabled ? 1 : 0)) {
+        skippedThisFrame++;
+        return;
+    }
+    if (enabled) {
+        glEnable(GL_BLEND);
+    } else {
+        glDisable(GL_BLEND);
+    }
+    blend = enabled ? 1 : 0;
+    callsThisFrame++;
+}
+
+void GLState::endFrame() {
+    callsLastFrame = callsThisFrame;
+    skippedLastFrame = skippedThisFrame;
+    callsThisFrame = 0;
+    skippedThisFrame = 0;
+}
@@ -0,0 +1,144 @@
+#include "headless_context.h"
+#include <iostream>
+
+#if defined(__APPLE__)
+#include <OpenGL/OpenGL.h>
+#include <dlfcn.h>
+#elif defined(REPL1_HAVE_EGL)
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+HeadlessContext::HeadlessContext() : display(nullptr), context(nullptr) {
+}
+
+#if defined(__APPLE__)
+
+HeadlessContext::~HeadlessContext() {
+    if (context) {
+        CGLSetCurrentContext(nullptr);
+        CGLDestroyContext((CGLContextObj)context);
+    }
+}
+
+bool HeadlessContext::init() {
+    // 3.2 core profile yields the newest core context (4.1), which accepts #version 330
+    CGLPixelFormatAttribute attributes[] = {
+        kCGLPFAOpenGLProfile, (CGLPixelFormatAttribute)kCGLOGLPVersion_3_2_Core,
+        kCGLPFAAllowOfflineRenderers,
+        (CGLPixelFormatAttribute)0
+    };
+
+    CGLPixelFormatObj pixelFormat = nullptr;
+    GLint formatCount = 0;
+    if (CGLChoosePixelFormat(attributes, &pixelFormat, &formatCount) != kCGLNoError || !pixelFormat) {
+        std::cerr << "ERROR: No CGL pixel format for a 3.2 core context\n";
+        return false;
+    }
+
+    CGLContextObj cglContext = nullptr;
+    CGLError error = CGLCreateContext(pixelFormat, nullptr, &cglContext);
+    CGLDestroyPixelFormat(pixelFormat);
+    if (error != kCGLNoError || !cglContext) {
+        std::cerr << "ERROR: Failed to create CGL context\n";
+        return false;
+    }
+
+    context = cglContext;
+    CGLSetCurrentContext(cglContext);
+    std::cout << "Created headless CGL context\n";
+    return true;
+}
+
+void* HeadlessContext::getProcAddress(const char* name) {
+    return dlsym(RTLD_DEFAULT, name);
+}
+
+#elif defined(REPL1_HAVE_EGL)
+
+HeadlessContext::~HeadlessContext() {
+    if (display) {
+        eglMakeCurrent((EGLDisplay)display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        if (context) eglDestroyContext((EGLDisplay)display, (EGLContext)context);
+        eglTerminate((EGLDisplay)display);
+    }
+}
+
+bool HeadlessContext::init() {
+    // Surfaceless platform: no X11/Wayland connection needed
+    auto getPlatformDisplay =
+        (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    EGLDisplay eglDisplay = EGL_NO_DISPLAY;
+    if (getPlatformDisplay) {
+        eglDisplay = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    }
+    if (eglDisplay == EGL_NO_DISPLAY) {
+        eglDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+
+    EGLint major = 0, minor = 0;
+    if (eglDisplay == EGL_NO_DISPLAY || !eglInitialize(eglDisplay, &major, &minor)) {
+        std::cerr << "ERROR: Failed to initialize EGL display\n";
+        return false;
+    }
+    display = eglDisplay;
+
+    if (!eglBindAPI(EGL_OPENGL_API)) {
+        std::cerr << "ERROR: EGL has no desktop OpenGL support\n";
+        return false;
+    }
+
+    // No surfaces are ever created, so any surface type will do
+    const EGLint configAttributes[] = {
+        EGL_SURFACE_TYPE, EGL_DONT_CARE,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_NONE
+    };
+    EGLConfig config;
+    EGLint configCount = 0;
+    if (!eglChooseConfig(eglDisplay, configAttributes, &config, 1, &configCount) || configCount == 0) {
+        std::cerr << "ERROR: No EGL config for desktop OpenGL\n";
+        return false;
+    }
+
+    const EGLint contextAttributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    EGLContext eglContext = eglCreateContext(eglDisplay, config, EGL_NO_CONTEXT, contextAttributes);
+    if (eglContext == EGL_NO_CONTEXT) {
+        std::cerr << "ERROR: Failed to create OpenGL 3.3 core EGL context\n";
+        return false;
+    }
+    context = eglContext;
+
+    if (!eglMakeCurrent(eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, eglContext)) {
+        std::cerr << "ERROR: Failed to make EGL context current (surfaceless)\n";
+        return false;
+    }
+
+    std::cout << "Created headless EGL " << major << "." << minor << " context\n";
+    return true;
+}
+
+void* HeadlessContext::getProcAddress(const char* name) {
+    return (void*)eglGetProcAddress(name);
+}
+
+#else
+
+HeadlessContext::~HeadlessContext() {
+}
+
+bool HeadlessContext::init() {
+    std::cerr << "ERROR: Headless mode needs EGL (not found at build time)\n";
+    return false;
+}
+
+void* HeadlessContext::getProcAddress(const char* name) {
+    return nullptr;
+}
+
+#endif
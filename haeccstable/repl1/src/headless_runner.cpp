@@ -0,0 +1,484 @@
+#include "headless_runner.h"
+#include "headless_context.h"
+#include "frame_generator.h"
+#include "image_kernels.h"
+#include "repl_interpreter.h"
+#include "output_variable.h"
+#include "preset_library.h"
+#include "thread_pool.h"
+#include "video_source.h"
+#include <glad/glad.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <vector>
+
+static void printUsage() {
+    std::cout << "Usage: repl1 --headless (--script FILE | --preset NAME) [options]\n"
+              << "       repl1 --headless --bench-kernels [--frames N] [--source SRC] [--size WxH] [--threads N]\n"
+              << "       repl1 --headless --bench-bindings N [options]\n"
+              << "  --frames N          pipeline frames to run (default 300)\n"
+              << "  --source SRC        synthetic | FILE.ppm (P6 stream), feeds every in_var\n"
+              << "  --size WxH          synthetic frame size (default 1920x1080)\n"
+              << "  --fps F             frame timestamp rate (default 30)\n"
+              << "  --dump DIR          write outputs as DIR/<out_var>_<frame>.ppm\n"
+              << "  --dump-every N      dump every Nth frame only (default 1)\n"
+              << "  --bench-kernels     benchmark the CPU image kernels (no script, no GL)\n"
+              << "  --threads N         CPU kernel threads (default: all cores)\n"
+              << "  --bench-bindings N  run a generated scene with N animated bindings (10 per layer)\n"
+              << "  --gpu-only          run $ascii steps on the GPU (default: CPU kernels)\n";
+}
+
+bool parseHeadlessOptions(int argc, char** argv, HeadlessOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        try {
+            if (arg == "--headless") {
+                continue;
+            } else if (arg == "--script" && hasValue) {
+                options.scriptPath = argv[++i];
+            } else if (arg == "--preset" && hasValue) {
+                options.presetName = argv[++i];
+            } else if (arg == "--frames" && hasValue) {
+                options.frames = std::stoi(argv[++i]);
+            } else if (arg == "--source" && hasValue) {
+                options.source = argv[++i];
+            } else if (arg == "--size" && hasValue) {
+                std::string size = argv[++i];
+                size_t x = size.find('x');
+                if (x == std::string::npos) throw std::invalid_argument(size);
+                options.sourceWidth = std::stoi(size.substr(0, x));
+                options.sourceHeight = std::stoi(size.substr(x + 1));
+            } else if (arg == "--fps" && hasValue) {
+                options.fps = std::stod(argv[++i]);
+            } else if (arg == "--dump" && hasValue) {
+                options.dumpDir = argv[++i];
+            } else if (arg == "--dump-every" && hasValue) {
+                options.dumpEvery = std::max(1, std::stoi(argv[++i]));
+            } else if (arg == "--bench-kernels") {
+                options.benchKernels = true;
+            } else if (arg == "--bench-bindings" && hasValue) {
+                options.benchBindings = std::max(1, std::stoi(argv[++i]));
+            } else if (arg == "--threads" && hasValue) {
+                options.threads = std::max(0, std::stoi(argv[++i]));
+            } else if (arg == "--gpu-only") {
+                options.gpuOnly = true;
+            } else {
+                std::cerr << "ERROR: Unknown or incomplete option: " << arg << "\n";
+                printUsage();
+                return false;
+            }
+        } catch (const std::exception&) {
+            std::cerr << "ERROR: Invalid value for " << arg << "\n";
+            printUsage();
+            return false;
+        }
+    }
+
+    if (options.benchKernels) {
+        if (options.frames <= 0) options.frames = 1;
+        return true;
+    }
+    int scripts = !options.scriptPath.empty() + !options.presetName.empty() + (options.benchBindings > 0);
+    if (scripts != 1) {
+        std::cerr << "ERROR: Give exactly one of --script, --preset or --bench-bindings\n";
+        printUsage();
+        return false;
+    }
+    if (options.frames < 0 || options.fps <= 0.0) {
+        std::cerr << "ERROR: --frames must be >= 0 and --fps > 0\n";
+        return false;
+    }
+    return true;
+}
+
+// Read a REPL file, expanding #import lines from ../presets (same as the editor)
+static bool loadScript(const std::string& path, std::string& code) {
+    std::ifstream inFile(path, std::ios::binary);
+    if (!inFile.is_open()) {
+        std::cerr << "ERROR: Could not open script: " << path << "\n";
+        return false;
+    }
+    std::string text((std::istreambuf_iterator<char>(inFile)), std::istreambuf_iterator<char>());
+
+    PresetLibrary presets("../presets");
+    std::vector<std::string> errors;
+    presets.expandImports(text, code, errors);
+    for (const auto& error : errors) {
+        std::cerr << "ERROR: " << error << "\n";
+    }
+    return errors.empty();
+}
+
+// Scene for --bench-bindings: layers of one camera on monitor1, each with ten
+// t-dependent calls mixing rot/opacity/transform/scale and sin/cos/abs/max
+static std::string bindingBenchScript(int bindings) {
+    static const char* calls[] = {
+        "rot(t*30 + %d, 0)",
+        "opacity(50+50*sin(t*%d))",
+        "transform(100*cos(t), 20*sin(t*2+%d))",
+        "scale(1 + 0.1*sin(t), max(0.5, abs(cos(t+%d))))",
+    };
+    std::string code = "in_var cam = 0;\nout_var scr = monitor1;\n";
+    char call[96];
+    for (int layer = 0; layer * 10 < bindings; layer++) {
+        std::string name = "L" + std::to_string(layer);
+        code += "layer_obj " + name + ";\ncam.cast(" + name + ");\n";
+        for (int i = 0; i < 10 && layer * 10 + i < bindings; i++) {
+            std::snprintf(call, sizeof(call), calls[i % 4], layer + i);
+            code += name + "." + call + ";\n";
+        }
+        code += "scr.project(" + name + ", " + std::to_string(layer) + ");\n";
+    }
+    return code;
+}
+
+// Read back an output's framebuffer as a binary PPM (top row first)
+static bool dumpOutput(const OutputVariable& output, const std::string& path) {
+    int width = output.getOutputWidth();
+    int height = output.getOutputHeight();
+    if (output.getOutputFramebuffer() == 0 || width <= 0 || height <= 0) return false;
+
+    std::vector<uint8_t> rgba((size_t)width * height * 4);
+    glBindFramebuffer(GL_FRAMEBUFFER, output.getOutputFramebuffer());
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, rgba.data());
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    std::ofstream outFile(path, std::ios::binary);
+    if (!outFile.is_open()) {
+        std::cerr << "ERROR: Could not write " << path << "\n";
+        return false;
+    }
+    outFile << "P6\n" << width << " " << height << "\n255\n";
+
+    std::vector<uint8_t> row((size_t)width * 3);
+    for (int y = height - 1; y >= 0; y--) {
+        const uint8_t* src = &rgba[(size_t)y * width * 4];
+        for (int x = 0; x < width; x++) {
+            row[x * 3 + 0] = src[x * 4 + 0];
+            row[x * 3 + 1] = src[x * 4 + 1];
+            row[x * 3 + 2] = src[x * 4 + 2];
+        }
+        outFile.write((const char*)row.data(), row.size());
+    }
+    return true;
+}
+
+int runHeadless(const HeadlessOptions& options) {
+    using Clock = std::chrono::steady_clock;
+
+    if (options.benchKernels) {
+        return runKernelBenchmark(options);
+    }
+
+    HeadlessContext context;
+    if (!context.init()) {
+        return -1;
+    }
+    if (!gladLoadGLLoader((GLADloadproc)HeadlessContext::getProcAddress)) {
+        std::cerr << "Failed to initialize GLAD\n";
+        return -1;
+    }
+
+    // Every in_var gets its own generated source, whatever device index it names
+    struct FedSource {
+        std::shared_ptr<VideoSource> source;
+        std::unique_ptr<FrameGenerator> generator;
+    };
+    std::vector<FedSource> fedSources;
+
+    auto replInterpreter = std::make_unique<ReplInterpreter>();
+    if (!options.gpuOnly) {
+        replInterpreter->setCpuKernels(std::make_shared<ImageKernels>(ImageKernels::Backend::SIMD, options.threads));
+    }
+    replInterpreter->setVideoSourceFactory([&](int deviceIndex) -> std::shared_ptr<VideoSource> {
+        auto generator = std::make_unique<FrameGenerator>();
+        bool opened = options.source == "synthetic"
+            ? generator->openSynthetic(options.sourceWidth, options.sourceHeight)
+            : generator->openFile(options.source);
+        if (!opened) return nullptr;
+
+        auto source = std::make_shared<VideoSource>();
+        source->openExternal(generator->getWidth(), generator->getHeight());
+        std::cout << "Headless source for device " << deviceIndex << ": " << options.source
+                  << " (" << generator->getWidth() << "x" << generator->getHeight() << ")\n";
+        fedSources.push_back({source, std::move(generator)});
+        return source;
+    });
+
+    std::string scriptPath = options.scriptPath.empty()
+        ? "../presets/" + options.presetName : options.scriptPath;
+    std::string code;
+    if (options.benchBindings > 0) {
+        scriptPath = "--bench-bindings " + std::to_string(options.benchBindings);
+        code = bindingBenchScript(options.benchBindings);
+    } else if (!loadScript(scriptPath, code)) {
+        return -1;
+    }
+
+    auto scriptStart = Clock::now();
+    auto outputs = replInterpreter->execute(code);
+    double scriptMs = std::chrono::duration<double, std::milli>(Clock::now() - scriptStart).count();
+    for (const auto& line : outputs) {
+        std::cout << line << "\n";
+    }
+
+    if (!options.dumpDir.empty()) {
+        std::error_code error;
+        std::filesystem::create_directories(options.dumpDir, error);
+        if (error) {
+            std::cerr << "ERROR: Could not create " << options.dumpDir << ": " << error.message() << "\n";
+            return -1;
+        }
+    }
+
+    std::vector<double> frameMs;
+    frameMs.reserve(options.frames);
+    double bindingMicros = 0.0;
+    double captureWaitMs = 0.0;
+    int dumped = 0;
+    auto runStart = Clock::now();
+
+    // Capture stage: frame N+1 is generated (or read) on the shared pool, one job
+    // per fed source, while frame N renders. Runs are frame-exact, so the loop
+    // waits for the readahead instead of dropping frames as live capture does.
+    std::vector<std::shared_ptr<VideoFrame>> images(fedSources.size());
+    std::vector<std::shared_ptr<VideoFrame>> aheadImages(fedSources.size());
+    TaskGroup readahead;
+    auto readAhead = [&](int frame) {
+        for (size_t i = 0; i < fedSources.size(); i++) {
+            readahead.run([&, i, frame]() {
+                aheadImages[i] = fedSources[i].generator->next(frame, frame / options.fps);
+            });
+        }
+    };
+    if (options.frames > 0) readAhead(0);
+
+    for (int frame = 0; frame < options.frames; frame++) {
+        auto waitStart = Clock::now();
+        readahead.wait();
+        auto frameStart = Clock::now();
+        captureWaitMs += std::chrono::duration<double, std::milli>(frameStart - waitStart).count();
+        images.swap(aheadImages);
+        if (frame + 1 < options.frames) readAhead(frame + 1);
+
+        // Deliver this frame's image to every source, then run the full pipeline
+        double timestamp = frame / options.fps;
+        for (size_t i = 0; i < fedSources.size(); i++) {
+            if (images[i]) fedSources[i].source->onNewFrame(std::move(images[i]));
+        }
+        replInterpreter->setPipelineTime(timestamp);
+        replInterpreter->executeVideoPipeline();
+        glFinish();  // Count GPU work in the frame time
+        bindingMicros += replInterpreter->getLastBindingMicros();
+
+        frameMs.push_back(std::chrono::duration<double, std::milli>(Clock::now() - frameStart).count());
+
+        // Dumps are outside the timed region
+        if (!options.dumpDir.empty() && frame % options.dumpEvery == 0) {
+            for (const auto& [name, output] : replInterpreter->getOutputVariables()) {
+                char suffix[32];
+                std::snprintf(suffix, sizeof(suffix), "_%05d.ppm", frame);
+                if (output && dumpOutput(*output, options.dumpDir + "/" + name + suffix)) {
+                    dumped++;
+                }
+            }
+        }
+    }
+
+    double totalMs = std::chrono::duration<double, std::milli>(Clock::now() - runStart).count();
+
+    // Timing report
+    std::cout << "\nHeadless run: " << scriptPath << "\n";
+    std::cout << "  script execute: " << scriptMs << " ms\n";
+    std::cout << "  sources: " << fedSources.size() << ", outputs: "
+              << replInterpreter->getOutputVariables().size() << "\n";
+    if (!frameMs.empty()) {
+        std::vector<double> sorted = frameMs;
+        std::sort(sorted.begin(), sorted.end());
+        auto percentile = [&sorted](double p) {
+            size_t index = std::min(sorted.size() - 1, (size_t)(p * (sorted.size() - 1) + 0.5));
+            return sorted[index];
+        };
+        double sum = 0.0;
+        for (double ms : frameMs) sum += ms;
+        double mean = sum / frameMs.size();
+
+        std::cout << "  frames: " << frameMs.size() << " in " << totalMs << " ms\n";
+        std::cout << "  frame ms: mean " << mean << ", min " << sorted.front()
+                  << ", p50 " << percentile(0.50) << ", p95 " << percentile(0.95)
+                  << ", p99 " << percentile(0.99) << ", max " << sorted.back() << "\n";
+        std::cout << "  pipeline fps: " << (mean > 0.0 ? 1000.0 / mean : 0.0) << "\n";
+        std::cout << "  waiting for capture: " << captureWaitMs << " ms\n";
+        if (replInterpreter->getBindingCount() > 0) {
+            std::cout << "  animated bindings: " << replInterpreter->getBindingCount()
+                      << ", eval us/frame mean " << bindingMicros / frameMs.size() << "\n";
+            if (options.benchBindings > 0) {
+                bool met = bindingMicros / frameMs.size() <= 100.0;
+                std::cout << "  binding budget (100 us/frame): " << (met ? "met" : "missed") << "\n";
+            }
+        }
+    }
+    if (!options.dumpDir.empty()) {
+        std::cout << "  dumped " << dumped << " frames to " << options.dumpDir << "\n";
+    }
+
+    return 0;
+}
+
+// Outputs of one pass over every CPU kernel (same parameters as the README edge process)
+struct KernelOutputs {
+    ImagePlane luminance, downscaled, blurred, dog, edges, angles, ascii;
+};
+
+static const AsciiGlyphs& benchGlyphs() {
+    static const AsciiGlyphs glyphs = [] {
+        AsciiGlyphs built;
+        std::string error;
+        built.build(" .:-=+*#%@", error);
+        return built;
+    }();
+    return glyphs;
+}
+
+static void runAllKernels(ImageKernels& kernels, const VideoFrame& frame, KernelOutputs& out) {
+    kernels.luminance(frame, out.luminance);
+    kernels.downscale(out.luminance, 2, out.downscaled);
+    kernels.gaussianBlur(out.luminance, 1.0f, out.blurred);
+    kernels.differenceOfGaussians(out.blurred, 1.0f, 2.0f, 0.98f, out.dog);
+    kernels.sobel(out.luminance, 0.15f, out.edges, out.angles);
+    kernels.ascii(out.luminance, out.luminance, benchGlyphs(), ImageKernels::AsciiParams(), out.ascii);
+}
+
+// Byte-compare two planes; prints the first difference
+static bool samePlane(const char* name, const ImagePlane& reference, const ImagePlane& result) {
+    if (reference.width != result.width || reference.height != result.height) {
+        std::cerr << "ERROR: " << name << " size " << result.width << "x" << result.height
+                  << ", reference " << reference.width << "x" << reference.height << "\n";
+        return false;
+    }
+    for (size_t i = 0; i < reference.pixels.size(); i++) {
+        if (reference.pixels[i] != result.pixels[i]) {
+            std::cerr << "ERROR: " << name << " differs at (" << i % reference.width << ", "
+                      << i / reference.width << "): " << (int)result.pixels[i]
+                      << ", reference " << (int)reference.pixels[i] << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+int runKernelBenchmark(const HeadlessOptions& options) {
+    using Clock = std::chrono::steady_clock;
+
+    FrameGenerator generator;
+    bool opened = options.source == "synthetic"
+        ? generator.openSynthetic(options.sourceWidth, options.sourceHeight)
+        : generator.openFile(options.source);
+    if (!opened) {
+        return -1;
+    }
+    auto frame = generator.next(0, 0.0);
+    if (!frame) {
+        std::cerr << "ERROR: No frame from " << options.source << "\n";
+        return -1;
+    }
+
+    ImageKernels reference(ImageKernels::Backend::SCALAR, 1);
+    ImageKernels simdSingle(ImageKernels::Backend::SIMD, 1);
+    ImageKernels simdThreaded(ImageKernels::Backend::SIMD, options.threads);
+
+    // Validation: the benchmark frame plus noise at odd sizes (SIMD tails, tiny images)
+    std::vector<std::shared_ptr<VideoFrame>> checkFrames = {frame};
+    std::mt19937 random(1234);
+    for (auto [w, h] : {std::pair<int, int>(333, 77), {5, 3}, {1, 1}}) {
+        auto noise = std::make_shared<VideoFrame>(w, h);
+        for (size_t i = 0; i < noise->dataSize; i++) noise->data[i] = (uint8_t)random();
+        checkFrames.push_back(noise);
+    }
+    for (const auto& check : checkFrames) {
+        KernelOutputs expected;
+        runAllKernels(reference, *check, expected);
+        for (ImageKernels* kernels : {&simdSingle, &simdThreaded}) {
+            KernelOutputs result;
+            runAllKernels(*kernels, *check, result);
+            bool same = samePlane("luminance", expected.luminance, result.luminance) &&
+                        samePlane("downscale", expected.downscaled, result.downscaled) &&
+                        samePlane("gaussian_blur", expected.blurred, result.blurred) &&
+                        samePlane("dog", expected.dog, result.dog) &&
+                        samePlane("sobel edges", expected.edges, result.edges) &&
+                        samePlane("sobel angles", expected.angles, result.angles) &&
+                        samePlane("ascii", expected.ascii, result.ascii);
+            if (!same) {
+                std::cerr << "ERROR: " << kernels->getSimdName() << " x" << kernels->getThreadCount()
+                          << " does not match the scalar reference on " << check->width << "x"
+                          << check->height << "\n";
+                return 1;
+            }
+        }
+    }
+    std::cout << "Kernel outputs match the scalar reference (" << checkFrames.size() << " frames)\n";
+
+    // Timing: each kernel up to --frames times (about a second at most), on the same inputs
+    KernelOutputs inputs;
+    runAllKernels(reference, *frame, inputs);
+    double megapixels = (double)frame->width * frame->height / 1e6;
+
+    struct Kernel {
+        const char* name;
+        std::function<void(ImageKernels&, KernelOutputs&)> run;
+    };
+    std::vector<Kernel> kernelList = {
+        {"luminance", [&](ImageKernels& k, KernelOutputs& o) { k.luminance(*frame, o.luminance); }},
+        {"downscale(2)", [&](ImageKernels& k, KernelOutputs& o) { k.downscale(inputs.luminance, 2, o.downscaled); }},
+        {"gaussian_blur(1)", [&](ImageKernels& k, KernelOutputs& o) { k.gaussianBlur(inputs.luminance, 1.0f, o.blurred); }},
+        {"gaussian_blur(4)", [&](ImageKernels& k, KernelOutputs& o) { k.gaussianBlur(inputs.luminance, 4.0f, o.blurred); }},
+        {"dog(1, 2)", [&](ImageKernels& k, KernelOutputs& o) { k.differenceOfGaussians(inputs.blurred, 1.0f, 2.0f, 0.98f, o.dog); }},
+        {"sobel_with_angles", [&](ImageKernels& k, KernelOutputs& o) { k.sobel(inputs.luminance, 0.15f, o.edges, o.angles); }},
+        {"ascii(8)", [&](ImageKernels& k, KernelOutputs& o) {
+            k.luminance(*frame, o.luminance);
+            k.ascii(o.luminance, o.luminance, benchGlyphs(), ImageKernels::AsciiParams(), o.ascii);
+        }},
+    };
+    std::vector<std::pair<std::string, ImageKernels*>> configs = {
+        {"scalar x1", &reference},
+        {std::string(simdSingle.getSimdName()) + " x1", &simdSingle},
+    };
+    if (simdThreaded.getThreadCount() > 1) {
+        configs.push_back({std::string(simdThreaded.getSimdName()) + " x" +
+                           std::to_string(simdThreaded.getThreadCount()), &simdThreaded});
+    }
+
+    std::cout << "\nCPU kernels on " << frame->width << "x" << frame->height << " (Mpix/s)\n";
+    std::printf("  %-18s", "kernel");
+    for (const auto& config : configs) std::printf(" %12s", config.first.c_str());
+    std::printf("\n");
+    for (const auto& kernel : kernelList) {
+        std::printf("  %-18s", kernel.name);
+        for (const auto& config : configs) {
+            KernelOutputs out;
+            kernel.run(*config.second, out);  // Warm-up: allocates outputs and scratch
+            int runs = 0;
+            double elapsed = 0.0;
+            auto start = Clock::now();
+            while (runs < options.frames && elapsed < 1.0) {
+                kernel.run(*config.second, out);
+                runs++;
+                elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+            }
+            std::printf(" %12.1f", megapixels * runs / elapsed);
+        }
+        std::printf("\n");
+    }
+    std::fflush(stdout);
+    return 0;
+}
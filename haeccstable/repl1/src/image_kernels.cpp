@@ -0,0 +1,640 @@
+#include "image_kernels.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define IMAGE_KERNELS_AVX2 1
+#include <immintrin.h>
+#define AVX2_TARGET __attribute__((target("avx2")))
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define IMAGE_KERNELS_NEON 1
+#include <arm_neon.h>
+#endif
+
+// Luminance weights (BT.709, sum 256) and Sobel orientation bounds (tan 22.5 and
+// tan 67.5 degrees, times 256)
+static const int lumaR = 54;
+static const int lumaG = 183;
+static const int lumaB = 19;
+static const int tanLow256 = 106;
+static const int tanHigh256 = 618;
+
+// Same cap as the GPU blur passes
+static const int maxBlurRadius = 30;
+
+namespace {
+
+// ---- Scalar reference ----
+
+void luminanceScalar(const uint8_t* rgb, uint8_t* out, int count) {
+    for (int x = 0; x < count; x++) {
+        const uint8_t* p = rgb + x * 3;
+        out[x] = (uint8_t)((lumaR * p[0] + lumaG * p[1] + lumaB * p[2] + 128) >> 8);
+    }
+}
+
+void blurColumnsScalar(const uint8_t* const* rows, const uint16_t* weights, int taps,
+                       uint16_t* out, int count) {
+    for (int x = 0; x < count; x++) {
+        uint32_t sum = 0;
+        for (int k = 0; k < taps; k++) {
+            sum += weights[k] * rows[k][x];
+        }
+        out[x] = (uint16_t)sum;
+    }
+}
+
+void blurRowScalar(const uint16_t* padded, const uint16_t* weights, int taps,
+                   uint8_t* out, int count) {
+    for (int x = 0; x < count; x++) {
+        uint32_t sum = 0;
+        for (int k = 0; k < taps; k++) {
+            sum += (uint32_t)weights[k] * padded[x + k];
+        }
+        out[x] = (uint8_t)((sum + 32768) >> 16);
+    }
+}
+
+void accumulateScalar(const uint8_t* in, uint16_t* acc, int count) {
+    for (int x = 0; x < count; x++) {
+        acc[x] = (uint16_t)(acc[x] + in[x]);
+    }
+}
+
+void dogThresholdScalar(const uint8_t* blur1, const uint8_t* blur2, int tau256,
+                        uint8_t* out, int count) {
+    for (int x = 0; x < count; x++) {
+        out[x] = blur1[x] * 256 >= tau256 * blur2[x] ? 255 : 0;
+    }
+}
+
+uint8_t sobelAngle(int gx, int gy) {
+    int ax = std::abs(gx);
+    int ay = std::abs(gy);
+    if (ay * 256 <= ax * tanLow256) return 0;
+    if (ay * 256 >= ax * tanHigh256) return 128;
+    return (gx ^ gy) >= 0 ? 64 : 192;
+}
+
+void sobelScalar(const uint8_t* above, const uint8_t* center, const uint8_t* below,
+                 int32_t thresholdSquared, uint8_t* edges, uint8_t* angles, int count) {
+    for (int x = 0; x < count; x++) {
+        int gx = (above[x + 2] + 2 * center[x + 2] + below[x + 2]) -
+                 (above[x] + 2 * center[x] + below[x]);
+        int gy = (below[x] + 2 * below[x + 1] + below[x + 2]) -
+                 (above[x] + 2 * above[x + 1] + above[x + 2]);
+        edges[x] = gx * gx + gy * gy >= thresholdSquared ? 255 : 0;
+        angles[x] = sobelAngle(gx, gy);
+    }
+}
+
+const ImageKernels::RowKernels scalarKernels = {
+    luminanceScalar, blurColumnsScalar, blurRowScalar, accumulateScalar,
+    dogThresholdScalar, sobelScalar
+};
+
+// ---- AVX2 (x86-64; selected at runtime) ----
+// Each loop covers whole vectors; the remainder goes through the scalar code,
+// which computes the same integers.
+
+#ifdef IMAGE_KERNELS_AVX2
+
+// Low byte of each of eight 32-bit lanes (values already in 0-255)
+AVX2_TARGET inline void storeBytes8(uint8_t* out, __m256i values) {
+    __m128i words = _mm_packus_epi32(_mm256_castsi256_si128(values), _mm256_extracti128_si256(values, 1));
+    _mm_storel_epi64((__m128i*)out, _mm_packus_epi16(words, words));
+}
+
+AVX2_TARGET void luminanceAVX2(const uint8_t* rgb, uint8_t* out, int count) {
+    // Gather R, G and B of 16 pixels from 48 interleaved bytes
+    const __m128i r0 = _mm_setr_epi8(0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i r1 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14, -1, -1, -1, -1, -1);
+    const __m128i r2 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 1, 4, 7, 10, 13);
+    const __m128i g0 = _mm_setr_epi8(1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i g1 = _mm_setr_epi8(-1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1);
+    const __m128i g2 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14);
+    const __m128i b0 = _mm_setr_epi8(2, 5, 8, 11, 14, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i b1 = _mm_setr_epi8(-1, -1, -1, -1, -1, 1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1);
+    const __m128i b2 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15);
+    const __m256i wr = _mm256_set1_epi16(lumaR);
+    const __m256i wg = _mm256_set1_epi16(lumaG);
+    const __m256i wb = _mm256_set1_epi16(lumaB);
+    const __m256i round = _mm256_set1_epi16(128);
+
+    int x = 0;
+    for (; x + 16 <= count; x += 16) {
+        const uint8_t* p = rgb + x * 3;
+        __m128i a = _mm_loadu_si128((const __m128i*)p);
+        __m128i b = _mm_loadu_si128((const __m128i*)(p + 16));
+        __m128i c = _mm_loadu_si128((const __m128i*)(p + 32));
+        __m128i r = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a, r0), _mm_shuffle_epi8(b, r1)), _mm_shuffle_epi8(c, r2));
+        __m128i g = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a, g0), _mm_shuffle_epi8(b, g1)), _mm_shuffle_epi8(c, g2));
+        __m128i bl = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a, b0), _mm_shuffle_epi8(b, b1)), _mm_shuffle_epi8(c, b2));
+
+        // Sums stay below 65536, so 16-bit lanes are exact
+        __m256i sum = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_cvtepu8_epi16(r), wr), round);
+        sum = _mm256_add_epi16(sum, _mm256_mullo_epi16(_mm256_cvtepu8_epi16(g), wg));
+        sum = _mm256_add_epi16(sum, _mm256_mullo_epi16(_mm256_cvtepu8_epi16(bl), wb));
+        sum = _mm256_srli_epi16(sum, 8);
+        __m128i bytes = _mm_packus_epi16(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+        _mm_storeu_si128((__m128i*)(out + x), bytes);
+    }
+    luminanceScalar(rgb + x * 3, out + x, count - x);
+}
+
+AVX2_TARGET void blurColumnsAVX2(const uint8_t* const* rows, const uint16_t* weights, int taps,
+                                 uint16_t* out, int count) {
+    int x = 0;
+    for (; x + 16 <= count; x += 16) {
+        __m256i sum = _mm256_setzero_si256();
+        for (int k = 0; k < taps; k++) {
+            __m256i v = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(rows[k] + x)));
+            sum = _mm256_add_epi16(sum, _mm256_mullo_epi16(v, _mm256_set1_epi16((short)weights[k])));
+        }
+        _mm256_storeu_si256((__m256i*)(out + x), sum);
+    }
+    if (x < count) {
+        const uint8_t* tail[2 * maxBlurRadius + 1];
+        for (int k = 0; k < taps; k++) tail[k] = rows[k] + x;
+        blurColumnsScalar(tail, weights, taps, out + x, count - x);
+    }
+}
+
+AVX2_TARGET void blurRowAVX2(const uint16_t* padded, const uint16_t* weights, int taps,
+                             uint8_t* out, int count) {
+    const __m256i round = _mm256_set1_epi32(32768);
+    int x = 0;
+    for (; x + 8 <= count; x += 8) {
+        __m256i sum = round;
+        for (int k = 0; k < taps; k++) {
+            __m256i v = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)(padded + x + k)));
+            sum = _mm256_add_epi32(sum, _mm256_mullo_epi32(v, _mm256_set1_epi32(weights[k])));
+        }
+        storeBytes8(out + x, _mm256_srli_epi32(sum, 16));
+    }
+    blurRowScalar(padded + x, weights, taps, out + x, count - x);
+}
+
+AVX2_TARGET void accumulateAVX2(const uint8_t* in, uint16_t* acc, int count) {
+    int x = 0;
+    for (; x + 16 <= count; x += 16) {
+        __m256i v = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(in + x)));
+        __m256i a = _mm256_loadu_si256((const __m256i*)(acc + x));
+        _mm256_storeu_si256((__m256i*)(acc + x), _mm256_add_epi16(a, v));
+    }
+    accumulateScalar(in + x, acc + x, count - x);
+}
+
+AVX2_TARGET void dogThresholdAVX2(const uint8_t* blur1, const uint8_t* blur2, int tau256,
+                                  uint8_t* out, int count) {
+    // Both sides are at most 255 * 256: compare as unsigned 16-bit (a >= b <=> max(a, b) == a)
+    const __m256i tau = _mm256_set1_epi16((short)tau256);
+    int x = 0;
+    for (; x + 16 <= count; x += 16) {
+        __m256i a = _mm256_slli_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(blur1 + x))), 8);
+        __m256i b = _mm256_mullo_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(blur2 + x))), tau);
+        __m256i mask = _mm256_cmpeq_epi16(_mm256_max_epu16(a, b), a);
+        __m256i bytes = _mm256_packs_epi16(mask, mask);  // 0xFFFF -> 0xFF per lane
+        bytes = _mm256_permute4x64_epi64(bytes, 0x08);
+        _mm_storeu_si128((__m128i*)(out + x), _mm256_castsi256_si128(bytes));
+    }
+    dogThresholdScalar(blur1 + x, blur2 + x, tau256, out + x, count - x);
+}
+
+// Eight bytes widened to 32-bit lanes
+AVX2_TARGET inline __m256i loadWide8(const uint8_t* p) {
+    return _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)p));
+}
+
+AVX2_TARGET void sobelAVX2(const uint8_t* above, const uint8_t* center, const uint8_t* below,
+                           int32_t thresholdSquared, uint8_t* edges, uint8_t* angles, int count) {
+    const __m256i edgeBelow = _mm256_set1_epi32(thresholdSquared - 1);
+    const __m256i tanLow = _mm256_set1_epi32(tanLow256);
+    const __m256i tanHighBelow = _mm256_set1_epi32(tanHigh256);
+    const __m256i minusOne = _mm256_set1_epi32(-1);
+    const __m256i byte = _mm256_set1_epi32(255);
+    const __m256i diagonal = _mm256_set1_epi32(64);
+    const __m256i antiDiagonal = _mm256_set1_epi32(192);
+    const __m256i horizontalEdge = _mm256_set1_epi32(128);
+
+    int x = 0;
+    for (; x + 8 <= count; x += 8) {
+        __m256i a0 = loadWide8(above + x), a1 = loadWide8(above + x + 1), a2 = loadWide8(above + x + 2);
+        __m256i c0 = loadWide8(center + x), c2 = loadWide8(center + x + 2);
+        __m256i b0 = loadWide8(below + x), b1 = loadWide8(below + x + 1), b2 = loadWide8(below + x + 2);
+
+        __m256i right = _mm256_add_epi32(_mm256_add_epi32(a2, b2), _mm256_slli_epi32(c2, 1));
+        __m256i left = _mm256_add_epi32(_mm256_add_epi32(a0, b0), _mm256_slli_epi32(c0, 1));
+        __m256i bottom = _mm256_add_epi32(_mm256_add_epi32(b0, b2), _mm256_slli_epi32(b1, 1));
+        __m256i top = _mm256_add_epi32(_mm256_add_epi32(a0, a2), _mm256_slli_epi32(a1, 1));
+        __m256i gx = _mm256_sub_epi32(right, left);
+        __m256i gy = _mm256_sub_epi32(bottom, top);
+
+        __m256i squared = _mm256_add_epi32(_mm256_mullo_epi32(gx, gx), _mm256_mullo_epi32(gy, gy));
+        storeBytes8(edges + x, _mm256_and_si256(_mm256_cmpgt_epi32(squared, edgeBelow), byte));
+
+        __m256i ay256 = _mm256_slli_epi32(_mm256_abs_epi32(gy), 8);
+        __m256i ax = _mm256_abs_epi32(gx);
+        __m256i vertical = _mm256_cmpgt_epi32(ay256, _mm256_mullo_epi32(ax, tanLow));  // Not a vertical edge
+        __m256i horizontal = _mm256_cmpgt_epi32(_mm256_mullo_epi32(ax, tanHighBelow), ay256);  // Not horizontal
+        __m256i sameSign = _mm256_cmpgt_epi32(_mm256_xor_si256(gx, gy), minusOne);
+        __m256i angle = _mm256_blendv_epi8(antiDiagonal, diagonal, sameSign);
+        angle = _mm256_blendv_epi8(horizontalEdge, angle, horizontal);
+        angle = _mm256_and_si256(angle, vertical);
+        storeBytes8(angles + x, angle);
+    }
+    sobelScalar(above + x, center + x, below + x, thresholdSquared, edges + x, angles + x, count - x);
+}
+
+const ImageKernels::RowKernels avx2Kernels = {
+    luminanceAVX2, blurColumnsAVX2, blurRowAVX2, accumulateAVX2, dogThresholdAVX2, sobelAVX2
+};
+
+#endif // IMAGE_KERNELS_AVX2
+
+// ---- NEON (arm64: always available) ----
+
+#ifdef IMAGE_KERNELS_NEON
+
+void luminanceNEON(const uint8_t* rgb, uint8_t* out, int count) {
+    const uint8x8_t wr = vdup_n_u8(lumaR);
+    const uint8x8_t wg = vdup_n_u8(lumaG);
+    const uint8x8_t wb = vdup_n_u8(lumaB);
+    int x = 0;
+    for (; x + 16 <= count; x += 16) {
+        uint8x16x3_t p = vld3q_u8(rgb + x * 3);
+        uint16x8_t low = vmull_u8(vget_low_u8(p.val[0]), wr);
+        low = vmlal_u8(low, vget_low_u8(p.val[1]), wg);
+        low = vmlal_u8(low, vget_low_u8(p.val[2]), wb);
+        uint16x8_t high = vmull_u8(vget_high_u8(p.val[0]), wr);
+        high = vmlal_u8(high, vget_high_u8(p.val[1]), wg);
+        high = vmlal_u8(high, vget_high_u8(p.val[2]), wb);
+        // Rounding narrow: (sum + 128) >> 8
+        vst1q_u8(out + x, vcombine_u8(vrshrn_n_u16(low, 8), vrshrn_n_u16(high, 8)));
+    }
+    luminanceScalar(rgb + x * 3, out + x, count - x);
+}
+
+void blurColumnsNEON(const uint8_t* const* rows, const uint16_t* weights, int taps,
+                     uint16_t* out, int count) {
+    int x = 0;
+    for (; x + 8 <= count; x += 8) {
+        uint16x8_t sum = vdupq_n_u16(0);
+        for (int k = 0; k < taps; k++) {
+            sum = vmlaq_n_u16(sum, vmovl_u8(vld1_u8(rows[k] + x)), weights[k]);
+        }
+        vst1q_u16(out + x, sum);
+    }
+    if (x < count) {
+        const uint8_t* tail[2 * maxBlurRadius + 1];
+        for (int k = 0; k < taps; k++) tail[k] = rows[k] + x;
+        blurColumnsScalar(tail, weights, taps, out + x, count - x);
+    }
+}
+
+void blurRowNEON(const uint16_t* padded, const uint16_t* weights, int taps,
+                 uint8_t* out, int count) {
+    int x = 0;
+    for (; x + 8 <= count; x += 8) {
+        uint32x4_t low = vdupq_n_u32(0);
+        uint32x4_t high = vdupq_n_u32(0);
+        for (int k = 0; k < taps; k++) {
+            uint16x8_t v = vld1q_u16(padded + x + k);
+            low = vmlal_n_u16(low, vget_low_u16(v), weights[k]);
+            high = vmlal_n_u16(high, vget_high_u16(v), weights[k]);
+        }
+        // Rounding narrow: (sum + 32768) >> 16
+        uint16x8_t words = vcombine_u16(vrshrn_n_u32(low, 16), vrshrn_n_u32(high, 16));
+        vst1_u8(out + x, vmovn_u16(words));
+    }
+    blurRowScalar(padded + x, weights, taps, out + x, count - x);
+}
+
+void accumulateNEON(const uint8_t* in, uint16_t* acc, int count) {
+    int x = 0;
+    for (; x + 8 <= count; x += 8) {
+        vst1q_u16(acc + x, vaddw_u8(vld1q_u16(acc + x), vld1_u8(in + x)));
+    }
+    accumulateScalar(in + x, acc + x, count - x);
+}
+
+void dogThresholdNEON(const uint8_t* blur1, const uint8_t* blur2, int tau256,
+                      uint8_t* out, int count) {
+    int x = 0;
+    for (; x + 8 <= count; x += 8) {
+        uint16x8_t a = vshll_n_u8(vld1_u8(blur1 + x), 8);
+        uint16x8_t b = vmulq_n_u16(vmovl_u8(vld1_u8(blur2 + x)), (uint16_t)tau256);
+        vst1_u8(out + x, vmovn_u16(vcgeq_u16(a, b)));
+    }
+    dogThresholdScalar(blur1 + x, blur2 + x, tau256, out + x, count - x);
+}
+
+void sobelNEON(const uint8_t* above, const uint8_t* center, const uint8_t* below,
+               int32_t thresholdSquared, uint8_t* edges, uint8_t* angles, int count) {
+    auto load = [](const uint8_t* p) { return vreinterpretq_s16_u16(vmovl_u8(vld1_u8(p))); };
+    const int32x4_t threshold = vdupq_n_s32(thresholdSquared);
+    int x = 0;
+    for (; x + 8 <= count; x += 8) {
+        int16x8_t a0 = load(above + x), a1 = load(above + x + 1), a2 = load(above + x + 2);
+        int16x8_t c0 = load(center + x), c2 = load(center + x + 2);
+        int16x8_t b0 = load(below + x), b1 = load(below + x + 1), b2 = load(below + x + 2);
+
+        // |gx|, |gy| <= 1020: 16-bit lanes are exact
+        int16x8_t gx = vsubq_s16(vaddq_s16(vaddq_s16(a2, b2), vshlq_n_s16(c2, 1)),
+                                 vaddq_s16(vaddq_s16(a0, b0), vshlq_n_s16(c0, 1)));
+        int16x8_t gy = vsubq_s16(vaddq_s16(vaddq_s16(b0, b2), vshlq_n_s16(b1, 1)),
+                                 vaddq_s16(vaddq_s16(a0, a2), vshlq_n_s16(a1, 1)));
+        int16x8_t ax = vabsq_s16(gx);
+        int16x8_t ay = vabsq_s16(gy);
+
+        uint16x4_t edgeHalves[2];
+        uint16x4_t verticalHalves[2];
+        uint16x4_t horizontalHalves[2];
+        for (int half = 0; half < 2; half++) {
+            int16x4_t hx = half ? vget_high_s16(gx) : vget_low_s16(gx);
+            int16x4_t hy = half ? vget_high_s16(gy) : vget_low_s16(gy);
+            int16x4_t hax = half ? vget_high_s16(ax) : vget_low_s16(ax);
+            int16x4_t hay = half ? vget_high_s16(ay) : vget_low_s16(ay);
+            int32x4_t squared = vmlal_s16(vmull_s16(hx, hx), hy, hy);
+            int32x4_t ay256 = vshll_n_s16(hay, 8);
+            edgeHalves[half] = vmovn_u32(vcgeq_s32(squared, threshold));
+            verticalHalves[half] = vmovn_u32(vcleq_s32(ay256, vmull_n_s16(hax, tanLow256)));
+            horizontalHalves[half] = vmovn_u32(vcgeq_s32(ay256, vmull_n_s16(hax, tanHigh256)));
+        }
+        uint8x8_t edge = vmovn_u16(vcombine_u16(edgeHalves[0], edgeHalves[1]));
+        uint8x8_t vertical = vmovn_u16(vcombine_u16(verticalHalves[0], verticalHalves[1]));
+        uint8x8_t horizontal = vmovn_u16(vcombine_u16(horizontalHalves[0], horizontalHalves[1]));
+        uint8x8_t sameSign = vmovn_u16(vcgeq_s16(veorq_s16(gx, gy), vdupq_n_s16(0)));
+
+        uint8x8_t angle = vbsl_u8(sameSign, vdup_n_u8(64), vdup_n_u8(192));
+        angle = vbsl_u8(horizontal, vdup_n_u8(128), angle);
+        angle = vbic_u8(angle, vertical);
+        vst1_u8(edges + x, edge);
+        vst1_u8(angles + x, angle);
+    }
+    sobelScalar(above + x, center + x, below + x, thresholdSquared, edges + x, angles + x, count - x);
+}
+
+const ImageKernels::RowKernels neonKernels = {
+    luminanceNEON, blurColumnsNEON, blurRowNEON, accumulateNEON, dogThresholdNEON, sobelNEON
+};
+
+#endif // IMAGE_KERNELS_NEON
+
+} // namespace
+
+ImageKernels::ImageKernels(Backend backend, int threads)
+    : backend(backend), kernels(scalarKernels), simdName("scalar"),
+      ownPool(threads > 0 ? std::make_unique<ThreadPool>(threads) : nullptr),
+      pool(ownPool ? ownPool.get() : &ThreadPool::shared()) {
+    if (backend == Backend::SIMD) {
+#if defined(IMAGE_KERNELS_AVX2)
+        if (__builtin_cpu_supports("avx2")) {
+            kernels = avx2Kernels;
+            simdName = "AVX2";
+        }
+#elif defined(IMAGE_KERNELS_NEON)
+        kernels = neonKernels;
+        simdName = "NEON";
+#endif
+    }
+    scratch.resize(pool->getThreadCount());
+}
+
+const char* ImageKernels::getSimdName() const {
+    return simdName;
+}
+
+int ImageKernels::rowGrain(int width) {
+    return std::max(1, 65536 / std::max(1, width));
+}
+
+std::vector<uint16_t> ImageKernels::gaussianWeights(float sigma) {
+    int radius = std::min(maxBlurRadius, std::max(1, (int)std::ceil(sigma * 3.0f)));
+    std::vector<double> exact(2 * radius + 1);
+    double total = 0.0;
+    for (int i = -radius; i <= radius; i++) {
+        exact[i + radius] = std::exp(-(double)(i * i) / (2.0 * sigma * sigma));
+        total += exact[i + radius];
+    }
+
+    // Round each tap, then put the rounding error on the center so the sum is exactly 256
+    std::vector<uint16_t> weights(exact.size());
+    int sum = 0;
+    for (size_t i = 0; i < exact.size(); i++) {
+        weights[i] = (uint16_t)std::lround(exact[i] / total * 256.0);
+        sum += weights[i];
+    }
+    weights[radius] = (uint16_t)(weights[radius] + 256 - sum);
+    return weights;
+}
+
+void ImageKernels::blurOutputRow(const ImagePlane& in, int y, const std::vector<uint16_t>& weights,
+                                 Scratch& rows, uint8_t* out) const {
+    int taps = (int)weights.size();
+    int radius = taps / 2;
+    int width = in.width;
+
+    // Vertical taps into the middle of a padded 16-bit row
+    const uint8_t* sourceRows[2 * maxBlurRadius + 1];
+    for (int k = 0; k < taps; k++) {
+        sourceRows[k] = in.row(std::min(in.height - 1, std::max(0, y + k - radius)));
+    }
+    rows.wide.resize(width + 2 * radius);
+    uint16_t* padded = rows.wide.data();
+    kernels.blurColumns(sourceRows, weights.data(), taps, padded + radius, width);
+
+    // Clamp-to-edge padding, then the horizontal taps need no border cases
+    std::fill(padded, padded + radius, padded[radius]);
+    std::fill(padded + radius + width, padded + width + 2 * radius, padded[radius + width - 1]);
+    kernels.blurRow(padded, weights.data(), taps, out, width);
+}
+
+void ImageKernels::luminance(const VideoFrame& frame, ImagePlane& out) {
+    out.resize(frame.width, frame.height);
+    const uint8_t* rgb = frame.data.get();
+    pool->parallelFor(frame.height, rowGrain(frame.width), [&](int begin, int end, int) {
+        for (int y = begin; y < end; y++) {
+            kernels.luminance(rgb + (size_t)y * frame.width * 3, out.row(y), frame.width);
+        }
+    });
+}
+
+void ImageKernels::downscale(const ImagePlane& in, int factor, ImagePlane& out) {
+    factor = std::max(1, std::min(64, factor));
+    out.resize(std::max(1, in.width / factor), std::max(1, in.height / factor));
+    int blockWidth = std::min(factor, in.width);
+    int blockHeight = std::min(factor, in.height);
+
+    // Divide by the block area as a 16.16 reciprocal (same integers on every path)
+    uint32_t reciprocal = (uint32_t)((65536 + blockWidth * blockHeight / 2) / (blockWidth * blockHeight));
+
+    pool->parallelFor(out.height, std::max(1, rowGrain(out.width) / factor), [&](int begin, int end, int worker) {
+        std::vector<uint16_t>& acc = scratch[worker].wide;
+        for (int y = begin; y < end; y++) {
+            // Column sums over the block's rows (vectorized), then each block's columns
+            acc.assign(in.width, 0);
+            for (int row = 0; row < blockHeight; row++) {
+                kernels.accumulate(in.row(y * factor + row), acc.data(), in.width);
+            }
+            uint8_t* target = out.row(y);
+            for (int x = 0; x < out.width; x++) {
+                uint32_t sum = 0;
+                const uint16_t* block = acc.data() + x * factor;
+                for (int i = 0; i < blockWidth; i++) sum += block[i];
+                target[x] = (uint8_t)std::min<uint32_t>(255, (sum * reciprocal + 32768) >> 16);
+            }
+        }
+    });
+}
+
+void ImageKernels::gaussianBlur(const ImagePlane& in, float sigma, ImagePlane& out) {
+    out.resize(in.width, in.height);
+    std::vector<uint16_t> weights = gaussianWeights(sigma);
+    pool->parallelFor(in.height, rowGrain(in.width), [&](int begin, int end, int worker) {
+        for (int y = begin; y < end; y++) {
+            blurOutputRow(in, y, weights, scratch[worker], out.row(y));
+        }
+    });
+}
+
+void ImageKernels::differenceOfGaussians(const ImagePlane& in, float sigma1, float sigma2, float tau,
+                                         ImagePlane& out) {
+    out.resize(in.width, in.height);
+    std::vector<uint16_t> inner = gaussianWeights(sigma1);
+    std::vector<uint16_t> outer = gaussianWeights(sigma2);
+    int tau256 = (int)std::lround(std::max(0.0f, std::min(1.0f, tau)) * 256.0f);
+
+    // Both blurs of a row are made in scratch and compared at once (no full-size temporaries)
+    pool->parallelFor(in.height, rowGrain(in.width), [&](int begin, int end, int worker) {
+        Scratch& rows = scratch[worker];
+        rows.bytes.resize((size_t)in.width * 2);
+        uint8_t* blur1 = rows.bytes.data();
+        uint8_t* blur2 = blur1 + in.width;
+        for (int y = begin; y < end; y++) {
+            blurOutputRow(in, y, inner, rows, blur1);
+            blurOutputRow(in, y, outer, rows, blur2);
+            kernels.dogThreshold(blur1, blur2, tau256, out.row(y), in.width);
+        }
+    });
+}
+
+void ImageKernels::sobel(const ImagePlane& in, float threshold, ImagePlane& edges, ImagePlane& angles) {
+    edges.resize(in.width, in.height);
+    angles.resize(in.width, in.height);
+    float scaled = std::max(0.0f, threshold) * 255.0f;
+    int32_t thresholdSquared = (int32_t)std::min(2147483647.0, std::ceil((double)scaled * scaled));
+
+    int width = in.width;
+    pool->parallelFor(in.height, rowGrain(width), [&](int begin, int end, int worker) {
+        // Three clamped rows, each padded by one clamped pixel per side
+        Scratch& rows = scratch[worker];
+        rows.bytes.resize((size_t)(width + 2) * 3);
+        uint8_t* padded[3] = {rows.bytes.data(), rows.bytes.data() + width + 2,
+                              rows.bytes.data() + 2 * (width + 2)};
+        for (int y = begin; y < end; y++) {
+            for (int i = 0; i < 3; i++) {
+                const uint8_t* source = in.row(std::min(in.height - 1, std::max(0, y + i - 1)));
+                std::copy(source, source + width, padded[i] + 1);
+                padded[i][0] = source[0];
+                padded[i][width + 1] = source[width - 1];
+            }
+            kernels.sobel(padded[0], padded[1], padded[2], thresholdSquared,
+                          edges.row(y), angles.row(y), width);
+        }
+    });
+}
+
+void ImageKernels::ascii(const ImagePlane& luminance, const ImagePlane& edgeSource, const AsciiGlyphs& glyphs,
+                         const AsciiParams& params, ImagePlane& out) {
+    const int cell = std::max(1, params.cellSize);
+    const int tilesX = std::max(1, luminance.width / cell);
+    const int tilesY = std::max(1, luminance.height / cell);
+    out.resize(tilesX * cell, tilesY * cell);
+    if (params.useEdges) {
+        sobel(edgeSource, params.threshold, asciiEdges, asciiAngles);
+    }
+
+    const int ramp = glyphs.getRampLength();
+    const uint32_t fullTile = 255u * cell * cell;
+    pool->parallelFor(tilesY, std::max(1, rowGrain(out.width) / cell), [&](int begin, int end, int worker) {
+        // Per tile of the row: luminance sum, then edge pixels per orientation
+        std::vector<uint32_t>& sums = scratch[worker].tileSums;
+        std::vector<uint16_t>& columns = scratch[worker].wide;
+        std::vector<uint8_t>& chosen = scratch[worker].bytes;
+        sums.resize((size_t)tilesX * 5);
+        chosen.resize(tilesX);
+        uint32_t* counts = sums.data() + tilesX;
+
+        for (int ty = begin; ty < end; ty++) {
+            // Column sums over the tile's rows (vectorized), then each tile's columns
+            columns.assign(luminance.width, 0);
+            for (int r = 0; r < cell; r++) {
+                int y = std::min(luminance.height - 1, ty * cell + r);
+                kernels.accumulate(luminance.row(y), columns.data(), luminance.width);
+            }
+            for (int tx = 0; tx < tilesX; tx++) {
+                uint32_t sum = 0;
+                for (int c = 0; c < cell; c++) sum += columns[std::min(tx * cell + c, luminance.width - 1)];
+                sums[tx] = sum;
+            }
+
+            // Edges are sparse: skip eight empty pixels at a time
+            std::fill(counts, counts + tilesX * 4, 0u);
+            for (int r = 0; params.useEdges && r < cell; r++) {
+                int y = std::min(asciiEdges.height - 1, ty * cell + r);
+                const uint8_t* edgeRow = asciiEdges.row(y);
+                const uint8_t* angleRow = asciiAngles.row(y);
+                int inside = std::min(tilesX * cell, asciiEdges.width);
+                int x = 0;
+                for (; x + 8 <= inside; x += 8) {
+                    uint64_t word;
+                    std::memcpy(&word, edgeRow + x, sizeof(word));
+                    if (word == 0) continue;
+                    for (int i = x; i < x + 8; i++) {
+                        if (edgeRow[i]) counts[(i / cell) * 4 + (angleRow[i] >> 6)]++;
+                    }
+                }
+                for (; x < tilesX * cell; x++) {
+                    int edgeX = std::min(x, asciiEdges.width - 1);
+                    if (edgeRow[edgeX]) counts[(x / cell) * 4 + (angleRow[edgeX] >> 6)]++;
+                }
+            }
+
+            for (int tx = 0; tx < tilesX; tx++) {
+                int bucket = (int)std::min<uint64_t>(ramp - 1, (uint64_t)sums[tx] * ramp / fullTile);
+                int glyph = params.invertLuminance ? ramp - 1 - bucket : bucket;
+                if (params.useEdges) {
+                    const uint32_t* tile = counts + tx * 4;
+                    uint32_t total = tile[0] + tile[1] + tile[2] + tile[3];
+                    if (total > 0 && total >= (uint32_t)params.edgeThreshold) {
+                        int best = 0;
+                        for (int o = 1; o < 4; o++) {
+                            if (tile[o] > tile[best]) best = o;
+                        }
+                        glyph = glyphs.getEdgeGlyph(best);
+                    }
+                }
+                chosen[tx] = (uint8_t)glyph;
+            }
+
+            // Glyph rows, scaled from the 8x8 cell (nearest)
+            for (int r = 0; r < cell; r++) {
+                uint8_t* target = out.row(ty * cell + r);
+                int glyphRow = r * AsciiGlyphs::cellSize / cell;
+                for (int tx = 0; tx < tilesX; tx++) {
+                    const uint8_t* source = glyphs.glyphRow(chosen[tx], glyphRow);
+                    if (cell == AsciiGlyphs::cellSize) {
+                        std::copy(source, source + cell, target + tx * cell);
+                        continue;
+                    }
+                    for (int c = 0; c < cell; c++) {
+                        target[tx * cell + c] = source[c * AsciiGlyphs::cellSize / cell];
+                    }
+                }
+            }
+        }
+    });
+}
@@ -176,16 +176,9 @@ void InputHandler::keyCallbackStatic(GLFWwindow* window, int key, int scancode,
                 // In shell INSERT mode, use UP for command history
                 if (handler->activeWindow == 2 && handler->shellHistoryCallback) {
                     std::string historyCmd = handler->shellHistoryCallback(-1);  // Previous command
-                    // Clear current command line
+                    // Replace current command line with the history command
                     int lastLine = buffer->getLineCount() - 1;
-                    buffer->setCursor(lastLine, 0);
-                    while (!buffer->getLines()[lastLine].empty()) {
-                        buffer->deleteChar();
-                    }
-                    // Insert history command
-                    for (char c : historyCmd) {
-                        buffer->insertChar(c);
-                    }
+                    buffer->replaceRange(lastLine, 0, lastLine, buffer->getLines()[lastLine].length(), historyCmd);
                 } else if (handler->activeWindow != 2) {
                     buffer->moveCursorUp();
                 }
@@ -193,16 +186,9 @@ void InputHandler::keyCallbackStatic(GLFWwindow* window, int key, int scancode,
                 // In shell INSERT mode, use DOWN for command history
                 if (handler->activeWindow == 2 && handler->shellHistoryCallback) {
                     std::string historyCmd = handler->shellHistoryCallback(1);  // Next command
-                    // Clear current command line
+                    // Replace current command line with the history command
                     int lastLine = buffer->getLineCount() - 1;
-                    buffer->setCursor(lastLine, 0);
-                    while (!buffer->getLines()[lastLine].empty()) {
-                        buffer->deleteChar();
-                    }
-                    // Insert history command
-                    for (char c : historyCmd) {
-                        buffer->insertChar(c);
-                    }
+                    buffer->replaceRange(lastLine, 0, lastLine, buffer->getLines()[lastLine].length(), historyCmd);
                 } else if (handler->activeWindow != 2) {
                     buffer->moveCursorDown();
                 }
@@ -342,12 +328,9 @@ void InputHandler::keyCallbackStatic(GLFWwindow* window, int key, int scancode,
             }
             // For shell (window 2), clear command line and enter INSERT mode
             if (handler->activeWindow == 2 && buffer->getLineCount() > 0) {
-                int lastLine = buffer->getLineCount() - 1;
-                buffer->setCursor(lastLine, 0);
                 // Clear the command line
-                while (!buffer->getLines()[lastLine].empty()) {
-                    buffer->deleteChar();
-                }
+                int lastLine = buffer->getLineCount() - 1;
+                buffer->replaceRange(lastLine, 0, lastLine, buffer->getLines()[lastLine].length(), "");
             } else {
                 if (mods & GLFW_MOD_SHIFT) {
                     // S - substitute line (delete line and enter insert mode)
@@ -1,4 +1,5 @@
 #include "layer.h"
+#include "render_graph.h"
 #include <iostream>
 #include <cmath>
 
@@ -14,11 +15,23 @@ Layer::Layer(const std::string& name)
       rotXY(0.0f),
       rotY(0.0f),
       opacity(100.0f),  // Default fully opaque
+      animPosX(0.0f),
+      animPosY(0.0f),
+      animScaleX(1.0f),
+      animScaleY(1.0f),
+      animRotXY(0.0f),
+      animRotY(0.0f),
+      animOpacity(-1.0f),
       source(nullptr),
       texture(nullptr),
+      process(nullptr),
+      uploadedBytes(0),
+      processUploadedBytes(0),
       framebuffer(0),
       renderTexture(0),
-      depthBuffer(0) {
+      depthBuffer(0),
+      framebufferWidth(0),
+      framebufferHeight(0) {
 }
 
 Layer::~Layer() {
@@ -32,11 +45,11 @@ void Layer::setCanvas(int width, int height) {
     if (width > 0 && height > 0) {
         aspectRatio = static_cast<float>(width) / static_cast<float>(height);
 
-        // Initialize framebuffer with new dimensions
-        if (framebuffer != 0) {
+        // Initialize framebuffer with new dimensions (same size keeps the current one)
+        if (framebuffer == 0 || width != framebufferWidth || height != framebufferHeight) {
             cleanupFramebuffer();
+            initFramebuffer(width, height);
         }
-        initFramebuffer(width, height);
 
         std::cout << "Layer '" << name << "' canvas set to "
                   << width << "x" << height
@@ -71,13 +84,70 @@ void Layer::setOpacity(float opacityPercent) {
     opacity = std::max(0.0f, std::min(100.0f, opacityPercent));
 }
 
+void Layer::clearAnimation() {
+    animPosX = 0.0f;
+    animPosY = 0.0f;
+    animScaleX = 1.0f;
+    animScaleY = 1.0f;
+    animRotXY = 0.0f;
+    animRotY = 0.0f;
+    animOpacity = -1.0f;
+}
+
+void Layer::animateTransform(float changeX, float changeY) {
+    animPosX += changeX;
+    animPosY += changeY;
+}
+
+void Layer::animateScale(float scaleW, float scaleH) {
+    animScaleX *= scaleW;
+    animScaleY *= scaleH;
+}
+
+void Layer::animateRot(float xyDegrees, float yDegrees) {
+    animRotXY += xyDegrees;
+    animRotY += yDegrees;
+}
+
+void Layer::animateOpacity(float opacityPercent) {
+    animOpacity = std::max(0.0f, std::min(100.0f, opacityPercent));
+}
+
+float Layer::getRotXY() const {
+    return animRotXY == 0.0f ? rotXY : fmod(rotXY + animRotXY, 360.0f);
+}
+
+float Layer::getRotY() const {
+    return animRotY == 0.0f ? rotY : fmod(rotY + animRotY, 360.0f);
+}
+
+void Layer::reset() {
+    canvasWidth = -1;
+    canvasHeight = -1;
+    aspectRatio = 16.0f / 9.0f;
+    posX = 0.0f;
+    posY = 0.0f;
+    scaleX = 1.0f;
+    scaleY = 1.0f;
+    rotXY = 0.0f;
+    rotY = 0.0f;
+    opacity = 100.0f;
+    source = nullptr;
+    process = nullptr;
+    clearAnimation();
+}
+
 void Layer::setSource(std::shared_ptr<VideoSource> src) {
     source = src;
+    process = nullptr;
 
-    // Create texture lazily when source is set
+    // Create texture lazily when source is set (reused if the size matches)
     if (source && source->isOpen()) {
-        texture = std::make_shared<VideoTexture>();
-        texture->init(source->getWidth(), source->getHeight());
+        if (!texture || texture->getWidth() != source->getWidth() ||
+            texture->getHeight() != source->getHeight()) {
+            texture = std::make_shared<VideoTexture>();
+            texture->init(source->getWidth(), source->getHeight());
+        }
 
         // Auto-detect canvas if not set
         if (canvasWidth == -1 || canvasHeight == -1) {
@@ -86,7 +156,22 @@ void Layer::setSource(std::shared_ptr<VideoSource> src) {
     }
 }
 
+void Layer::setProcess(std::shared_ptr<RenderGraph> graph) {
+    process = graph;
+    source = nullptr;
+    processUploadedBytes = process ? process->getUploadedBytes() : 0;
+
+    // The canvas is auto-detected from the graph output on its first frame
+    if (process && process->getOutput() && (canvasWidth == -1 || canvasHeight == -1)) {
+        setCanvas(process->getWidth(), process->getHeight());
+    }
+}
+
 std::shared_ptr<VideoTexture> Layer::getTexture() {
+    if (process) {
+        return process->getOutput();
+    }
+
     // Lazy texture creation
     if (!texture && source && source->isOpen()) {
         texture = std::make_shared<VideoTexture>();
@@ -96,6 +181,18 @@ std::shared_ptr<VideoTexture> Layer::getTexture() {
 }
 
 void Layer::execute() {
+    // Process outputs run their passes (a no-op when the inputs have no new frame)
+    if (process) {
+        process->execute();
+        uint64_t graphBytes = process->getUploadedBytes();
+        uploadedBytes.fetch_add(graphBytes - processUploadedBytes, std::memory_order_relaxed);
+        processUploadedBytes = graphBytes;
+        if (process->getOutput() && (canvasWidth == -1 || canvasHeight == -1)) {
+            setCanvas(process->getWidth(), process->getHeight());
+        }
+        return;
+    }
+
     // Lazy execution: fetch frame and update texture
     if (!source || !source->isOpen()) return;
 
@@ -106,7 +203,9 @@ void Layer::execute() {
             texture = std::make_shared<VideoTexture>();
             texture->init(frame->width, frame->height);
         }
-        texture->update(frame);
+        if (texture->update(frame)) {
+            uploadedBytes.fetch_add(frame->dataSize, std::memory_order_relaxed);
+        }
     }
 }
 
@@ -132,6 +231,26 @@ void Layer::render(int parentW, int parentH) {
     execute();
 }
 
+void Layer::setTransform(const Transform& transform) {
+    posX = transform.posX;
+    posY = transform.posY;
+    scaleX = transform.scaleX;
+    scaleY = transform.scaleY;
+    rotXY = transform.rotXY;
+    rotY = transform.rotY;
+    opacity = transform.opacity;
+}
+
+void Layer::prepare(int framebufferW, int framebufferH, int sourceW, int sourceH) {
+    if (framebuffer == 0 && framebufferW > 0 && framebufferH > 0) {
+        initFramebuffer(framebufferW, framebufferH);
+    }
+    if (source && !texture && sourceW > 0 && sourceH > 0) {
+        texture = std::make_shared<VideoTexture>();
+        texture->init(sourceW, sourceH);
+    }
+}
+
 void Layer::initFramebuffer(int width, int height) {
     if (width <= 0 || height <= 0) return;
 
@@ -167,6 +286,9 @@ void Layer::initFramebuffer(int width, int height) {
     glBindTexture(GL_TEXTURE_2D, 0);
     glBindRenderbuffer(GL_RENDERBUFFER, 0);
 
+    framebufferWidth = width;
+    framebufferHeight = height;
+
     std::cout << "Initialized framebuffer for layer '" << name
               << "' (" << width << "x" << height << ")\n";
 }
@@ -0,0 +1,139 @@
+#include "line_ring.h"
+#include <algorithm>
+#include <utility>
+
+// Spare chunks beyond this are freed rather than pooled
+static const size_t maxSpareChunks = 2;
+
+LineRing::LineRing() : head(0), count(0) {
+}
+
+void LineRing::releaseChunk(std::unique_ptr<Chunk> chunk) {
+    if (spareChunks.size() < maxSpareChunks) {
+        spareChunks.push_back(std::move(chunk));
+    }
+}
+
+void LineRing::push_back(const std::string& line) {
+    size_t slot = head + count;
+    if (slot / chunkLines == chunks.size()) {
+        if (!spareChunks.empty()) {
+            chunks.push_back(std::move(spareChunks.back()));
+            spareChunks.pop_back();
+        } else {
+            chunks.push_back(std::make_unique<Chunk>());
+        }
+    }
+    count++;
+
+    // assign() reuses the slot's existing capacity from a recycled line
+    at(count - 1).assign(line);
+}
+
+void LineRing::pop_front() {
+    if (count == 0) return;
+
+    // Keep capacity for reuse, drop contents
+    at(0).clear();
+    head++;
+    count--;
+
+    if (head == chunkLines) {
+        releaseChunk(std::move(chunks.front()));
+        chunks.pop_front();
+        head = 0;
+    }
+}
+
+void LineRing::pop_back() {
+    if (count == 0) return;
+
+    at(count - 1).clear();
+    count--;
+
+    // Release the tail chunk once nothing lives in it
+    size_t usedChunks = (head + count + chunkLines - 1) / chunkLines;
+    if (count == 0) usedChunks = 1;
+    while (chunks.size() > usedChunks) {
+        releaseChunk(std::move(chunks.back()));
+        chunks.pop_back();
+    }
+}
+
+void LineRing::insert(size_t index, const std::string& line) {
+    if (index >= count) {
+        push_back(line);
+        return;
+    }
+
+    // Open a slot at the end and bubble it down to index (swaps don't copy text)
+    push_back(std::string());
+    for (size_t i = count - 1; i > index; i--) {
+        at(i).swap(at(i - 1));
+    }
+    at(index).assign(line);
+}
+
+void LineRing::erase(size_t index) {
+    if (index >= count) return;
+    if (index == 0) {
+        pop_front();
+        return;
+    }
+
+    for (size_t i = index; i + 1 < count; i++) {
+        at(i).swap(at(i + 1));
+    }
+    pop_back();
+}
+
+void LineRing::insert(size_t index, std::vector<std::string>&& newLines) {
+    if (index > count) index = count;
+    size_t shift = newLines.size();
+    if (shift == 0) return;
+
+    for (size_t i = 0; i < shift; i++) {
+        push_back(std::string());
+    }
+    for (size_t i = count - 1; i >= index + shift; i--) {
+        at(i).swap(at(i - shift));
+    }
+    for (size_t i = 0; i < shift; i++) {
+        at(index + i).swap(newLines[i]);
+    }
+}
+
+void LineRing::erase(size_t index, size_t lineCount) {
+    if (index >= count) return;
+    lineCount = std::min(lineCount, count - index);
+
+    // Front ranges are dropped in place
+    if (index == 0) {
+        for (size_t i = 0; i < lineCount; i++) {
+            pop_front();
+        }
+        return;
+    }
+
+    for (size_t i = index; i + lineCount < count; i++) {
+        at(i).swap(at(i + lineCount));
+    }
+    for (size_t i = 0; i < lineCount; i++) {
+        pop_back();
+    }
+}
+
+void LineRing::clear() {
+    // Only pooled chunks need their lines emptied; the rest are freed
+    while (!chunks.empty()) {
+        if (spareChunks.size() < maxSpareChunks) {
+            for (auto& line : chunks.back()->lines) {
+                line.clear();
+            }
+        }
+        releaseChunk(std::move(chunks.back()));
+        chunks.pop_back();
+    }
+    head = 0;
+    count = 0;
+}
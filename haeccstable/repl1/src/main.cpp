@@ -1,18 +1,40 @@
+#include <chrono>
 #include <iostream>
 #include <memory>
 #include <sstream>
 #include <fstream>
+#include <map>
 #include <glad/glad.h>
 #include "window_manager.h"
 #include "layout_manager.h"
 #include "renderer.h"
+#include "gl_state.h"
 #include "input_handler.h"
 #include "nvim_client.h"
 #include "text_buffer.h"
 #include "repl_interpreter.h"
 #include "dossier_manager.h"
+#include "presentation_window.h"
+#include "output_variable.h"
+#include "display_buffer.h"
+#include "headless_runner.h"
+#include "preset_library.h"
+#include "session_snapshot.h"
+#include "thread_pool.h"
+#include "video_source.h"
 
 int main(int argc, char** argv) {
+    // Headless mode: no window, run a script through the video pipeline and exit
+    for (int i = 1; i < argc; i++) {
+        if (std::string(argv[i]) == "--headless") {
+            HeadlessOptions options;
+            if (!parseHeadlessOptions(argc, argv, options)) {
+                return -1;
+            }
+            return runHeadless(options);
+        }
+    }
+
     std::cout << "REPL1 - Live Coding Environment for Video and Animation\n";
     std::cout << "Initializing...\n";
 
@@ -44,10 +66,12 @@ int main(int argc, char** argv) {
     inputHandler->setup(windowMgr->getWindow());
 
     // Create text buffers for each window
-    auto dossierBuffer = std::make_unique<TextBuffer>(100);
-    auto replBuffer = std::make_unique<TextBuffer>(100);
-    auto shellBuffer = std::make_unique<TextBuffer>(100);
-    auto consoleBuffer = std::make_unique<TextBuffer>(100);
+    // Large caps: bulk loads don't truncate documents, and shell/console keep
+    // long scrollback (eviction is O(1))
+    auto dossierBuffer = std::make_unique<TextBuffer>(1000000);
+    auto replBuffer = std::make_unique<TextBuffer>(1000000);
+    auto shellBuffer = std::make_unique<TextBuffer>(1000000);
+    auto consoleBuffer = std::make_unique<TextBuffer>(1000000);
 
     // Store pointers for easy access
     TextBuffer* buffers[] = {
@@ -100,80 +124,66 @@ int main(int argc, char** argv) {
     auto dossierManager = std::make_shared<DossierManager>();
     dossierManager->updateVideoDevices();
     dossierManager->updateMonitors();
+    dossierManager->setAutoSave("dossier.json");  // Written on its own thread as state changes
+    dossierManager->setPerformanceRate(1.0f);      // Live "performance" section, once a second
+    dossierManager->startStream("dossier.sock");   // Changes as they happen, for local tools
     replInterpreter->setDossierManager(dossierManager);
 
+    // Restore the show from the last session, if one was saved (delete the file to start empty)
+    const std::string snapshotFile = "session.snapshot";
+    if (std::ifstream(snapshotFile).good()) {
+        SessionSnapshot snapshot;
+        std::string error;
+        auto restoreStart = std::chrono::steady_clock::now();
+        if (readSessionSnapshot(snapshotFile, snapshot, error)) {
+            replBuffer->setText(snapshot.program);
+            for (const auto& output : replInterpreter->restoreSnapshot(snapshot)) {
+                consoleBuffer->addOutputLine(output);
+            }
+            double restoreMillis =
+                std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - restoreStart).count();
+            std::string message = "Restored session from " + snapshotFile + " (" +
+                                  std::to_string((int)restoreMillis) + " ms)";
+            consoleBuffer->addOutputLine(message);
+            std::cout << message << "\n";
+        } else {
+            consoleBuffer->addOutputLine("ERROR: " + error);
+            std::cerr << "ERROR: " << error << "\n";
+        }
+    }
+
     // Shell command history
     std::vector<std::string> commandHistory;
     int historyIndex = 0;  // Points to current position in history
 
-    // Helper function to process #import directives in REPL buffer
-    auto processImportDirectives = [&replBuffer]() {
-        bool foundImport = true;
-        while (foundImport) {
-            foundImport = false;
-            const auto& lines = replBuffer->getLines();
-
-            for (size_t i = 0; i < lines.size(); i++) {
-                std::string line = lines[i];
-                // Trim whitespace
-                size_t start = line.find_first_not_of(" \t");
-                if (start == std::string::npos) continue;
-
-                std::string trimmed = line.substr(start);
-
-                // Check for #import directive
-                if (trimmed.find("#import ") == 0) {
-                    std::string presetFile = trimmed.substr(8); // Skip "#import "
-                    // Trim whitespace from preset filename
-                    size_t fileStart = presetFile.find_first_not_of(" \t");
-                    size_t fileEnd = presetFile.find_last_not_of(" \t\r\n");
-                    if (fileStart != std::string::npos && fileEnd != std::string::npos) {
-                        presetFile = presetFile.substr(fileStart, fileEnd - fileStart + 1);
-                    }
-
-                    // Read preset file
-                    std::string presetPath = "../presets/" + presetFile;
-                    std::ifstream inFile(presetPath);
+    // Preset files, cached in memory and re-read only when they change on disk
+    PresetLibrary presets("../presets");
 
-                    if (inFile.is_open()) {
-                        std::string presetContent;
-                        std::string pline;
-                        while (std::getline(inFile, pline)) {
-                            presetContent += pline + "\n";
-                        }
-                        inFile.close();
-
-                        // Replace the #import line with preset content
-                        // Delete the import line
-                        replBuffer->setCursor(i, 0);
-                        replBuffer->deleteLine();
-
-                        // Insert preset content at this position
-                        bool firstLine = true;
-                        for (char c : presetContent) {
-                            if (c == '\n') {
-                                if (!firstLine || i > 0) {
-                                    replBuffer->insertNewline();
-                                }
-                                firstLine = false;
-                            } else {
-                                replBuffer->insertChar(c);
-                            }
-                        }
-
-                        foundImport = true;
-                        std::cout << "Processed #import directive: " << presetFile << "\n";
-                        break; // Restart scan since buffer changed
-                    } else {
-                        std::cerr << "ERROR: Could not open preset file: " << presetPath << "\n";
-                    }
-                }
-            }
+    // Helper function to process #import directives in REPL buffer
+    // Nested imports expand in one pass (each preset once) and land as one edit
+    auto processImportDirectives = [&replBuffer, &presets]() {
+        std::string text = replBuffer->getText();
+        std::string expanded;
+        std::vector<std::string> errors;
+        int imported = presets.expandImports(text, expanded, errors);
+
+        for (const auto& error : errors) {
+            std::cerr << "ERROR: " << error << "\n";
+        }
+        if (imported > 0) {
+            // getText ends every line in '\n'; the buffer's last line has none
+            expanded.pop_back();
+            int lastLine = replBuffer->getLineCount() - 1;
+            replBuffer->replaceRange(0, 0, lastLine, replBuffer->getLines()[lastLine].length(), expanded);
+            std::cout << "Processed " << imported << " #import directive(s)\n";
         }
     };
 
+    // "update dossier.json" device enumeration, on the shared pool
+    TaskGroup deviceScan;
+
     // Setup shell command execution callback
-    auto executeShellCommand = [&shellBuffer, &consoleBuffer, &replBuffer, &dossierBuffer, &replInterpreter, &dossierManager, &commandHistory, &historyIndex, &processImportDirectives](const std::string& command) {
+    auto executeShellCommand = [&shellBuffer, &consoleBuffer, &replBuffer, &dossierBuffer, &replInterpreter, &dossierManager, &commandHistory, &historyIndex, &processImportDirectives, &presets, &deviceScan](const std::string& command) {
         std::cout << "Executing shell command: " << command << "\n";
 
         // Add command to history
@@ -187,54 +197,22 @@ int main(int argc, char** argv) {
             auto& lines = shellBuffer->getLines();
             std::string cmd = lines.back();  // Get command line
 
-            // Insert command into history (before last line)
-            shellBuffer->setCursor(shellBuffer->getLineCount() - 1, 0);
-            shellBuffer->insertChar('>');
-            shellBuffer->insertChar(' ');
-            for (char c : cmd) {
-                shellBuffer->insertChar(c);
-            }
-            shellBuffer->insertNewline();
-
-            // Clear the command line (current last line)
+            // Turn the command line into a history entry and open an empty command line
             int lastLine = shellBuffer->getLineCount() - 1;
-            shellBuffer->setCursor(lastLine, 0);
-            while (shellBuffer->getLineCount() > 0 && !shellBuffer->getLines().back().empty()) {
-                shellBuffer->deleteChar();
-            }
+            shellBuffer->replaceRange(lastLine, 0, lastLine, cmd.length(), "> " + cmd + "\n");
         }
 
         // Parse and execute command
         if (command == "clear console") {
             // Clear console buffer completely
-            while (consoleBuffer->getLineCount() > 1) {
-                consoleBuffer->setCursor(0, 0);
-                consoleBuffer->deleteLine();
-            }
-            // Clear the last remaining line
-            if (consoleBuffer->getLineCount() > 0) {
-                consoleBuffer->setCursor(0, 0);
-                while (!consoleBuffer->getLines()[0].empty()) {
-                    consoleBuffer->deleteChar();
-                }
-            }
+            consoleBuffer->clear();
             std::cout << "Console cleared\n";
         }
         else if (command.find("clear ") == 0) {
             std::string target = command.substr(6);
             if (target == "REPL.txt") {
                 // Clear REPL buffer
-                while (replBuffer->getLineCount() > 1) {
-                    replBuffer->setCursor(0, 0);
-                    replBuffer->deleteLine();
-                }
-                // Clear the last remaining line
-                if (replBuffer->getLineCount() > 0) {
-                    replBuffer->setCursor(0, 0);
-                    while (!replBuffer->getLines()[0].empty()) {
-                        replBuffer->deleteChar();
-                    }
-                }
+                replBuffer->clear();
                 std::cout << "REPL.txt cleared\n";
             }
         }
@@ -245,64 +223,34 @@ int main(int argc, char** argv) {
                 processImportDirectives();
 
                 // Collect all lines from REPL buffer
-                std::string code;
-                const auto& lines = replBuffer->getLines();
-                for (const auto& line : lines) {
-                    code += line + "\n";
-                }
+                std::string code = replBuffer->getText();
 
-                // Execute the code
+                // Compiled and opened off the render thread; applied by the main loop
                 std::cout << "Running REPL code:\n" << code << "\n";
-                auto outputs = replInterpreter->execute(code);
-
-                // Display output in console
-                for (const auto& output : outputs) {
-                    consoleBuffer->addOutputLine(output);
-                }
-
-                std::cout << "Execution complete. " << outputs.size() << " output lines.\n";
+                replInterpreter->submit(code);
             }
         }
         else if (command == "update dossier.json") {
-            // Update device/monitor enumeration
-            dossierManager->updateVideoDevices();
-            dossierManager->updateMonitors();
-
-            // Generate JSON
-            std::string jsonContent = dossierManager->toJSON();
-
-            // Update dossier buffer with JSON content
-            // Clear existing buffer
-            while (dossierBuffer->getLineCount() > 1) {
-                dossierBuffer->setCursor(0, 0);
-                dossierBuffer->deleteLine();
-            }
-            if (dossierBuffer->getLineCount() > 0) {
-                dossierBuffer->setCursor(0, 0);
-                while (!dossierBuffer->getLines()[0].empty()) {
-                    dossierBuffer->deleteChar();
-                }
-            }
-
-            // Add JSON lines to dossier buffer
-            std::istringstream jsonStream(jsonContent);
-            std::string line;
-            bool firstLine = true;
-            while (std::getline(jsonStream, line)) {
-                if (!firstLine) {
-                    dossierBuffer->insertNewline();
-                }
-                firstLine = false;
-                for (char c : line) {
-                    dossierBuffer->insertChar(c);
-                }
-            }
-
-            // Save to file
-            dossierManager->saveToFile("dossier.json");
-
-            consoleBuffer->addOutputLine("Updated dossier.json");
-            std::cout << "Updated dossier.json\n";
+            // Camera enumeration can take a while, so it runs on the pool; monitors
+            // (GLFW) and the buffers are updated on the main thread once it's done
+            auto devices = std::make_shared<std::vector<VideoSource::DeviceInfo>>();
+            deviceScan.run([devices]() { *devices = VideoSource::enumerateDevices(); });
+            deviceScan.then([devices, &dossierManager, &dossierBuffer, &consoleBuffer]() {
+                dossierManager->setVideoDevices(std::move(*devices));
+                dossierManager->updateMonitors();
+
+                // Generate JSON
+                std::string jsonContent = dossierManager->toJSON();
+
+                // Replace dossier buffer with JSON content
+                dossierBuffer->setText(jsonContent);
+
+                // Save to file (queued to the writer thread)
+                dossierManager->saveToFile("dossier.json");
+
+                consoleBuffer->addOutputLine("Updated dossier.json");
+                std::cout << "Updated dossier.json\n";
+            }, true);
         }
         else if (command.find("import ") == 0) {
             // Parse: import REPL.txt <presetfile>
@@ -311,35 +259,17 @@ int main(int argc, char** argv) {
             cmdStream >> targetFile >> presetFile;
 
             if (targetFile == "REPL.txt" && !presetFile.empty()) {
-                // Read preset file from presets directory
-                std::string presetPath = "../presets/" + presetFile;
-                std::ifstream inFile(presetPath);
-
-                if (inFile.is_open()) {
-                    std::string presetContent;
-                    std::string line;
-                    while (std::getline(inFile, line)) {
-                        presetContent += line + "\n";
-                    }
-                    inFile.close();
-
-                    // Append preset content to REPL buffer
-                    // Move cursor to end
-                    if (replBuffer->getLineCount() > 0) {
-                        int lastLine = replBuffer->getLineCount() - 1;
-                        int lastCol = replBuffer->getLines()[lastLine].length();
-                        replBuffer->setCursor(lastLine, lastCol);
-                        replBuffer->insertNewline();
-                    }
-
-                    // Insert preset content
-                    for (char c : presetContent) {
-                        if (c == '\n') {
-                            replBuffer->insertNewline();
-                        } else {
-                            replBuffer->insertChar(c);
-                        }
-                    }
+                // Read preset file from presets directory (cached)
+                const std::string* presetContent = presets.load(presetFile);
+                std::string presetPath = presets.getDirectory() + "/" + presetFile;
+
+                if (presetContent) {
+                    // Append preset content to REPL buffer on a new line
+                    int lastLine = replBuffer->getLineCount() - 1;
+                    int lastCol = replBuffer->getLines()[lastLine].length();
+                    std::string content = "\n" + *presetContent;
+                    if (content.back() != '\n') content += '\n';
+                    replBuffer->insertText(lastLine, lastCol, content);
 
                     // Process any #import directives in the buffer
                     processImportDirectives();
@@ -355,6 +285,32 @@ int main(int argc, char** argv) {
                 std::cout << "ERROR: Invalid import command. Usage: import REPL.txt <presetfile>\n";
             }
         }
+        else if (command.find("perf ") == 0) {
+            // Parse: perf <hz> -- dossier.json performance section refresh rate (0 = off)
+            float hz = -1.0f;
+            try {
+                hz = std::stof(command.substr(5));
+            } catch (const std::exception&) {
+            }
+            if (hz >= 0.0f) {
+                dossierManager->setPerformanceRate(hz);
+                std::string message = hz > 0.0f ? "Performance section refreshes at " + command.substr(5) + " Hz"
+                                                : "Performance section off";
+                consoleBuffer->addOutputLine(message);
+                std::cout << message << "\n";
+            } else {
+                consoleBuffer->addOutputLine("ERROR: Invalid perf command. Usage: perf <hz>");
+                std::cout << "ERROR: Invalid perf command. Usage: perf <hz>\n";
+            }
+        }
+        else if (command == "glstats") {
+            // GL calls issued by the renderer/compositor last frame, and binds the state cache skipped
+            const GLState& state = GLState::get();
+            std::string stats = "GL calls last frame: " + std::to_string(state.getCallsLastFrame()) +
+                                " (" + std::to_string(state.getSkippedLastFrame()) + " redundant skipped)";
+            consoleBuffer->addOutputLine(stats);
+            std::cout << stats << "\n";
+        }
         else {
             consoleBuffer->addOutputLine("Unknown command: " + command);
             std::cout << "Unknown command: " << command << "\n";
@@ -400,14 +356,36 @@ int main(int argc, char** argv) {
     std::cout << "  Alt+Space, then [ - Enter copy mode (scroll with hjkl)\n";
     std::cout << "  Vim modes: i (insert), ESC (normal), hjkl (move), x (delete), dd (delete line)\n";
 
-    // Helper function to render text buffer content
+    // Text window layout (shared by drawing and the visible line count)
+    const int charPixelWidth = 6 * 4;
+    const int lineHeight = 7 * 4;
+    const int lineSpacing = 16;  // Increased spacing between lines
+
+    // First buffer line an editor or console window shows: the COPY-mode scroll
+    // position, else the top for editors; the console follows its newest output
+    auto textWindowStartLine = [](TextBuffer* buffer, const std::string& windowType, int maxVisibleLines) {
+        if (buffer->getMode() == VimMode::COPY) return buffer->getScrollOffset();
+        if (windowType != "console") return 0;
+        return std::max(0, buffer->getLineCount() - maxVisibleLines);
+    };
+
+    // Helper function to draw a text window: background, border, buffer content
     // windowType: "editor" (dossier/REPL), "console", "shell"
-    auto renderTextWindow = [&](const Rect& rect, TextBuffer* buffer, const std::string& title, bool isActive, const std::string& windowType) {
-        const int charPixelWidth = 6 * 4;
-        const int lineHeight = 7 * 4;
-        const int lineSpacing = 16;  // Increased spacing between lines
+    auto drawTextWindow = [&](const Rect& rect, TextBuffer* buffer, const std::string& title, bool isActive, const std::string& windowType) {
         const int lineNumWidth = (windowType == "editor") ? 60 : 0;
 
+        // Editors get a lighter background than shell/console
+        if (windowType == "editor") {
+            renderer->drawRect(rect, 0.15f, 0.15f, 0.17f, 1.0f);
+        } else {
+            renderer->drawRect(rect, 0.05f, 0.05f, 0.07f, 1.0f);
+        }
+        if (isActive) {
+            renderer->drawBorder(rect, 0.2f, 0.6f, 0.9f, 1.0f, 3);
+        } else {
+            renderer->drawBorder(rect, 0.3f, 0.3f, 0.35f, 1.0f, 2);
+        }
+
         // Draw title
         renderer->drawText(title, rect.x + 5, rect.y + rect.height - 20, 0.7f, 0.7f, 0.7f);
 
@@ -421,9 +399,6 @@ int main(int argc, char** argv) {
         int availableHeight = rect.height - 60; // Leave space for title and mode
         int maxVisibleLines = availableHeight / (lineHeight + lineSpacing);
 
-        // Update buffer with visible line count for auto-scrolling
-        buffer->setVisibleLines(maxVisibleLines);
-
         if (windowType == "shell") {
             // Shell: show history above, command line at bottom
             // Last line is the command line, everything else is history
@@ -462,7 +437,7 @@ int main(int argc, char** argv) {
             }
         } else {
             // Editor or Console: normal rendering
-            int startLine = (buffer->getMode() == VimMode::COPY) ? scrollOffset : 0;
+            int startLine = textWindowStartLine(buffer, windowType, maxVisibleLines);
             int endLine = std::min((int)lines.size(), startLine + maxVisibleLines);
 
             for (int i = startLine; i < endLine; i++) {
@@ -513,8 +488,200 @@ int main(int argc, char** argv) {
         }
     };
 
+    // Each text window is drawn into its own texture, redrawn only when the
+    // buffer revision, cursor, mode, scroll (or console follow position), focus or
+    // window size changes
+    struct TextWindowCache {
+        std::unique_ptr<DisplayBuffer> target;
+        uint64_t revision = 0;
+        int cursorRow = -1;
+        int cursorCol = -1;
+        int scrollOffset = -1;
+        int startLine = -1;
+        VimMode mode = VimMode::NORMAL;
+        bool isActive = false;
+    };
+    std::map<TextBuffer*, TextWindowCache> textWindowCaches;
+
+    auto renderTextWindow = [&](const Rect& rect, TextBuffer* buffer, const std::string& title, bool isActive, const std::string& windowType) {
+        if (rect.width <= 0 || rect.height <= 0) return;
+
+        // Update buffer with visible line count for auto-scrolling
+        int availableHeight = rect.height - 60; // Leave space for title and mode
+        int maxVisibleLines = availableHeight / (lineHeight + lineSpacing);
+        buffer->setVisibleLines(maxVisibleLines);
+        int startLine = textWindowStartLine(buffer, windowType, maxVisibleLines);
+
+        TextWindowCache& cache = textWindowCaches[buffer];
+        bool resized = !cache.target || cache.target->getWidth() != rect.width ||
+                       cache.target->getHeight() != rect.height;
+        if (resized) {
+            cache.target = std::make_unique<DisplayBuffer>(rect.width, rect.height);
+            if (!cache.target->init()) {
+                // No offscreen target: draw straight into the frame
+                cache.target.reset();
+                drawTextWindow(rect, buffer, title, isActive, windowType);
+                return;
+            }
+        }
+
+        bool stale = resized ||
+                     cache.revision != buffer->getRevision() ||
+                     cache.cursorRow != buffer->getCursorRow() ||
+                     cache.cursorCol != buffer->getCursorCol() ||
+                     cache.scrollOffset != buffer->getScrollOffset() ||
+                     cache.startLine != startLine ||
+                     cache.mode != buffer->getMode() ||
+                     cache.isActive != isActive;
+        if (stale) {
+            cache.revision = buffer->getRevision();
+            cache.cursorRow = buffer->getCursorRow();
+            cache.cursorCol = buffer->getCursorCol();
+            cache.scrollOffset = buffer->getScrollOffset();
+            cache.startLine = startLine;
+            cache.mode = buffer->getMode();
+            cache.isActive = isActive;
+
+            renderer->beginTarget(*cache.target, rect);
+            drawTextWindow(rect, buffer, title, isActive, windowType);
+            renderer->endTarget();
+        }
+
+        renderer->drawTexture(cache.target->getTexture(), rect);
+    };
+
+    // Presentation windows: one per out_var whose target is a physical monitor
+    std::map<std::string, std::unique_ptr<PresentationWindow>> presentationWindows;
+
+    // Out_vars whose window failed to open (or would cover the editor), with the
+    // target and monitor layout at the time: not retried until one of them changes
+    // (else it would fail every frame)
+    struct FailedPresentation {
+        std::string target;
+        std::string monitors;
+    };
+    std::map<std::string, FailedPresentation> failedPresentations;
+    auto monitorListKey = [&](int editorMonitor) {
+        std::string key;
+        for (const auto& monitor : dossierManager->getMonitors()) {
+            key += monitor.name + " " + std::to_string(monitor.width) + "x" + std::to_string(monitor.height) + ";";
+        }
+        return key + "editor " + std::to_string(editorMonitor);
+    };
+
+    auto syncPresentationWindows = [&]() {
+        // A show window is fullscreen and on top: never put one over the editor
+        int editorMonitor = windowMgr->getMonitorIndex();
+
+        // Close windows whose out_var is gone or no longer targets the same monitor,
+        // and any the editor has been moved onto
+        for (auto it = presentationWindows.begin(); it != presentationWindows.end();) {
+            auto output = replInterpreter->getOutputVariable(it->first);
+            int monitorIndex = output ? dossierManager->findPhysicalMonitor(output->getTarget()) : -1;
+            if (monitorIndex != it->second->getMonitorIndex() || monitorIndex == editorMonitor) {
+                it = presentationWindows.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        // Open windows for newly mapped outputs
+        for (const auto& [name, output] : replInterpreter->getOutputVariables()) {
+            if (!output || presentationWindows.count(name)) continue;
+            int monitorIndex = dossierManager->findPhysicalMonitor(output->getTarget());
+            if (monitorIndex < 0) continue;
+
+            std::string monitors = monitorListKey(editorMonitor);
+            auto failed = failedPresentations.find(name);
+            if (failed != failedPresentations.end()) {
+                if (failed->second.target == output->getTarget() && failed->second.monitors == monitors) continue;
+                failedPresentations.erase(failed);
+            }
+
+            if (monitorIndex == editorMonitor) {
+                failedPresentations[name] = {output->getTarget(), monitors};
+                std::cerr << "ERROR: out_var " << name << " targets monitor " << monitorIndex
+                          << ", which shows the editor; no presentation window until one of them moves\n";
+                continue;
+            }
+
+            auto window = std::make_unique<PresentationWindow>(name, monitorIndex);
+            if (window->init(windowMgr->getWindow())) {
+                presentationWindows[name] = std::move(window);
+            } else {
+                failedPresentations[name] = {output->getTarget(), monitors};
+                std::cerr << "ERROR: No presentation window for " << name
+                          << " until its target or the monitors change\n";
+            }
+        }
+
+        // One show window owns vsync (present() swaps them back to back, so each
+        // vsynced window would cost a vblank); the rest and the editor swap unthrottled
+        bool first = true;
+        for (auto& [name, window] : presentationWindows) {
+            window->setSwapInterval(first ? 1 : 0);
+            first = false;
+        }
+        windowMgr->setSwapInterval(presentationWindows.empty() ? 1 : 0);
+    };
+
+    // GPU memory in use, where the driver reports it (GL_NVX_gpu_memory_info)
+    // Checked once: querying the enums without the extension would leave a
+    // GL_INVALID_ENUM for the next glGetError to trip over. -1 means unknown.
+    const GLenum GPU_MEMORY_TOTAL_NVX = 0x9048;
+    const GLenum GPU_MEMORY_AVAILABLE_NVX = 0x9049;
+    bool hasGpuMemoryInfo = false;
+    GLint extensionCount = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+    for (GLint i = 0; i < extensionCount && !hasGpuMemoryInfo; i++) {
+        const GLubyte* extension = glGetStringi(GL_EXTENSIONS, (GLuint)i);
+        hasGpuMemoryInfo = extension && std::string((const char*)extension) == "GL_NVX_gpu_memory_info";
+    }
+    auto queryGpuMemory = [&]() -> int64_t {
+        if (!hasGpuMemoryInfo) return -1;
+        GLint totalKB = -1;
+        GLint availableKB = -1;
+        glGetIntegerv(GPU_MEMORY_TOTAL_NVX, &totalKB);
+        glGetIntegerv(GPU_MEMORY_AVAILABLE_NVX, &availableKB);
+        if (totalKB < 0 || availableKB < 0) return -1;
+        return (int64_t)(totalKB - availableKB) * 1024;
+    };
+
+    // Frame timing for the dossier's performance section
+    using Clock = std::chrono::steady_clock;
+    auto lastFrameStart = Clock::now();
+    auto lastGpuMemoryQuery = lastFrameStart - std::chrono::seconds(1);
+
+    // Video work in flight: the GPU may still be uploading and compositing the
+    // last frame while the CPU draws the editor and takes input. If it hasn't
+    // caught up when the next frame's video work is due, that work is skipped
+    // (outputs keep their last composite, sources keep only their newest frame)
+    // instead of the whole loop stalling behind a slow GPU.
+    GLsync videoFence = nullptr;
+
+    // Session snapshot after each applied run, once a frame has sized everything
+    bool snapshotDue = false;
+    auto saveSnapshot = [&]() {
+        SessionSnapshot snapshot;
+        replInterpreter->captureSnapshot(snapshot);
+        dossierManager->saveSnapshot(snapshotFile, std::move(snapshot));
+    };
+
+    // Idle mode: with nothing animating or pending, the loop sleeps in
+    // glfwWaitEventsTimeout instead of redrawing every vsync. Input, a camera
+    // frame or a pool result for this thread wakes it for one frame; the timeout
+    // keeps a slow heartbeat for anything else.
+    const double IDLE_WAIT_SECONDS = 0.25;
+    VideoSource::setFrameWakeup(glfwPostEmptyEvent);
+    ThreadPool::shared().setMainThreadWakeup(glfwPostEmptyEvent);
+    bool loopIdle = false;
+
     // Main loop
     while (!windowMgr->shouldClose()) {
+        auto frameStart = Clock::now();
+        float frameMillis = std::chrono::duration<float, std::milli>(frameStart - lastFrameStart).count();
+        lastFrameStart = frameStart;
+
         // Update layout based on current tab
         int fbWidth, fbHeight;
         windowMgr->getFramebufferSize(&fbWidth, &fbHeight);
@@ -528,13 +695,55 @@ int main(int argc, char** argv) {
             layoutMgr->updateTab4(fbWidth, fbHeight);  // Tab 4: centered monitor2
         }
 
+        // Apply a finished run between frames, so the output never shows half a program
+        std::vector<std::string> runOutputs;
+        if (replInterpreter->applyPendingRun(runOutputs)) {
+            for (const auto& output : runOutputs) {
+                consoleBuffer->addOutputLine(output);
+            }
+            std::cout << "Execution complete. " << runOutputs.size() << " output lines.\n";
+            snapshotDue = true;
+        }
+
+        // Results of pool jobs that have to land on this thread (GL, buffers)
+        ThreadPool::shared().runMainThreadTasks();
+
         // Execute video pipeline (fetch frames and composite outputs)
-        replInterpreter->executeVideoPipeline();
+        bool gpuBehind = false;
+        if (videoFence) {
+            gpuBehind = glClientWaitSync(videoFence, 0, 0) == GL_TIMEOUT_EXPIRED;
+            if (!gpuBehind) {
+                glDeleteSync(videoFence);
+                videoFence = nullptr;
+            }
+        }
+        if (gpuBehind) {
+            dossierManager->recordSkippedVideoFrame();
+        } else {
+            replInterpreter->executeVideoPipeline();
+            videoFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            if (snapshotDue) {
+                saveSnapshot();
+                snapshotDue = false;
+            }
+        }
+
+        // Present composites on physical monitors before spending time on the editor UI
+        syncPresentationWindows();
+        if (!presentationWindows.empty()) {
+            glFlush();  // Make composite writes visible to the shared contexts
+            for (auto& [name, window] : presentationWindows) {
+                auto output = replInterpreter->getOutputVariable(name);
+                window->present(output ? output->getOutputTexture() : 0);
+            }
+        }
 
         // Process input
         inputHandler->processInput(windowMgr->getWindow());
+        auto uiStart = Clock::now();
 
-        // Clear screen
+        // Restore the editor viewport (compositing changes it) and clear screen
+        renderer->setViewport(0, 0, fbWidth, fbHeight);
         renderer->clear(0.1f, 0.1f, 0.12f, 1.0f);
 
         // Get active window for highlighting
@@ -569,39 +778,15 @@ int main(int argc, char** argv) {
             renderer->drawText("monitor2", mobileRect.x + 5, mobileRect.y + mobileRect.height - 20, 0.5f, 0.5f, 0.5f);
 
             // Dossier editor (window 0)
-            renderer->drawRect(dossierRect, 0.15f, 0.15f, 0.17f, 1.0f);
-            if (activeWindow == 0) {
-                renderer->drawBorder(dossierRect, 0.2f, 0.6f, 0.9f, 1.0f, 3);
-            } else {
-                renderer->drawBorder(dossierRect, 0.3f, 0.3f, 0.35f, 1.0f, 2);
-            }
             renderTextWindow(dossierRect, dossierBuffer.get(), "dossier.json", activeWindow == 0, "editor");
 
             // REPL editor (window 1)
-            renderer->drawRect(replRect, 0.15f, 0.15f, 0.17f, 1.0f);
-            if (activeWindow == 1) {
-                renderer->drawBorder(replRect, 0.2f, 0.6f, 0.9f, 1.0f, 3);
-            } else {
-                renderer->drawBorder(replRect, 0.3f, 0.3f, 0.35f, 1.0f, 2);
-            }
             renderTextWindow(replRect, replBuffer.get(), "REPL.txt", activeWindow == 1, "editor");
 
             // Shell window (window 2)
-            renderer->drawRect(shellRect, 0.05f, 0.05f, 0.07f, 1.0f);
-            if (activeWindow == 2) {
-                renderer->drawBorder(shellRect, 0.2f, 0.6f, 0.9f, 1.0f, 3);
-            } else {
-                renderer->drawBorder(shellRect, 0.3f, 0.3f, 0.35f, 1.0f, 2);
-            }
             renderTextWindow(shellRect, shellBuffer.get(), "shell", activeWindow == 2, "shell");
 
             // Console window (window 3)
-            renderer->drawRect(consoleRect, 0.05f, 0.05f, 0.07f, 1.0f);
-            if (activeWindow == 3) {
-                renderer->drawBorder(consoleRect, 0.2f, 0.6f, 0.9f, 1.0f, 3);
-            } else {
-                renderer->drawBorder(consoleRect, 0.3f, 0.3f, 0.35f, 1.0f, 2);
-            }
             renderTextWindow(consoleRect, consoleBuffer.get(), "console", activeWindow == 3, "console");
 
         } else if (currentTab == 1) {
@@ -611,30 +796,12 @@ int main(int argc, char** argv) {
             Rect consoleRect = layoutMgr->getTab2ConsoleRect();
 
             // REPL editor (window 1) - full width, top half
-            renderer->drawRect(replRect, 0.15f, 0.15f, 0.17f, 1.0f);
-            if (activeWindow == 1) {
-                renderer->drawBorder(replRect, 0.2f, 0.6f, 0.9f, 1.0f, 3);
-            } else {
-                renderer->drawBorder(replRect, 0.3f, 0.3f, 0.35f, 1.0f, 2);
-            }
             renderTextWindow(replRect, replBuffer.get(), "REPL.txt", activeWindow == 1, "editor");
 
             // Console window (window 3) - full width, 3rd quarter
-            renderer->drawRect(consoleRect, 0.05f, 0.05f, 0.07f, 1.0f);
-            if (activeWindow == 3) {
-                renderer->drawBorder(consoleRect, 0.2f, 0.6f, 0.9f, 1.0f, 3);
-            } else {
-                renderer->drawBorder(consoleRect, 0.3f, 0.3f, 0.35f, 1.0f, 2);
-            }
             renderTextWindow(consoleRect, consoleBuffer.get(), "console", activeWindow == 3, "console");
 
             // Shell window (window 2) - full width, bottom quarter
-            renderer->drawRect(shellRect, 0.05f, 0.05f, 0.07f, 1.0f);
-            if (activeWindow == 2) {
-                renderer->drawBorder(shellRect, 0.2f, 0.6f, 0.9f, 1.0f, 3);
-            } else {
-                renderer->drawBorder(shellRect, 0.3f, 0.3f, 0.35f, 1.0f, 2);
-            }
             renderTextWindow(shellRect, shellBuffer.get(), "shell", activeWindow == 2, "shell");
         } else if (currentTab == 2) {
             // TAB 3: Fullscreen monitor1 display (1920x1080 aspect ratio)
@@ -668,10 +835,42 @@ int main(int argc, char** argv) {
         // "Tab X" is 5 characters = 120 pixels + 10 padding
         renderer->drawText(tabIndicator, fbWidth - 130, fbHeight - 30, 0.5f, 0.8f, 0.5f);
 
-        // Swap buffers and poll events
+        // Draw batched text, then swap buffers and poll events
+        renderer->flush();
+        GLState::get().endFrame();
+        dossierManager->recordFrame(frameMillis,
+                                    std::chrono::duration<float, std::milli>(Clock::now() - uiStart).count());
+        if (frameStart - lastGpuMemoryQuery >= std::chrono::seconds(1)) {
+            dossierManager->recordGpuMemory(queryGpuMemory());
+            lastGpuMemoryQuery = frameStart;
+        }
         windowMgr->swapBuffers();
-        windowMgr->pollEvents();
+
+        // Dirty: animated bindings, a run still preparing, video work the GPU
+        // made us skip, or a snapshot waiting for the pipeline
+        bool dirty = replInterpreter->getBindingCount() > 0 || replInterpreter->isRunPending() ||
+                     gpuBehind || snapshotDue;
+        if (dirty == loopIdle) {
+            loopIdle = !dirty;
+            dossierManager->recordLoopIdle(loopIdle);
+        }
+        if (loopIdle) {
+            windowMgr->waitEvents(IDLE_WAIT_SECONDS);
+            lastFrameStart = Clock::now();  // Time asleep isn't frame time
+        } else {
+            windowMgr->pollEvents();
+        }
+    }
+
+    VideoSource::setFrameWakeup(nullptr);
+    ThreadPool::shared().setMainThreadWakeup(nullptr);
+
+    saveSnapshot();  // Sizes may have changed since the last run (written by the dossier's destructor)
+    if (videoFence) {
+        glDeleteSync(videoFence);
     }
+    presentationWindows.clear();
+    textWindowCaches.clear();
 
     std::cout << "Shutting down...\n";
     return 0;
@@ -1,15 +1,19 @@
 #include "output_variable.h"
+#include "gl_state.h"
 #include <algorithm>
+#include <chrono>
 #include <iostream>
 
 OutputVariable::OutputVariable(const std::string& name, const std::string& target)
     : name(name),
       target(target),
+      stackSorted(true),
       outputFramebuffer(0),
       outputTexture(0),
       outputDepthBuffer(0),
       outputWidth(0),
-      outputHeight(0) {
+      outputHeight(0),
+      compositeMillis(0.0f) {
 }
 
 OutputVariable::~OutputVariable() {
@@ -27,7 +31,7 @@ void OutputVariable::project(std::shared_ptr<Layer> layer, int zIndex) {
         if (entry.layer == layer) {
             // Update z-index
             entry.zIndex = zIndex;
-            sortLayerStack();
+            stackSorted = false;
             std::cout << "Updated layer '" << layer->getName() << "' z-index to "
                       << zIndex << " on " << name << "\n";
             return;
@@ -39,7 +43,7 @@ void OutputVariable::project(std::shared_ptr<Layer> layer, int zIndex) {
     entry.layer = layer;
     entry.zIndex = zIndex;
     layerStack.push_back(entry);
-    sortLayerStack();
+    stackSorted = false;
 
     std::cout << "Projected layer '" << layer->getName() << "' onto " << name
               << " at z-index " << zIndex << "\n";
@@ -62,12 +66,15 @@ void OutputVariable::clearLayers() {
     std::cout << "Cleared all layers from " << name << "\n";
 }
 
-void OutputVariable::sortLayerStack() {
+void OutputVariable::sortLayerStack() const {
+    if (stackSorted) return;
     // Sort by z-index: higher z-index first (back-to-front rendering)
-    std::sort(layerStack.begin(), layerStack.end());
+    std::stable_sort(layerStack.begin(), layerStack.end());
+    stackSorted = true;
 }
 
 void OutputVariable::executeLayers() {
+    sortLayerStack();
     // Execute all layers (fetch frames and update textures)
     for (auto& entry : layerStack) {
         if (entry.layer) {
@@ -77,6 +84,8 @@ void OutputVariable::executeLayers() {
 }
 
 void OutputVariable::composite(int parentW, int parentH) {
+    auto compositeStart = std::chrono::steady_clock::now();
+
     // Initialize or resize output framebuffer if needed
     if (outputFramebuffer == 0 || outputWidth != parentW || outputHeight != parentH) {
         if (outputFramebuffer != 0) {
@@ -96,8 +105,8 @@ void OutputVariable::composite(int parentW, int parentH) {
     glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    // Enable alpha blending
-    glEnable(GL_BLEND);
+    // Enable alpha blending (through the state cache the editor renderer relies on)
+    GLState::get().setBlend(true);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
     // Render layers back-to-front (already sorted)
@@ -123,10 +132,22 @@ void OutputVariable::composite(int parentW, int parentH) {
         }
     }
 
-    glDisable(GL_BLEND);
+    GLState::get().setBlend(false);
 
     // Unbind framebuffer
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    compositeMillis.store(std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - compositeStart).count(),
+                          std::memory_order_relaxed);
+}
+
+void OutputVariable::prepare(int width, int height) {
+    if (width <= 0 || height <= 0) return;
+    if (outputFramebuffer != 0 && outputWidth == width && outputHeight == height) return;
+    if (outputFramebuffer != 0) {
+        cleanupOutputFramebuffer();
+    }
+    initOutputFramebuffer(width, height);
 }
 
 void OutputVariable::initOutputFramebuffer(int width, int height) {
@@ -0,0 +1,217 @@
+#include "presentation_window.h"
+#include <iostream>
+
+// OpenGL constants missing from minimal GLAD loader
+#ifndef GL_TEXTURE0
+#define GL_TEXTURE0 0x84C0
+#endif
+
+// Fullscreen quad shaders (positions already in NDC)
+static const char* presentVertexShaderSource = R"(
+#version 330 core
+layout (location = 0) in vec2 aPos;
+layout (location = 1) in vec2 aTexCoord;
+
+out vec2 TexCoord;
+
+void main() {
+    gl_Position = vec4(aPos, 0.0, 1.0);
+    TexCoord = aTexCoord;
+}
+)";
+
+static const char* presentFragmentShaderSource = R"(
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoord;
+
+uniform sampler2D uTexture;
+
+void main() {
+    FragColor = vec4(texture(uTexture, TexCoord).rgb, 1.0);
+}
+)";
+
+static GLuint compilePresentShader(const char* source, GLenum shaderType) {
+    GLuint shader = glCreateShader(shaderType);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+
+    GLint success;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        char infoLog[512];
+        glGetShaderInfoLog(shader, 512, nullptr, infoLog);
+        std::cerr << "Presentation shader compilation failed:\n" << infoLog << "\n";
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+PresentationWindow::PresentationWindow(const std::string& outputName, int monitorIndex)
+    : outputName(outputName), monitorIndex(monitorIndex), width(0), height(0),
+      swapInterval(1), window(nullptr), shaderProgram(0), VAO(0), VBO(0) {
+}
+
+PresentationWindow::~PresentationWindow() {
+    if (!window) return;
+
+    GLFWwindow* previous = glfwGetCurrentContext();
+    glfwMakeContextCurrent(window);
+    if (VAO) glDeleteVertexArrays(1, &VAO);
+    if (VBO) glDeleteBuffers(1, &VBO);
+    if (shaderProgram) glDeleteProgram(shaderProgram);
+    glfwMakeContextCurrent(previous != window ? previous : nullptr);
+
+    glfwDestroyWindow(window);
+    std::cout << "Closed presentation window for " << outputName << "\n";
+}
+
+bool PresentationWindow::init(GLFWwindow* shareContext) {
+    int count = 0;
+    GLFWmonitor** monitors = glfwGetMonitors(&count);
+    if (monitorIndex < 0 || monitorIndex >= count) {
+        std::cerr << "ERROR: Monitor index " << monitorIndex << " out of range for " << outputName << "\n";
+        return false;
+    }
+
+    GLFWmonitor* monitor = monitors[monitorIndex];
+    const GLFWvidmode* mode = glfwGetVideoMode(monitor);
+    if (!mode) {
+        std::cerr << "ERROR: No video mode for monitor " << monitorIndex << "\n";
+        return false;
+    }
+
+    int monitorX, monitorY;
+    glfwGetMonitorPos(monitor, &monitorX, &monitorY);
+    width = mode->width;
+    height = mode->height;
+
+    // Borderless windowed fullscreen: no mode switch, no focus stealing from the editor
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+    glfwWindowHint(GLFW_DECORATED, GLFW_FALSE);
+    glfwWindowHint(GLFW_FLOATING, GLFW_TRUE);
+    glfwWindowHint(GLFW_AUTO_ICONIFY, GLFW_FALSE);
+    glfwWindowHint(GLFW_FOCUS_ON_SHOW, GLFW_FALSE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    window = glfwCreateWindow(width, height, outputName.c_str(), nullptr, shareContext);
+    glfwDefaultWindowHints();
+
+    if (!window) {
+        std::cerr << "ERROR: Failed to create presentation window for " << outputName << "\n";
+        return false;
+    }
+
+    glfwSetWindowPos(window, monitorX, monitorY);
+    glfwShowWindow(window);
+
+    GLFWwindow* previous = glfwGetCurrentContext();
+    glfwMakeContextCurrent(window);
+    glfwSwapInterval(swapInterval);
+    bool ok = initQuad();
+    glfwMakeContextCurrent(previous);
+
+    std::cout << "Opened presentation window for " << outputName << " on monitor "
+              << monitorIndex << " (" << width << "x" << height << ")\n";
+    return ok;
+}
+
+bool PresentationWindow::initQuad() {
+    GLuint vertexShader = compilePresentShader(presentVertexShaderSource, GL_VERTEX_SHADER);
+    GLuint fragmentShader = compilePresentShader(presentFragmentShaderSource, GL_FRAGMENT_SHADER);
+    if (vertexShader == 0 || fragmentShader == 0) {
+        if (vertexShader) glDeleteShader(vertexShader);
+        if (fragmentShader) glDeleteShader(fragmentShader);
+        return false;
+    }
+
+    shaderProgram = glCreateProgram();
+    glAttachShader(shaderProgram, vertexShader);
+    glAttachShader(shaderProgram, fragmentShader);
+    glLinkProgram(shaderProgram);
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+
+    GLint success;
+    glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
+    if (!success) {
+        char infoLog[512];
+        glGetProgramInfoLog(shaderProgram, 512, nullptr, infoLog);
+        std::cerr << "Presentation shader linking failed:\n" << infoLog << "\n";
+        return false;
+    }
+
+    // Static fullscreen quad (x, y, u, v)
+    float vertices[] = {
+        -1.0f, -1.0f, 0.0f, 0.0f,
+         1.0f, -1.0f, 1.0f, 0.0f,
+         1.0f,  1.0f, 1.0f, 1.0f,
+        -1.0f, -1.0f, 0.0f, 0.0f,
+         1.0f,  1.0f, 1.0f, 1.0f,
+        -1.0f,  1.0f, 0.0f, 1.0f
+    };
+
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO);
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+
+    glUseProgram(shaderProgram);
+    glUniform1i(glGetUniformLocation(shaderProgram, "uTexture"), 0);
+    glUseProgram(0);
+
+    return true;
+}
+
+void PresentationWindow::setSwapInterval(int interval) {
+    if (interval == swapInterval) return;
+    swapInterval = interval;
+    if (!window) return;
+
+    GLFWwindow* previous = glfwGetCurrentContext();
+    glfwMakeContextCurrent(window);
+    glfwSwapInterval(swapInterval);
+    glfwMakeContextCurrent(previous);
+}
+
+void PresentationWindow::present(GLuint texture) {
+    if (!window) return;
+
+    GLFWwindow* previous = glfwGetCurrentContext();
+    glfwMakeContextCurrent(window);
+
+    int fbWidth, fbHeight;
+    glfwGetFramebufferSize(window, &fbWidth, &fbHeight);
+    glViewport(0, 0, fbWidth, fbHeight);
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    if (texture != 0) {
+        glUseProgram(shaderProgram);
+        glBindVertexArray(VAO);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glDrawArrays(GL_TRIANGLES, 0, 6);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glBindVertexArray(0);
+        glUseProgram(0);
+    }
+
+    glfwSwapBuffers(window);
+    glfwMakeContextCurrent(previous);
+}
@@ -0,0 +1,173 @@
+#include "preset_library.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+std::string parseImportLine(const std::string& line) {
+    size_t start = line.find_first_not_of(" \t");
+    if (start == std::string::npos || line.compare(start, 8, "#import ") != 0) return "";
+    size_t nameStart = line.find_first_not_of(" \t", start + 8);
+    size_t nameEnd = line.find_last_not_of(" \t\r\n");
+    if (nameStart == std::string::npos || nameEnd < nameStart) return "";
+    return line.substr(nameStart, nameEnd - nameStart + 1);
+}
+
+PresetLibrary::PresetLibrary(const std::string& directory)
+    : directory(directory)
+    , watchFd(-1)
+    , reads(0)
+    , hits(0) {
+#ifdef __linux__
+    watchFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (watchFd >= 0 &&
+        inotify_add_watch(watchFd, directory.c_str(),
+                          IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE) < 0) {
+        // No directory yet (or no watches left): check mtimes instead
+        close(watchFd);
+        watchFd = -1;
+    }
+#endif
+}
+
+PresetLibrary::~PresetLibrary() {
+#ifdef __linux__
+    if (watchFd >= 0) close(watchFd);
+#endif
+}
+
+void PresetLibrary::drainEvents() {
+#ifdef __linux__
+    alignas(struct inotify_event) char buffer[4096];
+    for (;;) {
+        ssize_t length = read(watchFd, buffer, sizeof(buffer));
+        if (length <= 0) break;  // EAGAIN: nothing pending
+
+        for (ssize_t offset = 0; offset < length;) {
+            const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(buffer + offset);
+            if (event->mask & IN_Q_OVERFLOW) {
+                for (auto& entry : entries) entry.second.stale = true;
+            } else if (event->len > 0) {
+                auto it = entries.find(event->name);
+                if (it != entries.end()) it->second.stale = true;
+            }
+            offset += sizeof(struct inotify_event) + event->len;
+        }
+    }
+#endif
+}
+
+const std::string* PresetLibrary::load(const std::string& name) {
+    std::string path = directory + "/" + name;
+    auto it = entries.find(name);
+
+    if (watchFd >= 0) {
+        drainEvents();
+        if (it != entries.end() && !it->second.stale) {
+            hits++;
+            return &it->second.contents;
+        }
+    }
+
+    std::error_code error;
+    int64_t size = (int64_t)std::filesystem::file_size(path, error);
+    if (error) {
+        if (it != entries.end()) entries.erase(it);
+        return nullptr;
+    }
+    int64_t mtime = (int64_t)std::filesystem::last_write_time(path, error).time_since_epoch().count();
+
+    if (watchFd < 0 && it != entries.end() && !it->second.stale &&
+        it->second.mtime == mtime && it->second.size == size) {
+        hits++;
+        return &it->second.contents;
+    }
+
+    std::ifstream inFile(path, std::ios::binary);
+    if (!inFile.is_open()) {
+        if (it != entries.end()) entries.erase(it);
+        return nullptr;
+    }
+
+    Entry& entry = entries[name];
+    entry.contents.assign(std::istreambuf_iterator<char>(inFile), std::istreambuf_iterator<char>());
+    entry.mtime = mtime;
+    entry.size = size;
+    entry.stale = false;
+    reads++;
+    return &entry.contents;
+}
+
+int PresetLibrary::expandImports(const std::string& text, std::string& out, std::vector<std::string>& errors) {
+    std::map<std::string, std::pair<size_t, size_t>> expanded;
+    std::vector<std::string> stack;
+    out.clear();
+    out.reserve(text.size());
+    return expandInto(text, out, expanded, stack, errors);
+}
+
+int PresetLibrary::expandInto(const std::string& text, std::string& out,
+                              std::map<std::string, std::pair<size_t, size_t>>& expanded,
+                              std::vector<std::string>& stack, std::vector<std::string>& errors) {
+    int replaced = 0;
+    std::string line;
+
+    for (size_t start = 0; start < text.size();) {
+        size_t end = text.find('\n', start);
+        size_t lineEnd = end == std::string::npos ? text.size() : end;
+
+        // Cheap reject before copying the line: imports start with '#'
+        size_t first = text.find_first_not_of(" \t", start);
+        std::string name;
+        if (first < lineEnd && text[first] == '#') {
+            line.assign(text, start, lineEnd - start);
+            name = parseImportLine(line);
+        }
+
+        bool imported = false;
+        if (!name.empty()) {
+            auto done = expanded.find(name);
+            if (done != expanded.end()) {
+                // Expanded earlier in this call: copy that stretch of out
+                out.reserve(out.size() + done->second.second);
+                out.append(out.data() + done->second.first, done->second.second);
+                imported = true;
+            } else if (std::find(stack.begin(), stack.end(), name) != stack.end()) {
+                std::string cycle = "#import cycle: ";
+                for (auto it = std::find(stack.begin(), stack.end(), name); it != stack.end(); ++it) {
+                    cycle += *it + " -> ";
+                }
+                errors.push_back(cycle + name);
+            } else if (const std::string* contents = load(name)) {
+                // Straight into out (no copy per nesting level); nested loads can't
+                // touch this entry, name is on the stack until it's done
+                size_t begin = out.size();
+                stack.push_back(name);
+                expandInto(*contents, out, expanded, stack, errors);
+                stack.pop_back();
+
+                // The preset's last line ends where the #import line did
+                if (out.size() > begin && out.back() == '\n') out.pop_back();
+                expanded[name] = {begin, out.size() - begin};
+                imported = true;
+            } else {
+                errors.push_back("Could not open preset file: " + directory + "/" + name);
+            }
+        }
+
+        if (imported) {
+            replaced++;
+        } else {
+            out.append(text, start, lineEnd - start);
+        }
+        if (end == std::string::npos) break;
+        out += '\n';
+        start = end + 1;
+    }
+    return replaced;
+}
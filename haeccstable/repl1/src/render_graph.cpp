@@ -0,0 +1,1028 @@
+#include "render_graph.h"
+#include "gl_state.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+
+// OpenGL constants missing from minimal GLAD loader
+#ifndef GL_RGBA8
+#define GL_RGBA8 0x8058
+#endif
+#ifndef GL_FRAMEBUFFER_BINDING
+#define GL_FRAMEBUFFER_BINDING 0x8CA6
+#endif
+#ifndef GL_TEXTURE0
+#define GL_TEXTURE0 0x84C0
+#endif
+#ifndef GL_NEAREST
+#define GL_NEAREST 0x2600
+#endif
+
+// Fullscreen triangle from gl_VertexID (no vertex buffer)
+static const char* passVertexShaderSource = R"(
+#version 330 core
+out vec2 vUV;
+
+void main() {
+    vec2 pos = vec2(float((gl_VertexID << 1) & 2), float(gl_VertexID & 2));
+    vUV = pos;
+    gl_Position = vec4(pos * 2.0 - 1.0, 0.0, 1.0);
+}
+)";
+
+// Expansion guard for processes that call each other
+static const int maxProcessDepth = 16;
+
+// Blur kernels are cut at 3 sigma; this caps the radius (sigma 10)
+static const int maxBlurRadius = 30;
+
+// Builtin operation signatures: texture inputs first, then parameters
+// Parameters are numbers, tuples or true/false; "direction" and "chars" take strings.
+namespace {
+
+struct ParamSpec {
+    const char* key;
+    int components;
+    float defaults[3];
+};
+
+struct OpSpec {
+    const char* name;
+    int textures;
+    std::vector<ParamSpec> params;
+    std::vector<const char*> textureKeys;  // Optional keyword textures (default: the first input)
+};
+
+const std::vector<OpSpec>& builtinOps() {
+    static const std::vector<OpSpec> ops = {
+        {"luminance_extract", 1, {{"exposure", 1, {1.0f}}, {"attenuation", 1, {1.0f}}}},
+        {"threshold", 1, {{"level", 1, {0.5f}}}},
+        {"invert", 1, {}},
+        {"multiply", 2, {}},
+        {"add", 2, {}},
+        {"blend", 2, {{"alpha", 1, {0.5f}}}},
+        {"gooch", 1, {{"warm", 3, {1.0f, 0.8f, 0.4f}}, {"cool", 3, {0.2f, 0.4f, 0.8f}},
+                      {"base_color_blend", 1, {0.0f}}}},
+        {"gaussian_blur", 1, {{"sigma", 1, {1.0f}}, {"direction", 1, {2.0f}}}},
+        {"dog", 1, {{"sigma1", 1, {1.0f}}, {"sigma2", 1, {2.0f}}, {"tau", 1, {0.98f}}}},
+        {"sobel", 1, {{"threshold", 1, {0.1f}}, {"direction", 1, {2.0f}}}},
+        {"sobel_with_angles", 1, {{"threshold", 1, {0.1f}}, {"direction", 1, {2.0f}}}},
+        {"downscale", 1, {{"factor", 1, {2.0f}}}},
+        {"ascii", 1, {{"chars", 0, {}}, {"size", 1, {8.0f}}, {"use_edges", 1, {1.0f}},
+                      {"invert_luminance", 1, {0.0f}}, {"threshold", 1, {0.2f}},
+                      {"edge_threshold", 1, {8.0f}}},
+         {"luminance", "edges"}},
+    };
+    return ops;
+}
+
+const OpSpec* findOp(const std::string& name) {
+    for (const auto& spec : builtinOps()) {
+        if (name == spec.name) return &spec;
+    }
+    return nullptr;
+}
+
+// direction="horizontal" | "vertical" | "both"
+bool parseDirection(const std::string& text, float& value) {
+    if (text == "horizontal") value = 0.0f;
+    else if (text == "vertical") value = 1.0f;
+    else if (text == "both") value = 2.0f;
+    else return false;
+    return true;
+}
+
+// GLSL float literal
+std::string glslFloat(float value) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.8g", value);
+    std::string text = buffer;
+    if (text.find_first_of(".e") == std::string::npos) {
+        text += ".0";
+    }
+    return text;
+}
+
+std::string glslVec3(const float* values) {
+    return "vec3(" + glslFloat(values[0]) + ", " + glslFloat(values[1]) + ", " +
+           glslFloat(values[2]) + ")";
+}
+
+} // namespace
+
+RenderGraph::RenderGraph()
+    : outputNode(-1), intermediateCount(0), outputFramebuffer(0), outputWidth(0), outputHeight(0),
+      emptyVAO(0), planned(false), uploadedBytes(0), processDefs(nullptr), sourceVars(nullptr) {
+}
+
+RenderGraph::~RenderGraph() {
+    releaseTargets();
+    if (emptyVAO) glDeleteVertexArrays(1, &emptyVAO);
+}
+
+bool RenderGraph::build(const ReplProcessCall& call,
+                        const std::map<std::string, ReplProcessDef>& processes,
+                        const std::map<std::string, std::shared_ptr<VideoSource>>& sources,
+                        std::string& error) {
+    nodes.clear();
+    inputs.clear();
+    processDefs = &processes;
+    sourceVars = &sources;
+
+    outputNode = expandCall(call, {}, 0, error);
+
+    processDefs = nullptr;
+    sourceVars = nullptr;
+    if (outputNode < 0) {
+        nodes.clear();
+        inputs.clear();
+        return false;
+    }
+    if (nodes[outputNode].op == Op::INPUT) {
+        error = "$" + call.name + " returns its input unchanged; cast the in_var directly";
+        return false;
+    }
+
+    prune();
+    planned = false;
+    return true;
+}
+
+int RenderGraph::addNode(Op op, std::vector<int> nodeInputs, const float* params, int paramCount) {
+    Node node;
+    node.op = op;
+    node.inputs = std::move(nodeInputs);
+    std::fill(node.params, node.params + 8, 0.0f);
+    std::copy(params, params + paramCount, node.params);
+    node.inputIndex = -1;
+    node.width = 0;
+    node.height = 0;
+    node.consumers = 0;
+    node.consumer = -1;
+    node.pass = -1;
+    node.cpu = false;
+    nodes.push_back(std::move(node));
+    return (int)nodes.size() - 1;
+}
+
+int RenderGraph::addBlur(int input, float sigma, bool horizontal) {
+    return addNode(horizontal ? Op::BLUR_H : Op::BLUR_V, {input}, &sigma, 1);
+}
+
+int RenderGraph::expandArg(const ReplProcessArg& arg, const std::map<std::string, int>& scope,
+                           int depth, std::string& error) {
+    if (arg.kind == ReplProcessArg::Kind::CALL) {
+        return expandCall(*arg.call, scope, depth, error);
+    }
+    if (arg.kind != ReplProcessArg::Kind::NAME) {
+        error = "expected a texture, got '" + (arg.kind == ReplProcessArg::Kind::STRING ? arg.text : "number") + "'";
+        return -1;
+    }
+
+    auto local = scope.find(arg.text);
+    if (local != scope.end()) {
+        return local->second;
+    }
+
+    // Device in_vars become input nodes, one per source
+    auto source = sourceVars->find(arg.text);
+    if (source == sourceVars->end()) {
+        error = "'" + arg.text + "' is not a texture (process parameter, step, or device in_var)";
+        return -1;
+    }
+    for (size_t i = 0; i < nodes.size(); i++) {
+        if (nodes[i].op == Op::INPUT && inputs[nodes[i].inputIndex] == source->second) {
+            return (int)i;
+        }
+    }
+    int node = addNode(Op::INPUT, {});
+    nodes[node].inputIndex = (int)inputs.size();
+    inputs.push_back(source->second);
+    return node;
+}
+
+int RenderGraph::expandCall(const ReplProcessCall& call, const std::map<std::string, int>& scope,
+                            int depth, std::string& error) {
+    // User process: bind parameters, expand steps in order, return the result
+    auto def = processDefs->find(call.name);
+    if (def != processDefs->end()) {
+        if (depth >= maxProcessDepth) {
+            error = "process $" + call.name + " nests too deeply (recursive?)";
+            return -1;
+        }
+        const ReplProcessDef& process = def->second;
+        std::map<std::string, int> locals;
+        size_t positional = 0;
+        for (const auto& arg : call.args) {
+            std::string param;
+            if (arg.key.empty()) {
+                if (positional >= process.params.size()) {
+                    error = "too many arguments to $" + call.name;
+                    return -1;
+                }
+                param = process.params[positional++];
+            } else if (std::find(process.params.begin(), process.params.end(), arg.key) !=
+                       process.params.end()) {
+                param = arg.key;
+            } else {
+                error = "$" + call.name + " has no parameter '" + arg.key + "'";
+                return -1;
+            }
+            int node = expandArg(arg, scope, depth, error);
+            if (node < 0) return -1;
+            locals[param] = node;
+        }
+        for (const auto& param : process.params) {
+            if (!locals.count(param)) {
+                error = "missing argument '" + param + "' to $" + call.name;
+                return -1;
+            }
+        }
+
+        for (const auto& [name, step] : process.steps) {
+            int node = expandCall(step, locals, depth + 1, error);
+            if (node < 0) {
+                error = "$" + call.name + " step '" + name + "': " + error;
+                return -1;
+            }
+            locals[name] = node;
+        }
+        int result = expandArg(process.result, locals, depth + 1, error);
+        if (result < 0) {
+            error = "$" + call.name + " return: " + error;
+        }
+        return result;
+    }
+
+    const OpSpec* spec = findOp(call.name);
+    if (!spec) {
+        error = "unknown process or operation $" + call.name;
+        return -1;
+    }
+
+    // Match arguments: positional textures, then positional or keyword parameters
+    std::vector<int> textures;
+    std::vector<int> keyedTextures(spec->textureKeys.size(), -1);
+    std::vector<float> values;
+    std::string text;
+    std::vector<bool> given(spec->params.size(), false);
+    for (const auto& param : spec->params) {
+        values.insert(values.end(), param.defaults, param.defaults + param.components);
+    }
+
+    size_t positional = 0;
+    for (const auto& arg : call.args) {
+        if (arg.key.empty() && positional < (size_t)spec->textures) {
+            int node = expandArg(arg, scope, depth, error);
+            if (node < 0) return -1;
+            textures.push_back(node);
+            positional++;
+            continue;
+        }
+        auto textureKey = std::find_if(spec->textureKeys.begin(), spec->textureKeys.end(),
+                                       [&](const char* key) { return arg.key == key; });
+        if (textureKey != spec->textureKeys.end()) {
+            int node = expandArg(arg, scope, depth, error);
+            if (node < 0) return -1;
+            keyedTextures[textureKey - spec->textureKeys.begin()] = node;
+            continue;
+        }
+
+        size_t index = 0;
+        if (arg.key.empty()) {
+            index = positional++ - spec->textures;
+        } else {
+            while (index < spec->params.size() && arg.key != spec->params[index].key) index++;
+        }
+        if (index >= spec->params.size()) {
+            error = arg.key.empty() ? "too many arguments to $" + call.name
+                                    : "$" + call.name + " has no parameter '" + arg.key + "'";
+            return -1;
+        }
+
+        const ParamSpec& param = spec->params[index];
+        size_t offset = 0;
+        for (size_t i = 0; i < index; i++) offset += spec->params[i].components;
+
+        bool valid = false;
+        if (arg.kind == ReplProcessArg::Kind::STRING && std::string(param.key) == "direction") {
+            valid = parseDirection(arg.text, values[offset]);
+        } else if (arg.kind == ReplProcessArg::Kind::STRING && std::string(param.key) == "chars") {
+            text = arg.text;
+            valid = true;
+        } else if (arg.kind == ReplProcessArg::Kind::NAME && param.components == 1 &&
+                   (arg.text == "true" || arg.text == "false")) {
+            values[offset] = arg.text == "true" ? 1.0f : 0.0f;
+            valid = true;
+        } else if ((arg.kind == ReplProcessArg::Kind::NUMBER || arg.kind == ReplProcessArg::Kind::TUPLE) &&
+                   (int)arg.numbers.size() == param.components) {
+            std::copy(arg.numbers.begin(), arg.numbers.end(), values.begin() + offset);
+            valid = true;
+        }
+        if (!valid) {
+            error = "bad value for $" + call.name + " " + param.key;
+            return -1;
+        }
+        given[index] = true;
+    }
+    if ((int)textures.size() != spec->textures) {
+        error = "$" + call.name + " takes " + std::to_string(spec->textures) + " texture input" +
+                (spec->textures == 1 ? "" : "s");
+        return -1;
+    }
+    for (int& node : keyedTextures) {
+        if (node < 0) node = textures[0];
+    }
+
+    const std::string name = spec->name;
+    if (name == "gaussian_blur" || name == "dog") {
+        for (size_t i = 0; i < (name == "dog" ? 2u : 1u); i++) {
+            if (values[i] <= 0.0f || (int)std::ceil(values[i] * 3.0f) > maxBlurRadius) {
+                error = "$" + name + " sigma must be in (0, " +
+                        std::to_string(maxBlurRadius / 3) + "]";
+                return -1;
+            }
+        }
+    }
+
+    if (name == "luminance_extract") return addNode(Op::LUMINANCE, textures, values.data(), 2);
+    if (name == "threshold") return addNode(Op::THRESHOLD, textures, values.data(), 1);
+    if (name == "invert") return addNode(Op::INVERT, textures);
+    if (name == "multiply") return addNode(Op::MULTIPLY, textures);
+    if (name == "add") return addNode(Op::ADD, textures);
+    if (name == "blend") return addNode(Op::BLEND, textures, values.data(), 1);
+    if (name == "gooch") return addNode(Op::GOOCH, textures, values.data(), 7);
+
+    if (name == "gaussian_blur") {
+        // Separable: "both" is a horizontal pass feeding a vertical one
+        int direction = (int)values[1];
+        int node = textures[0];
+        if (direction != 1) node = addBlur(node, values[0], true);
+        if (direction != 0) node = addBlur(node, values[0], false);
+        return node;
+    }
+
+    if (name == "dog") {
+        // Two separable blurs and a per-pixel difference; the vertical blurs fuse into it
+        int inner = addBlur(addBlur(textures[0], values[0], true), values[0], false);
+        int outer = addBlur(addBlur(textures[0], values[1], true), values[1], false);
+        return addNode(Op::DOG_COMBINE, {inner, outer}, &values[2], 1);
+    }
+
+    if (name == "sobel" || name == "sobel_with_angles") {
+        float params[3] = {values[0], values[1], name == "sobel_with_angles" ? 1.0f : 0.0f};
+        return addNode(Op::SOBEL, textures, params, 3);
+    }
+
+    if (name == "ascii") {
+        // values: size, use_edges, invert_luminance, threshold, edge_threshold
+        AsciiGlyphs glyphs;
+        if (!given[0]) text = " .:-=+*#%@";
+        if (!glyphs.build(text, error)) {
+            error = "$ascii: " + error;
+            return -1;
+        }
+        if (values[0] < 2.0f || values[0] > 32.0f) {
+            error = "$ascii size must be in [2, 32]";
+            return -1;
+        }
+        int atlas = addNode(Op::GLYPH_ATLAS, {});
+        nodes[atlas].text = text;
+        float tileParams[6] = {std::floor(values[0]), values[1] != 0.0f ? 1.0f : 0.0f,
+                               values[2] != 0.0f ? 1.0f : 0.0f, std::max(0.0f, values[3]),
+                               std::max(0.0f, std::floor(values[4])), (float)glyphs.getRampLength()};
+        int tiles = addNode(Op::ASCII_TILES, {keyedTextures[0], keyedTextures[1]}, tileParams, 6);
+        return addNode(Op::ASCII_GLYPHS, {tiles, atlas}, tileParams, 1);
+    }
+
+    // downscale
+    if (values[0] < 1.0f || values[0] > 64.0f) {
+        error = "$downscale factor must be in [1, 64]";
+        return -1;
+    }
+    float factor = std::floor(values[0]);
+    return addNode(Op::DOWNSCALE, textures, &factor, 1);
+}
+
+void RenderGraph::prune() {
+    // Steps the result doesn't depend on are dropped
+    std::vector<bool> live(nodes.size(), false);
+    live[outputNode] = true;
+    for (int i = outputNode; i >= 0; i--) {
+        if (!live[i]) continue;
+        for (int input : nodes[i].inputs) live[input] = true;
+    }
+
+    std::vector<int> remap(nodes.size(), -1);
+    std::vector<Node> kept;
+    std::vector<std::shared_ptr<VideoSource>> keptInputs;
+    for (size_t i = 0; i < nodes.size(); i++) {
+        if (!live[i]) continue;
+        Node node = nodes[i];
+        for (int& input : node.inputs) input = remap[input];
+        if (node.op == Op::INPUT) {
+            keptInputs.push_back(inputs[node.inputIndex]);
+            node.inputIndex = (int)keptInputs.size() - 1;
+        }
+        remap[i] = (int)kept.size();
+        kept.push_back(std::move(node));
+    }
+    outputNode = remap[outputNode];
+    nodes = std::move(kept);
+    inputs = std::move(keptInputs);
+
+    for (size_t i = 0; i < nodes.size(); i++) {
+        for (int input : nodes[i].inputs) {
+            nodes[input].consumers++;
+            nodes[input].consumer = (int)i;
+        }
+    }
+}
+
+bool RenderGraph::isFused(int node, int pass) const {
+    return nodes[node].pass < 0 && nodes[node].op != Op::INPUT && nodes[node].op != Op::GLYPH_ATLAS &&
+           pass >= 0;
+}
+
+void RenderGraph::emitNode(int node, int pass, std::vector<int>& textureNodes, std::string& body) const {
+    const Node& n = nodes[node];
+
+    // Value of an input: computed earlier in this shader, or sampled from its texture
+    auto sampler = [&](int input) {
+        auto it = std::find(textureNodes.begin(), textureNodes.end(), input);
+        int unit = (int)(it - textureNodes.begin());
+        if (it == textureNodes.end()) textureNodes.push_back(input);
+        return "uTex" + std::to_string(unit);
+    };
+    std::vector<std::string> values;
+    for (int input : n.inputs) {
+        if (isFused(input, pass)) {
+            emitNode(input, pass, textureNodes, body);
+            values.push_back("v" + std::to_string(input));
+        } else if (isPerPixel(n.op)) {
+            values.push_back("texture(" + sampler(input) + ", vUV)");
+        } else {
+            values.push_back(sampler(input));
+        }
+    }
+
+    const std::string v = "v" + std::to_string(node);
+    const float* p = n.params;
+    std::string code = "    vec4 " + v + ";\n    {\n";
+    switch (n.op) {
+    case Op::INPUT:
+    case Op::GLYPH_ATLAS:
+        break;
+    case Op::LUMINANCE:
+        code += "        float l = dot(" + values[0] + ".rgb, lumaWeights) * " + glslFloat(p[0]) + ";\n"
+                "        l = pow(clamp(l, 0.0, 1.0), " + glslFloat(p[1]) + ");\n"
+                "        " + v + " = vec4(vec3(l), 1.0);\n";
+        break;
+    case Op::THRESHOLD:
+        code += "        vec4 c = " + values[0] + ";\n"
+                "        " + v + " = vec4(vec3(step(" + glslFloat(p[0]) + ", dot(c.rgb, lumaWeights))), c.a);\n";
+        break;
+    case Op::INVERT:
+        code += "        vec4 c = " + values[0] + ";\n"
+                "        " + v + " = vec4(1.0 - c.rgb, c.a);\n";
+        break;
+    case Op::MULTIPLY:
+        code += "        vec4 a = " + values[0] + ";\n"
+                "        " + v + " = vec4(a.rgb * " + values[1] + ".rgb, a.a);\n";
+        break;
+    case Op::ADD:
+        code += "        vec4 a = " + values[0] + ";\n"
+                "        " + v + " = vec4(min(a.rgb + " + values[1] + ".rgb, 1.0), a.a);\n";
+        break;
+    case Op::BLEND:
+        code += "        " + v + " = mix(" + values[0] + ", " + values[1] + ", " + glslFloat(p[0]) + ");\n";
+        break;
+    case Op::GOOCH:
+        code += "        vec4 c = " + values[0] + ";\n"
+                "        vec3 tone = mix(" + glslVec3(p + 3) + ", " + glslVec3(p) + ", dot(c.rgb, lumaWeights));\n"
+                "        " + v + " = vec4(mix(tone, c.rgb, " + glslFloat(p[6]) + "), c.a);\n";
+        break;
+    case Op::DOG_COMBINE:
+        // Thresholded difference of Gaussians (edges dark, flat areas white)
+        code += "        float d = dot(" + values[0] + ".rgb, lumaWeights) - " + glslFloat(p[0]) +
+                " * dot(" + values[1] + ".rgb, lumaWeights);\n"
+                "        " + v + " = vec4(vec3(step(0.0, d)), 1.0);\n";
+        break;
+    case Op::BLUR_H:
+    case Op::BLUR_V: {
+        // Gaussian weights to 3 sigma, folded into bilinear taps: each pair of texels
+        // is read with one sample placed between them at the weighted offset
+        const Node& in = nodes[n.inputs[0]];
+        int radius = std::max(1, (int)std::ceil(p[0] * 3.0f));
+        std::vector<float> weights(radius + 1);
+        float total = 0.0f;
+        for (int i = 0; i <= radius; i++) {
+            weights[i] = std::exp(-(float)(i * i) / (2.0f * p[0] * p[0]));
+            total += i == 0 ? weights[i] : 2.0f * weights[i];
+        }
+        for (float& weight : weights) weight /= total;
+
+        std::string offsets, tapWeights;
+        int taps = 0;
+        for (int i = 1; i <= radius; i += 2) {
+            float w0 = weights[i];
+            float w1 = i + 1 <= radius ? weights[i + 1] : 0.0f;
+            float offset = (i * w0 + (i + 1) * w1) / (w0 + w1);
+            offsets += (taps ? ", " : "") + glslFloat(offset);
+            tapWeights += (taps ? ", " : "") + glslFloat(w0 + w1);
+            taps++;
+        }
+        std::string step = n.op == Op::BLUR_H ? "vec2(" + glslFloat(1.0f / in.width) + ", 0.0)"
+                                              : "vec2(0.0, " + glslFloat(1.0f / in.height) + ")";
+        std::string count = std::to_string(taps);
+        code += "        const float offsets[" + count + "] = float[](" + offsets + ");\n"
+                "        const float weights[" + count + "] = float[](" + tapWeights + ");\n"
+                "        " + v + " = texture(" + values[0] + ", vUV) * " + glslFloat(weights[0]) + ";\n"
+                "        for (int i = 0; i < " + count + "; i++) {\n"
+                "            vec2 o = " + step + " * offsets[i];\n"
+                "            " + v + " += (texture(" + values[0] + ", vUV + o) + texture(" + values[0] +
+                ", vUV - o)) * weights[i];\n"
+                "        }\n";
+        break;
+    }
+    case Op::SOBEL: {
+        const Node& in = nodes[n.inputs[0]];
+        code += "        vec2 texel = vec2(" + glslFloat(1.0f / in.width) + ", " + glslFloat(1.0f / in.height) + ");\n"
+                "        float s[9];\n"
+                "        for (int i = 0; i < 9; i++) {\n"
+                "            vec2 o = vec2(float(i % 3 - 1), float(i / 3 - 1)) * texel;\n"
+                "            s[i] = dot(texture(" + values[0] + ", vUV + o).rgb, lumaWeights);\n"
+                "        }\n"
+                "        float gx = (s[2] + 2.0 * s[5] + s[8]) - (s[0] + 2.0 * s[3] + s[6]);\n"
+                "        float gy = (s[6] + 2.0 * s[7] + s[8]) - (s[0] + 2.0 * s[1] + s[2]);\n";
+        int direction = (int)p[1];
+        code += std::string("        float g = ") +
+                (direction == 0 ? "abs(gx)" : direction == 1 ? "abs(gy)" : "length(vec2(gx, gy))") + ";\n"
+                "        float e = step(" + glslFloat(p[0]) + ", g);\n";
+        if (p[2] != 0.0f) {
+            // Angle in [0, 1) in green for edge-oriented consumers
+            code += "        " + v + " = vec4(e, atan(gy, gx) / 6.2831853 + 0.5, 0.0, 1.0);\n";
+        } else {
+            code += "        " + v + " = vec4(vec3(e), 1.0);\n";
+        }
+        break;
+    }
+    case Op::DOWNSCALE: {
+        // Box filter over factor x factor texels; even factors read 2x2 texels per bilinear tap
+        const Node& in = nodes[n.inputs[0]];
+        int factor = (int)p[0];
+        bool paired = factor % 2 == 0;
+        int taps = paired ? factor / 2 : factor;
+        std::string first = paired ? glslFloat(1.0f - factor / 2.0f) : glslFloat(0.5f - factor / 2.0f);
+        std::string spacing = paired ? "2.0" : "1.0";
+        code += "        vec2 texel = vec2(" + glslFloat(1.0f / in.width) + ", " + glslFloat(1.0f / in.height) + ");\n"
+                "        vec4 sum = vec4(0.0);\n"
+                "        for (int y = 0; y < " + std::to_string(taps) + "; y++) {\n"
+                "            for (int x = 0; x < " + std::to_string(taps) + "; x++) {\n"
+                "                sum += texture(" + values[0] + ", vUV + (vec2(x, y) * " + spacing + " + " +
+                first + ") * texel);\n"
+                "            }\n"
+                "        }\n"
+                "        " + v + " = sum / " + glslFloat((float)(taps * taps)) + ";\n";
+        break;
+    }
+    case Op::ASCII_TILES: {
+        // One texel per tile: the glyph index / 255. Same integer math as
+        // ImageKernels::ascii (8-bit luminance, 8.8 weights), so both pick the same
+        // glyphs: ramp glyph from the mean luminance, or the edge glyph of the most
+        // common Sobel orientation when enough pixels are edges
+        int cell = (int)p[0];
+        int ramp = (int)p[5];
+        std::string c = std::to_string(cell);
+        std::string w = std::to_string(cell + 2);
+        code += "        ivec2 origin = ivec2(gl_FragCoord.xy) * " + c + ";\n"
+                "        ivec2 lumaMax = textureSize(" + values[0] + ", 0) - 1;\n"
+                "        int sum = 0;\n"
+                "        for (int y = 0; y < " + c + "; y++) {\n"
+                "            for (int x = 0; x < " + c + "; x++) {\n"
+                "                sum += luma8(texelFetch(" + values[0] + ", min(origin + ivec2(x, y), lumaMax), 0));\n"
+                "            }\n"
+                "        }\n"
+                "        int glyph = min(" + std::to_string(ramp - 1) + ", sum * " + std::to_string(ramp) + " / " +
+                std::to_string(255 * cell * cell) + ");\n";
+        if (p[2] != 0.0f) {
+            code += "        glyph = " + std::to_string(ramp - 1) + " - glyph;\n";
+        }
+        if (p[1] != 0.0f) {
+            float scaled = p[3] * 255.0f;  // Threshold in 8-bit luminance steps, as on the CPU
+            code += "        ivec2 edgeMax = textureSize(" + values[1] + ", 0) - 1;\n"
+                    "        float l[" + std::to_string((cell + 2) * (cell + 2)) + "];\n"
+                    "        for (int y = 0; y < " + w + "; y++) {\n"
+                    "            for (int x = 0; x < " + w + "; x++) {\n"
+                    "                ivec2 at = clamp(origin + ivec2(x - 1, y - 1), ivec2(0), edgeMax);\n"
+                    "                l[y * " + w + " + x] = float(luma8(texelFetch(" + values[1] + ", at, 0)));\n"
+                    "            }\n"
+                    "        }\n"
+                    "        int counts[4] = int[4](0, 0, 0, 0);\n"
+                    "        for (int y = 0; y < " + c + "; y++) {\n"
+                    "            for (int x = 0; x < " + c + "; x++) {\n"
+                    "                int i = (y + 1) * " + w + " + x + 1;\n"
+                    "                float gx = (l[i - " + w + " + 1] + 2.0 * l[i + 1] + l[i + " + w + " + 1]) -\n"
+                    "                           (l[i - " + w + " - 1] + 2.0 * l[i - 1] + l[i + " + w + " - 1]);\n"
+                    "                float gy = (l[i + " + w + " - 1] + 2.0 * l[i + " + w + "] + l[i + " + w + " + 1]) -\n"
+                    "                           (l[i - " + w + " - 1] + 2.0 * l[i - " + w + "] + l[i - " + w + " + 1]);\n"
+                    "                if (gx * gx + gy * gy >= " + glslFloat((float)std::ceil((double)scaled * scaled)) + ") {\n"
+                    "                    float ax = abs(gx) * 106.0;\n"
+                    "                    float ay = abs(gy) * 256.0;\n"
+                    "                    counts[ay <= ax ? 0 : ay >= abs(gx) * 618.0 ? 2 : gx * gy > 0.0 ? 1 : 3]++;\n"
+                    "                }\n"
+                    "            }\n"
+                    "        }\n"
+                    "        int best = 0;\n"
+                    "        for (int o = 1; o < 4; o++) {\n"
+                    "            if (counts[o] > counts[best]) best = o;\n"
+                    "        }\n"
+                    "        int total = counts[0] + counts[1] + counts[2] + counts[3];\n"
+                    "        if (total > 0 && total >= " + std::to_string((int)p[4]) + ") glyph = " +
+                    std::to_string(ramp) + " + best;\n";
+        }
+        code += "        " + v + " = vec4(float(glyph) / 255.0, 0.0, 0.0, 1.0);\n";
+        break;
+    }
+    case Op::ASCII_GLYPHS: {
+        // Nearest texel of the tile's 8x8 glyph, scaled to the tile size
+        std::string c = std::to_string((int)p[0]);
+        code += "        ivec2 pixel = ivec2(gl_FragCoord.xy);\n"
+                "        int glyph = int(texelFetch(" + values[0] + ", pixel / " + c + ", 0).r * 255.0 + 0.5);\n"
+                "        ivec2 local = (pixel % " + c + ") * " + std::to_string(AsciiGlyphs::cellSize) + " / " + c + ";\n"
+                "        float coverage = texelFetch(" + values[1] + ", ivec2(glyph * " +
+                std::to_string(AsciiGlyphs::cellSize) + " + local.x, local.y), 0).r;\n"
+                "        " + v + " = vec4(vec3(coverage), 1.0);\n";
+        break;
+    }
+    }
+    body += code + "    }\n";
+}
+
+std::string RenderGraph::generateShader(int pass, std::vector<int>& textureNodes) const {
+    std::string body;
+    emitNode(passes[pass].node, pass, textureNodes, body);
+
+    std::string source = "#version 330 core\n"
+                         "in vec2 vUV;\n"
+                         "out vec4 FragColor;\n";
+    for (size_t i = 0; i < textureNodes.size(); i++) {
+        source += "uniform sampler2D uTex" + std::to_string(i) + ";\n";
+    }
+    source += "const vec3 lumaWeights = vec3(0.2126, 0.7152, 0.0722);\n"
+              "\n"
+              "// 8-bit luminance as the CPU kernels compute it (ImageKernels::luminance)\n"
+              "int luma8(vec4 c) {\n"
+              "    ivec3 v = ivec3(c.rgb * 255.0 + 0.5);\n"
+              "    return (54 * v.r + 183 * v.g + 19 * v.b + 128) >> 8;\n"
+              "}\n"
+              "\n"
+              "void main() {\n" + body +
+              "    FragColor = v" + std::to_string(passes[pass].node) + ";\n"
+              "}\n";
+    return source;
+}
+
+bool RenderGraph::plan() {
+    releaseTargets();
+    passes.clear();
+
+    // Glyph atlases (constant textures, sampled with texelFetch)
+    for (size_t i = 0; i < nodes.size(); i++) {
+        if (nodes[i].op != Op::GLYPH_ATLAS) continue;
+        Atlas& atlas = atlases[(int)i];
+        std::string error;
+        atlas.glyphs.build(nodes[i].text, error);  // Checked in build()
+        std::vector<uint8_t> rgba;
+        rgba.reserve(atlas.glyphs.getPixels().size() * 4);
+        for (uint8_t coverage : atlas.glyphs.getPixels()) {
+            rgba.insert(rgba.end(), {coverage, coverage, coverage, 255});
+        }
+        glGenTextures(1, &atlas.texture);
+        glBindTexture(GL_TEXTURE_2D, atlas.texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, atlas.glyphs.getAtlasWidth(), AsciiGlyphs::cellSize, 0,
+                     GL_RGBA, GL_UNSIGNED_BYTE, rgba.data());
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    }
+
+    // Sizes flow from the inputs; downscale and ascii tiles shrink them, ascii glyphs
+    // grow the tiles back to whole cells
+    for (size_t i = 0; i < nodes.size(); i++) {
+        Node& node = nodes[i];
+        if (node.op == Op::INPUT) {
+            node.width = inputWidths[node.inputIndex];
+            node.height = inputHeights[node.inputIndex];
+        } else if (node.op == Op::GLYPH_ATLAS) {
+            node.width = atlases[(int)i].glyphs.getAtlasWidth();
+            node.height = AsciiGlyphs::cellSize;
+        } else if (node.op == Op::ASCII_GLYPHS) {
+            const Node& tiles = nodes[node.inputs[0]];
+            node.width = tiles.width * (int)node.params[0];
+            node.height = tiles.height * (int)node.params[0];
+        } else {
+            const Node& first = nodes[node.inputs[0]];
+            int factor = node.op == Op::DOWNSCALE || node.op == Op::ASCII_TILES ? (int)node.params[0] : 1;
+            node.width = std::max(1, first.width / factor);
+            node.height = std::max(1, first.height / factor);
+        }
+    }
+
+    // ascii steps reading device frames go to the CPU kernels when set: the glyph
+    // step becomes an uploaded pass and its tiles step has no pass of its own
+    for (auto& node : nodes) {
+        node.cpu = false;
+        if (node.op != Op::ASCII_GLYPHS || !cpuKernels) continue;
+        Node& tiles = nodes[node.inputs[0]];
+        bool fromFrames = nodes[tiles.inputs[0]].op == Op::INPUT && nodes[tiles.inputs[1]].op == Op::INPUT;
+        node.cpu = fromFrames;
+        tiles.cpu = fromFrames;
+    }
+
+    // A node gets its own pass unless its only reader is a same-size per-pixel
+    // operation, which then computes it inline
+    for (size_t i = 0; i < nodes.size(); i++) {
+        Node& node = nodes[i];
+        node.pass = -1;
+        if (node.op == Op::INPUT || node.op == Op::GLYPH_ATLAS) continue;
+        if (node.cpu && node.op == Op::ASCII_TILES) continue;
+        bool fuse = (int)i != outputNode && !node.cpu && node.consumers == 1 &&
+                    isPerPixel(nodes[node.consumer].op) &&
+                    nodes[node.consumer].width == node.width &&
+                    nodes[node.consumer].height == node.height;
+        if (fuse) continue;
+
+        node.pass = (int)passes.size();
+        Pass pass;
+        pass.node = (int)i;
+        pass.slot = -1;
+        pass.lastUse = -1;
+        pass.cpu = node.cpu;
+        passes.push_back(std::move(pass));
+    }
+
+    // Generate and compile each pass
+    GLState& state = GLState::get();
+    inputUploads.assign(inputs.size(), false);
+    for (size_t p = 0; p < passes.size(); p++) {
+        Pass& pass = passes[p];
+        if (pass.cpu) continue;
+        std::string fragment = generateShader((int)p, pass.textureNodes);
+        pass.shader = std::make_unique<Shader>();
+        if (!pass.shader->load(passVertexShaderSource, fragment.c_str())) {
+            std::cerr << "ERROR: Render graph pass " << p << " failed to compile:\n" << fragment;
+            passes.clear();
+            return false;
+        }
+        state.useProgram(pass.shader->getProgram());
+        for (size_t unit = 0; unit < pass.textureNodes.size(); unit++) {
+            glUniform1i(pass.shader->uniform("uTex" + std::to_string(unit)), (GLint)unit);
+        }
+
+        for (int textureNode : pass.textureNodes) {
+            if (nodes[textureNode].op == Op::INPUT) {
+                inputUploads[nodes[textureNode].inputIndex] = true;
+            }
+            int writer = nodes[textureNode].pass;
+            if (writer >= 0) {
+                passes[writer].lastUse = std::max(passes[writer].lastUse, (int)p);
+            }
+        }
+    }
+
+    // Assign pool slots in pass order; a slot is free again once its last reader ran.
+    // A pass never writes a slot it reads, since release happens after allocation.
+    std::vector<bool> busy;
+    intermediateCount = 0;
+    for (size_t p = 0; p < passes.size(); p++) {
+        Pass& pass = passes[p];
+        const Node& node = nodes[pass.node];
+        if (pass.node != outputNode) {
+            intermediateCount++;
+            for (size_t s = 0; s < pool.size() && pass.slot < 0; s++) {
+                if (!busy[s] && pool[s].width == node.width && pool[s].height == node.height) {
+                    pass.slot = (int)s;
+                }
+            }
+            if (pass.slot < 0) {
+                Slot slot = {0, 0, node.width, node.height};
+                glGenTextures(1, &slot.texture);
+                glBindTexture(GL_TEXTURE_2D, slot.texture);
+                glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, slot.width, slot.height, 0,
+                             GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+                glGenFramebuffers(1, &slot.framebuffer);
+                glBindFramebuffer(GL_FRAMEBUFFER, slot.framebuffer);
+                glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, slot.texture, 0);
+                pass.slot = (int)pool.size();
+                pool.push_back(slot);
+                busy.push_back(false);
+            }
+            busy[pass.slot] = true;
+        }
+        for (size_t q = 0; q < p; q++) {
+            if (passes[q].lastUse == (int)p && passes[q].slot >= 0) {
+                busy[passes[q].slot] = false;
+            }
+        }
+    }
+
+    // Final pass renders straight into the texture layers sample
+    const Node& result = nodes[outputNode];
+    outputWidth = result.width;
+    outputHeight = result.height;
+    output = std::make_shared<VideoTexture>();
+    output->init(outputWidth, outputHeight);
+    glGenFramebuffers(1, &outputFramebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, outputFramebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, output->getTextureID(), 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "ERROR: Render graph output framebuffer not complete\n";
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    state.invalidate();
+
+    inputTextures.clear();
+    for (size_t i = 0; i < inputs.size(); i++) {
+        inputTextures.push_back(std::make_unique<VideoTexture>());
+        inputTextures.back()->init(inputWidths[i], inputHeights[i]);
+    }
+    inputTimestamps.assign(inputs.size(), -1.0);
+
+    if (!emptyVAO) {
+        glGenVertexArrays(1, &emptyVAO);
+    }
+
+    std::cout << "Render graph: " << nodes.size() - inputs.size() - atlases.size() << " operations in "
+              << passes.size() << " passes";
+    if (getCpuPassCount() > 0) {
+        std::cout << " (" << getCpuPassCount() << " on CPU " << cpuKernels->getSimdName() << " x"
+                  << cpuKernels->getThreadCount() << ")";
+    }
+    std::cout << ", " << pool.size() << " pooled textures for " << intermediateCount
+              << " intermediates (" << outputWidth << "x" << outputHeight << ")\n";
+    planned = true;
+    return true;
+}
+
+void RenderGraph::releaseTargets() {
+    for (auto& slot : pool) {
+        glDeleteFramebuffers(1, &slot.framebuffer);
+        glDeleteTextures(1, &slot.texture);
+    }
+    pool.clear();
+    for (auto& [node, atlas] : atlases) {
+        glDeleteTextures(1, &atlas.texture);
+    }
+    atlases.clear();
+    if (outputFramebuffer) {
+        glDeleteFramebuffers(1, &outputFramebuffer);
+        outputFramebuffer = 0;
+    }
+    planned = false;
+}
+
+bool RenderGraph::prepare(const std::vector<std::pair<int, int>>& inputSizes) {
+    if (nodes.empty() || inputSizes.size() != inputs.size()) return false;
+    inputWidths.clear();
+    inputHeights.clear();
+    for (const auto& size : inputSizes) {
+        if (size.first <= 0 || size.second <= 0) return false;
+        inputWidths.push_back(size.first);
+        inputHeights.push_back(size.second);
+    }
+    planned = plan();
+    return planned;
+}
+
+void RenderGraph::execute() {
+    if (nodes.empty()) return;
+
+    // Inputs are peeked, not consumed: layers casting the camera still get its frames.
+    // Once per execute, so a frame arriving meanwhile waits for the next one.
+    bool changed = false;
+    inputFrames.resize(inputs.size());
+    for (size_t i = 0; i < inputs.size(); i++) {
+        inputFrames[i] = inputs[i]->peekFrame();
+        const auto& frame = inputFrames[i];
+        if (!frame) return;
+        if (i >= inputWidths.size() || frame->width != inputWidths[i] || frame->height != inputHeights[i]) {
+            planned = false;
+        }
+    }
+    if (!planned) {
+        inputWidths.clear();
+        inputHeights.clear();
+        for (const auto& frame : inputFrames) {
+            inputWidths.push_back(frame->width);
+            inputHeights.push_back(frame->height);
+        }
+        if (!plan()) {
+            nodes.clear();  // Don't retry a graph that doesn't compile every frame
+            return;
+        }
+    }
+    for (size_t i = 0; i < inputs.size(); i++) {
+        const auto& frame = inputFrames[i];
+        if (frame->timestamp != inputTimestamps[i]) {
+            if (inputUploads[i] && inputTextures[i]->update(frame)) {  // CPU-only inputs are read from the frame
+                uploadedBytes += frame->dataSize;
+            }
+            inputTimestamps[i] = frame->timestamp;
+            changed = true;
+        }
+    }
+    if (!changed) return;
+
+    GLState& state = GLState::get();
+    state.invalidate();  // VideoTexture::update binds GL_TEXTURE_2D directly
+
+    GLint previousFramebuffer = 0;
+    GLint previousViewport[4];
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFramebuffer);
+    glGetIntegerv(GL_VIEWPORT, previousViewport);
+
+    state.setBlend(false);
+    state.bindVertexArray(emptyVAO);
+    for (const auto& pass : passes) {
+        if (pass.cpu) {
+            executeCpuPass(pass);
+            continue;
+        }
+        const Node& node = nodes[pass.node];
+        glBindFramebuffer(GL_FRAMEBUFFER, pass.slot >= 0 ? pool[pass.slot].framebuffer : outputFramebuffer);
+        glViewport(0, 0, node.width, node.height);
+        state.useProgram(pass.shader->getProgram());
+
+        for (size_t unit = pass.textureNodes.size(); unit-- > 0;) {
+            const Node& source = nodes[pass.textureNodes[unit]];
+            GLuint texture = source.op == Op::INPUT ? inputTextures[source.inputIndex]->getTextureID()
+                           : source.op == Op::GLYPH_ATLAS ? atlases.at(pass.textureNodes[unit]).texture
+                           : pool[passes[source.pass].slot].texture;
+            if (unit == 0) {
+                state.bindTexture(texture);
+            } else {
+                glActiveTexture(GL_TEXTURE0 + (GLenum)unit);
+                glBindTexture(GL_TEXTURE_2D, texture);
+                glActiveTexture(GL_TEXTURE0);
+                state.countCall(3);
+            }
+        }
+
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        state.countCall(3);  // Framebuffer, viewport, draw
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, (GLuint)previousFramebuffer);
+    glViewport(previousViewport[0], previousViewport[1], previousViewport[2], previousViewport[3]);
+}
+
+void RenderGraph::executeCpuPass(const Pass& pass) {
+    const Node& glyphNode = nodes[pass.node];
+    const Node& tiles = nodes[glyphNode.inputs[0]];
+    const Node& lumaInput = nodes[tiles.inputs[0]];
+    const Node& edgeInput = nodes[tiles.inputs[1]];
+
+    cpuKernels->luminance(*inputFrames[lumaInput.inputIndex], cpuLuminance);
+    const ImagePlane* edgeLuminance = &cpuLuminance;
+    if (tiles.inputs[1] != tiles.inputs[0] && tiles.params[1] != 0.0f) {
+        cpuKernels->luminance(*inputFrames[edgeInput.inputIndex], cpuEdgeLuminance);
+        edgeLuminance = &cpuEdgeLuminance;
+    }
+
+    ImageKernels::AsciiParams params;
+    params.cellSize = (int)tiles.params[0];
+    params.useEdges = tiles.params[1] != 0.0f;
+    params.invertLuminance = tiles.params[2] != 0.0f;
+    params.threshold = tiles.params[3];
+    params.edgeThreshold = (int)tiles.params[4];
+    cpuKernels->ascii(cpuLuminance, *edgeLuminance, atlases.at(glyphNode.inputs[1]).glyphs, params, cpuGlyphs);
+
+    // Gray to RGBA, into the texture a GPU pass would have rendered
+    cpuUpload.resize(cpuGlyphs.pixels.size() * 4);
+    for (size_t i = 0; i < cpuGlyphs.pixels.size(); i++) {
+        uint8_t coverage = cpuGlyphs.pixels[i];
+        cpuUpload[i * 4 + 0] = coverage;
+        cpuUpload[i * 4 + 1] = coverage;
+        cpuUpload[i * 4 + 2] = coverage;
+        cpuUpload[i * 4 + 3] = 255;
+    }
+    GLState::get().bindTexture(pass.slot >= 0 ? pool[pass.slot].texture : output->getTextureID());
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, cpuGlyphs.width, cpuGlyphs.height, GL_RGBA, GL_UNSIGNED_BYTE,
+                    cpuUpload.data());
+    uploadedBytes += cpuUpload.size();
+}
+
+void RenderGraph::setCpuKernels(std::shared_ptr<ImageKernels> kernels) {
+    cpuKernels = std::move(kernels);
+    planned = false;
+}
+
+int RenderGraph::getCpuPassCount() const {
+    return (int)std::count_if(passes.begin(), passes.end(), [](const Pass& pass) { return pass.cpu; });
+}
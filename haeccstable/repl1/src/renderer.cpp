@@ -1,122 +1,114 @@
 #include "renderer.h"
+#include "gl_state.h"
+#include "bitmap_font.h"
 #include <iostream>
 #include <vector>
+#include <cstdint>
+#include <algorithm>
 
 // OpenGL constants missing from minimal GLAD loader
-#ifndef GL_TEXTURE0
-#define GL_TEXTURE0 0x84C0
+#ifndef GL_NEAREST
+#define GL_NEAREST 0x2600
+#endif
+#ifndef GL_STREAM_DRAW
+#define GL_STREAM_DRAW 0x88E0
+#endif
+#ifndef GL_UNIFORM_BUFFER
+#define GL_UNIFORM_BUFFER 0x8A11
 #endif
 
-// Simple vertex shader
-const char* vertexShaderSource = R"(
-#version 330 core
-layout (location = 0) in vec2 aPos;
-
-uniform mat4 uProjection;
-
-void main() {
-    gl_Position = uProjection * vec4(aPos, 0.0, 1.0);
-}
-)";
-
-// Simple fragment shader
-const char* fragmentShaderSource = R"(
-#version 330 core
-out vec4 FragColor;
-
-uniform vec4 uColor;
-
-void main() {
-    FragColor = uColor;
-}
-)";
-
-// Texture vertex shader
-const char* textureVertexShaderSource = R"(
+// Batch vertex shader (positions in framebuffer pixels, per-vertex color)
+const char* batchVertexShaderSource = R"(
 #version 330 core
 layout (location = 0) in vec2 aPos;
 layout (location = 1) in vec2 aTexCoord;
+layout (location = 2) in vec4 aColor;
+
+layout (std140) uniform Projection {
+    mat4 uProjection;
+};
 
 out vec2 TexCoord;
+out vec4 Color;
 
 void main() {
-    gl_Position = vec4(aPos, 0.0, 1.0);
+    gl_Position = uProjection * vec4(aPos, 0.0, 1.0);
     TexCoord = aTexCoord;
+    Color = aColor;
 }
 )";
 
-// Texture fragment shader
-const char* textureFragmentShaderSource = R"(
+// Batch fragment shader
+// Rects sample the atlas's white texel, text samples glyph coverage, video
+// textures are drawn with a white vertex color
+const char* batchFragmentShaderSource = R"(
 #version 330 core
 out vec4 FragColor;
 
 in vec2 TexCoord;
+in vec4 Color;
 
 uniform sampler2D uTexture;
 
 void main() {
-    FragColor = texture(uTexture, TexCoord);
+    FragColor = Color * texture(uTexture, TexCoord);
 }
 )";
 
-Renderer::Renderer() : shaderProgram(0), VAO(0), VBO(0),
-                       textureShaderProgram(0), textureVAO(0), textureVBO(0) {
+// Floats per batch vertex: x, y, u, v, r, g, b, a
+static const int batchVertexFloats = 8;
+
+// UBO binding point of the Projection block
+static const GLuint projectionBinding = 0;
+
+Renderer::Renderer() : batchVAO(0), batchVBO(0), batchCapacity(0), projectionUBO(0),
+                       projectionRegion({0, 0, 0, 0}), viewportWidth(0), viewportHeight(0),
+                       activeTarget(nullptr),
+                       glyphAtlas(0), atlasWidth(0), atlasHeight(0), whiteU(0.0f), whiteV(0.0f) {
 }
 
 Renderer::~Renderer() {
-    if (VAO) glDeleteVertexArrays(1, &VAO);
-    if (VBO) glDeleteBuffers(1, &VBO);
-    if (shaderProgram) glDeleteProgram(shaderProgram);
-    if (textureVAO) glDeleteVertexArrays(1, &textureVAO);
-    if (textureVBO) glDeleteBuffers(1, &textureVBO);
-    if (textureShaderProgram) glDeleteProgram(textureShaderProgram);
+    if (batchVAO) glDeleteVertexArrays(1, &batchVAO);
+    if (batchVBO) glDeleteBuffers(1, &batchVBO);
+    if (projectionUBO) glDeleteBuffers(1, &projectionUBO);
+    if (glyphAtlas) glDeleteTextures(1, &glyphAtlas);
 }
 
 bool Renderer::init() {
-    // Create shader program
-    shaderProgram = createShaderProgram(vertexShaderSource, fragmentShaderSource);
-    if (shaderProgram == 0) {
+    // Single shader for every quad the UI draws
+    if (!batchShader.load(batchVertexShaderSource, batchFragmentShaderSource) ||
+        !batchShader.bindUniformBlock("Projection", projectionBinding) ||
+        !buildGlyphAtlas()) {
         return false;
     }
 
-    // Create VAO and VBO
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-
-    glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-
-    // Position attribute
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    GLState& state = GLState::get();
+    state.useProgram(batchShader.getProgram());
+    glUniform1i(batchShader.uniform("uTexture"), 0);
 
-    // Create texture shader program
-    textureShaderProgram = createShaderProgram(textureVertexShaderSource, textureFragmentShaderSource);
-    if (textureShaderProgram == 0) {
-        return false;
-    }
+    // Projection UBO, filled by setViewport() whenever the framebuffer size changes
+    glGenBuffers(1, &projectionUBO);
+    state.bindBuffer(GL_UNIFORM_BUFFER, projectionUBO);
+    glBufferData(GL_UNIFORM_BUFFER, 16 * sizeof(float), nullptr, GL_DYNAMIC_DRAW);
+    state.bindBufferBase(GL_UNIFORM_BUFFER, projectionBinding, projectionUBO);
 
-    // Create texture VAO and VBO
-    glGenVertexArrays(1, &textureVAO);
-    glGenBuffers(1, &textureVBO);
+    // Create batch VAO and VBO (storage is sized in flush())
+    glGenVertexArrays(1, &batchVAO);
+    glGenBuffers(1, &batchVBO);
 
-    glBindVertexArray(textureVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, textureVBO);
+    state.bindVertexArray(batchVAO);
+    state.bindBuffer(GL_ARRAY_BUFFER, batchVBO);
 
-    // Position and texture coordinate attributes (x, y, u, v)
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+    // Position, texture coordinate and color attributes (x, y, u, v, r, g, b, a)
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, batchVertexFloats * sizeof(float), (void*)0);
     glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, batchVertexFloats * sizeof(float), (void*)(2 * sizeof(float)));
     glEnableVertexAttribArray(1);
-
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, batchVertexFloats * sizeof(float), (void*)(4 * sizeof(float)));
+    glEnableVertexAttribArray(2);
 
     // Enable blending for transparency
-    glEnable(GL_BLEND);
+    state.setBlend(true);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
     return true;
@@ -127,54 +119,36 @@ void Renderer::clear(float r, float g, float b, float a) {
     glClear(GL_COLOR_BUFFER_BIT);
 }
 
-void Renderer::drawRect(const Rect& rect, float r, float g, float b, float a) {
-    // Get current viewport
-    GLint viewport[4];
-    glGetIntegerv(GL_VIEWPORT, viewport);
-    int viewportWidth = viewport[2];
-    int viewportHeight = viewport[3];
-
-    // Convert screen coordinates to normalized device coordinates
-    float x1 = (rect.x * 2.0f / viewportWidth) - 1.0f;
-    float y1 = (rect.y * 2.0f / viewportHeight) - 1.0f;
-    float x2 = ((rect.x + rect.width) * 2.0f / viewportWidth) - 1.0f;
-    float y2 = ((rect.y + rect.height) * 2.0f / viewportHeight) - 1.0f;
-
-    float vertices[] = {
-        x1, y1,  // bottom-left
-        x2, y1,  // bottom-right
-        x2, y2,  // top-right
-        x1, y1,  // bottom-left
-        x2, y2,  // top-right
-        x1, y2   // top-left
-    };
-
-    glUseProgram(shaderProgram);
-    glBindVertexArray(VAO);
-
-    // Set color uniform
-    GLint colorLoc = glGetUniformLocation(shaderProgram, "uColor");
-    glUniform4f(colorLoc, r, g, b, a);
-
-    // Set projection to identity (we're using NDC)
-    GLint projLoc = glGetUniformLocation(shaderProgram, "uProjection");
-    float identity[16] = {
-        1, 0, 0, 0,
-        0, 1, 0, 0,
-        0, 0, 1, 0,
-        0, 0, 0, 1
+void Renderer::pushQuad(GLuint texture, float x1, float y1, float x2, float y2,
+                        float u1, float v1, float u2, float v2,
+                        float r, float g, float b, float a) {
+    // Extend the previous draw if it uses the same texture, otherwise start a new one
+    GLint first = (GLint)(batchVertices.size() / batchVertexFloats);
+    if (batches.empty() || batches.back().texture != texture) {
+        batches.push_back({texture, first, 0});
+    }
+    batches.back().count += 6;
+
+    const float quad[6][batchVertexFloats] = {
+        {x1, y1, u1, v1, r, g, b, a},  // bottom-left
+        {x2, y1, u2, v1, r, g, b, a},  // bottom-right
+        {x2, y2, u2, v2, r, g, b, a},  // top-right
+        {x1, y1, u1, v1, r, g, b, a},  // bottom-left
+        {x2, y2, u2, v2, r, g, b, a},  // top-right
+        {x1, y2, u1, v2, r, g, b, a}   // top-left
     };
-    glUniformMatrix4fv(projLoc, 1, GL_FALSE, identity);
-
-    // Upload vertices
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_DYNAMIC_DRAW);
-
-    // Draw
-    glDrawArrays(GL_TRIANGLES, 0, 6);
+    batchVertices.insert(batchVertices.end(), &quad[0][0], &quad[0][0] + 6 * batchVertexFloats);
+}
 
-    glBindVertexArray(0);
-    glUseProgram(0);
+void Renderer::drawRect(const Rect& rect, float r, float g, float b, float a) {
+    // Pixel coordinates; the projection UBO maps them to NDC
+    float x1 = (float)rect.x;
+    float y1 = (float)rect.y;
+    float x2 = (float)(rect.x + rect.width);
+    float y2 = (float)(rect.y + rect.height);
+
+    // Solid color: every vertex samples the atlas's white texel
+    pushQuad(glyphAtlas, x1, y1, x2, y2, whiteU, whiteV, whiteU, whiteV, r, g, b, a);
 }
 
 void Renderer::drawBorder(const Rect& rect, float r, float g, float b, float a, int borderWidth) {
@@ -188,340 +162,178 @@ void Renderer::drawBorder(const Rect& rect, float r, float g, float b, float a,
     drawRect({rect.x + rect.width - borderWidth, rect.y, borderWidth, rect.height}, r, g, b, a);
 }
 
-// Simple bitmap font - 5x7 pixels per character
-// Returns true if pixel should be drawn for given character at position (px, py)
-static bool getPixel(char c, int px, int py) {
-    // Very simple font for essential characters
-    // Each character is 5 pixels wide, 7 pixels tall
-    if (px < 0 || px >= 5 || py < 0 || py >= 7) return false;
-
-    // Keep case as-is (we have separate lowercase letters)
-
-    // Define character bitmaps (row by row, top to bottom)
-    static const uint32_t font[][7] = {
-        // '0' - index 0
-        {0b01110, 0b10001, 0b10011, 0b10101, 0b11001, 0b10001, 0b01110},
-        // '1' - index 1
-        {0b00100, 0b01100, 0b00100, 0b00100, 0b00100, 0b00100, 0b01110},
-        // '2' - index 2
-        {0b01110, 0b10001, 0b00001, 0b00010, 0b00100, 0b01000, 0b11111},
-        // '3' - index 3
-        {0b11111, 0b00010, 0b00100, 0b00010, 0b00001, 0b10001, 0b01110},
-        // '4' - index 4
-        {0b00010, 0b00110, 0b01010, 0b10010, 0b11111, 0b00010, 0b00010},
-        // '5' - index 5
-        {0b11111, 0b10000, 0b11110, 0b00001, 0b00001, 0b10001, 0b01110},
-        // '6' - index 6
-        {0b00110, 0b01000, 0b10000, 0b11110, 0b10001, 0b10001, 0b01110},
-        // '7' - index 7
-        {0b11111, 0b00001, 0b00010, 0b00100, 0b01000, 0b01000, 0b01000},
-        // '8' - index 8
-        {0b01110, 0b10001, 0b10001, 0b01110, 0b10001, 0b10001, 0b01110},
-        // '9' - index 9
-        {0b01110, 0b10001, 0b10001, 0b01111, 0b00001, 0b00010, 0b01100},
-        // 'A' - index 10
-        {0b01110, 0b10001, 0b10001, 0b11111, 0b10001, 0b10001, 0b10001},
-        // 'B' - index 11
-        {0b11110, 0b10001, 0b10001, 0b11110, 0b10001, 0b10001, 0b11110},
-        // 'C' - index 12
-        {0b01110, 0b10001, 0b10000, 0b10000, 0b10000, 0b10001, 0b01110},
-        // 'D' - index 13
-        {0b11110, 0b10001, 0b10001, 0b10001, 0b10001, 0b10001, 0b11110},
-        // 'E' - index 14
-        {0b11111, 0b10000, 0b10000, 0b11110, 0b10000, 0b10000, 0b11111},
-        // 'F' - index 15
-        {0b11111, 0b10000, 0b10000, 0b11110, 0b10000, 0b10000, 0b10000},
-        // 'G' - index 16
-        {0b01110, 0b10001, 0b10000, 0b10111, 0b10001, 0b10001, 0b01111},
-        // 'H' - index 17
-        {0b10001, 0b10001, 0b10001, 0b11111, 0b10001, 0b10001, 0b10001},
-        // 'I' - index 18
-        {0b01110, 0b00100, 0b00100, 0b00100, 0b00100, 0b00100, 0b01110},
-        // 'J' - index 19
-        {0b00111, 0b00010, 0b00010, 0b00010, 0b00010, 0b10010, 0b01100},
-        // 'K' - index 20
-        {0b10001, 0b10010, 0b10100, 0b11000, 0b10100, 0b10010, 0b10001},
-        // 'L' - index 21
-        {0b10000, 0b10000, 0b10000, 0b10000, 0b10000, 0b10000, 0b11111},
-        // 'M' - index 22
-        {0b10001, 0b11011, 0b10101, 0b10101, 0b10001, 0b10001, 0b10001},
-        // 'N' - index 23
-        {0b10001, 0b10001, 0b11001, 0b10101, 0b10011, 0b10001, 0b10001},
-        // 'O' - index 24
-        {0b01110, 0b10001, 0b10001, 0b10001, 0b10001, 0b10001, 0b01110},
-        // 'P' - index 25
-        {0b11110, 0b10001, 0b10001, 0b11110, 0b10000, 0b10000, 0b10000},
-        // 'Q' - index 26
-        {0b01110, 0b10001, 0b10001, 0b10001, 0b10101, 0b10010, 0b01101},
-        // 'R' - index 27
-        {0b11110, 0b10001, 0b10001, 0b11110, 0b10100, 0b10010, 0b10001},
-        // 'S' - index 28
-        {0b01111, 0b10000, 0b10000, 0b01110, 0b00001, 0b00001, 0b11110},
-        // 'T' - index 29
-        {0b11111, 0b00100, 0b00100, 0b00100, 0b00100, 0b00100, 0b00100},
-        // 'U' - index 30
-        {0b10001, 0b10001, 0b10001, 0b10001, 0b10001, 0b10001, 0b01110},
-        // 'V' - index 31
-        {0b10001, 0b10001, 0b10001, 0b10001, 0b10001, 0b01010, 0b00100},
-        // 'W' - index 32
-        {0b10001, 0b10001, 0b10001, 0b10101, 0b10101, 0b11011, 0b10001},
-        // 'X' - index 33
-        {0b10001, 0b10001, 0b01010, 0b00100, 0b01010, 0b10001, 0b10001},
-        // 'Y' - index 34
-        {0b10001, 0b10001, 0b10001, 0b01010, 0b00100, 0b00100, 0b00100},
-        // 'Z' - index 35
-        {0b11111, 0b00001, 0b00010, 0b00100, 0b01000, 0b10000, 0b11111},
-        // '.' - index 36
-        {0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b00100},
-        // ' ' - index 37 (space)
-        {0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000},
-        // 'a' - index 38
-        {0b00000, 0b00000, 0b01110, 0b00001, 0b01111, 0b10001, 0b01111},
-        // 'b' - index 39
-        {0b10000, 0b10000, 0b11110, 0b10001, 0b10001, 0b10001, 0b11110},
-        // 'c' - index 40
-        {0b00000, 0b00000, 0b01110, 0b10000, 0b10000, 0b10001, 0b01110},
-        // 'd' - index 41
-        {0b00001, 0b00001, 0b01111, 0b10001, 0b10001, 0b10001, 0b01111},
-        // 'e' - index 42
-        {0b00000, 0b00000, 0b01110, 0b10001, 0b11111, 0b10000, 0b01110},
-        // 'f' - index 43
-        {0b00110, 0b01001, 0b01000, 0b11110, 0b01000, 0b01000, 0b01000},
-        // 'g' - index 44
-        {0b00000, 0b00000, 0b01111, 0b10001, 0b01111, 0b00001, 0b01110},
-        // 'h' - index 45
-        {0b10000, 0b10000, 0b11110, 0b10001, 0b10001, 0b10001, 0b10001},
-        // 'i' - index 46
-        {0b00100, 0b00000, 0b01100, 0b00100, 0b00100, 0b00100, 0b01110},
-        // 'j' - index 47
-        {0b00010, 0b00000, 0b00110, 0b00010, 0b00010, 0b10010, 0b01100},
-        // 'k' - index 48
-        {0b10000, 0b10000, 0b10010, 0b10100, 0b11000, 0b10100, 0b10010},
-        // 'l' - index 49
-        {0b01100, 0b00100, 0b00100, 0b00100, 0b00100, 0b00100, 0b01110},
-        // 'm' - index 50
-        {0b00000, 0b00000, 0b11010, 0b10101, 0b10101, 0b10101, 0b10001},
-        // 'n' - index 51
-        {0b00000, 0b00000, 0b11110, 0b10001, 0b10001, 0b10001, 0b10001},
-        // 'o' - index 52
-        {0b00000, 0b00000, 0b01110, 0b10001, 0b10001, 0b10001, 0b01110},
-        // 'p' - index 53
-        {0b00000, 0b00000, 0b11110, 0b10001, 0b11110, 0b10000, 0b10000},
-        // 'q' - index 54
-        {0b00000, 0b00000, 0b01111, 0b10001, 0b01111, 0b00001, 0b00001},
-        // 'r' - index 55
-        {0b00000, 0b00000, 0b10110, 0b11001, 0b10000, 0b10000, 0b10000},
-        // 's' - index 56
-        {0b00000, 0b00000, 0b01111, 0b10000, 0b01110, 0b00001, 0b11110},
-        // 't' - index 57
-        {0b01000, 0b01000, 0b11110, 0b01000, 0b01000, 0b01001, 0b00110},
-        // 'u' - index 58
-        {0b00000, 0b00000, 0b10001, 0b10001, 0b10001, 0b10011, 0b01101},
-        // 'v' - index 59
-        {0b00000, 0b00000, 0b10001, 0b10001, 0b10001, 0b01010, 0b00100},
-        // 'w' - index 60
-        {0b00000, 0b00000, 0b10001, 0b10101, 0b10101, 0b10101, 0b01010},
-        // 'x' - index 61
-        {0b00000, 0b00000, 0b10001, 0b01010, 0b00100, 0b01010, 0b10001},
-        // 'y' - index 62
-        {0b00000, 0b00000, 0b10001, 0b10001, 0b01111, 0b00001, 0b01110},
-        // 'z' - index 63
-        {0b00000, 0b00000, 0b11111, 0b00010, 0b00100, 0b01000, 0b11111},
-        // '>' - index 64
-        {0b10000, 0b01000, 0b00100, 0b00010, 0b00100, 0b01000, 0b10000},
-        // '<' - index 65
-        {0b00001, 0b00010, 0b00100, 0b01000, 0b00100, 0b00010, 0b00001},
-        // ':' - index 66
-        {0b00000, 0b00100, 0b00000, 0b00000, 0b00000, 0b00100, 0b00000},
-        // ',' - index 67
-        {0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b00100, 0b01000},
-        // '/' - index 68
-        {0b00001, 0b00010, 0b00010, 0b00100, 0b01000, 0b01000, 0b10000},
-        // '-' - index 69
-        {0b00000, 0b00000, 0b00000, 0b11111, 0b00000, 0b00000, 0b00000},
-        // '_' - index 70
-        {0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b11111},
-        // '(' - index 71
-        {0b00010, 0b00100, 0b01000, 0b01000, 0b01000, 0b00100, 0b00010},
-        // ')' - index 72
-        {0b01000, 0b00100, 0b00010, 0b00010, 0b00010, 0b00100, 0b01000},
-        // '[' - index 73
-        {0b01110, 0b01000, 0b01000, 0b01000, 0b01000, 0b01000, 0b01110},
-        // ']' - index 74
-        {0b01110, 0b00010, 0b00010, 0b00010, 0b00010, 0b00010, 0b01110},
-        // '=' - index 75
-        {0b00000, 0b00000, 0b11111, 0b00000, 0b11111, 0b00000, 0b00000},
-        // '+' - index 76
-        {0b00000, 0b00100, 0b00100, 0b11111, 0b00100, 0b00100, 0b00000},
-        // '"' - index 77
-        {0b01010, 0b01010, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000},
-        // '\'' - index 78
-        {0b00100, 0b00100, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000},
-        // ';' - index 79
-        {0b00000, 0b00100, 0b00000, 0b00000, 0b00000, 0b00100, 0b01000},
-    };
+// Glyph atlas layout: 6x8 texel cells (5x7 glyph + 1 texel gutter)
+// The cell after the last glyph holds the solid white texel used for rects
+static const int atlasColumns = 16;
+static const int atlasCellWidth = 6;
+static const int atlasCellHeight = 8;
+
+bool Renderer::buildGlyphAtlas() {
+    int rows = (bitmapFontGlyphCount() + 1 + atlasColumns - 1) / atlasColumns;
+    atlasWidth = atlasColumns * atlasCellWidth;
+    atlasHeight = rows * atlasCellHeight;
+
+    // White RGBA texels, coverage in alpha
+    std::vector<uint8_t> pixels(atlasWidth * atlasHeight * 4, 0);
+    for (int idx = 0; idx < bitmapFontGlyphCount(); idx++) {
+        int cellX = (idx % atlasColumns) * atlasCellWidth;
+        int cellY = (idx / atlasColumns) * atlasCellHeight;
+        for (int py = 0; py < 7; py++) {
+            // Font rows go top-to-bottom, texture rows bottom-to-top
+            int texY = cellY + (6 - py);
+            for (int px = 0; px < 5; px++) {
+                if ((bitmapFontGlyph(idx)[py] >> (4 - px)) & 1) {
+                    uint8_t* texel = &pixels[(texY * atlasWidth + cellX + px) * 4];
+                    texel[0] = texel[1] = texel[2] = texel[3] = 255;
+                }
+            }
+        }
+    }
+
+    // Solid white texel, sampled at its center so nearest filtering never bleeds
+    int whiteX = (bitmapFontGlyphCount() % atlasColumns) * atlasCellWidth;
+    int whiteY = (bitmapFontGlyphCount() / atlasColumns) * atlasCellHeight;
+    uint8_t* white = &pixels[(whiteY * atlasWidth + whiteX) * 4];
+    white[0] = white[1] = white[2] = white[3] = 255;
+    whiteU = (whiteX + 0.5f) / atlasWidth;
+    whiteV = (whiteY + 0.5f) / atlasHeight;
+
+    glGenTextures(1, &glyphAtlas);
+    glBindTexture(GL_TEXTURE_2D, glyphAtlas);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, atlasWidth, atlasHeight, 0,
+                 GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    glBindTexture(GL_TEXTURE_2D, 0);
 
-    int idx = -1;
-    if (c >= '0' && c <= '9') idx = c - '0';
-    else if (c >= 'A' && c <= 'Z') idx = 10 + (c - 'A');
-    else if (c >= 'a' && c <= 'z') idx = 38 + (c - 'a');
-    else if (c == '.') idx = 36;
-    else if (c == ' ') idx = 37;
-    else if (c == '>') idx = 64;
-    else if (c == '<') idx = 65;
-    else if (c == ':') idx = 66;
-    else if (c == ',') idx = 67;
-    else if (c == '/') idx = 68;
-    else if (c == '-') idx = 69;
-    else if (c == '_') idx = 70;
-    else if (c == '(') idx = 71;
-    else if (c == ')') idx = 72;
-    else if (c == '[') idx = 73;
-    else if (c == ']') idx = 74;
-    else if (c == '=') idx = 75;
-    else if (c == '+') idx = 76;
-    else if (c == '"') idx = 77;
-    else if (c == '\'') idx = 78;
-    else if (c == ';') idx = 79;
-    else return false; // Unknown character
-
-    if (idx < 0) return false;
-
-    uint32_t row = font[idx][py];
-    return (row >> (4 - px)) & 1;
+    return glyphAtlas != 0;
 }
 
 void Renderer::drawText(const std::string& text, int x, int y, float r, float g, float b) {
-    // Draw simple bitmap text
+    // Emit one textured quad per glyph into the batch
     const int charWidth = 6;  // 5 pixels + 1 spacing
-    const int charHeight = 7;
     const int pixelSize = 4;  // Each font pixel is 4x4 screen pixels (doubled from 2x2)
 
+    // Font row 0 sits at [y, y + pixelSize], row 6 at [y - 6 * pixelSize, y - 5 * pixelSize]
+    float y1 = (float)(y - 6 * pixelSize);
+    float y2 = (float)(y + pixelSize);
+
     int cursorX = x;
     for (char c : text) {
-        // Draw each character
-        for (int py = 0; py < charHeight; py++) {
-            for (int px = 0; px < 5; px++) {
-                if (getPixel(c, px, py)) {
-                    // Draw a small rectangle for this pixel
-                    // Flip Y coordinate since OpenGL Y increases upward but font rows go top-to-bottom
-                    Rect pixelRect = {
-                        cursorX + px * pixelSize,
-                        y - py * pixelSize,  // Subtract py instead of add to flip vertically
-                        pixelSize,
-                        pixelSize
-                    };
-                    drawRect(pixelRect, r, g, b, 1.0f);
-                }
-            }
+        int idx = bitmapFontIndex(c);
+        if (idx >= 0 && c != ' ') {  // Space has no texels
+            float x1 = (float)cursorX;
+            float x2 = (float)(cursorX + 5 * pixelSize);
+
+            float u1 = (float)((idx % atlasColumns) * atlasCellWidth) / atlasWidth;
+            float v1 = (float)((idx / atlasColumns) * atlasCellHeight) / atlasHeight;
+            float u2 = u1 + 5.0f / atlasWidth;
+            float v2 = v1 + 7.0f / atlasHeight;
+
+            pushQuad(glyphAtlas, x1, y1, x2, y2, u1, v1, u2, v2, r, g, b, 1.0f);
         }
         cursorX += charWidth * pixelSize;
     }
 }
 
-void Renderer::setViewport(int x, int y, int width, int height) {
-    glViewport(x, y, width, height);
-}
+void Renderer::drawTexture(GLuint texture, const Rect& rect) {
+    if (texture == 0) return;
 
-GLuint Renderer::compileShader(const char* source, GLenum shaderType) {
-    GLuint shader = glCreateShader(shaderType);
-    glShaderSource(shader, 1, &source, nullptr);
-    glCompileShader(shader);
-
-    // Check for compilation errors
-    GLint success;
-    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        char infoLog[512];
-        glGetShaderInfoLog(shader, 512, nullptr, infoLog);
-        std::cerr << "Shader compilation failed:\n" << infoLog << "\n";
-        return 0;
-    }
+    // Pixel coordinates; the projection UBO maps them to NDC
+    float x1 = (float)rect.x;
+    float y1 = (float)rect.y;
+    float x2 = (float)(rect.x + rect.width);
+    float y2 = (float)(rect.y + rect.height);
 
-    return shader;
+    pushQuad(texture, x1, y1, x2, y2, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f);
 }
 
-GLuint Renderer::createShaderProgram(const char* vertexSrc, const char* fragmentSrc) {
-    GLuint vertexShader = compileShader(vertexSrc, GL_VERTEX_SHADER);
-    if (vertexShader == 0) return 0;
+void Renderer::flush() {
+    if (batchVertices.empty()) return;
 
-    GLuint fragmentShader = compileShader(fragmentSrc, GL_FRAGMENT_SHADER);
-    if (fragmentShader == 0) {
-        glDeleteShader(vertexShader);
-        return 0;
-    }
+    GLState& state = GLState::get();
+    state.useProgram(batchShader.getProgram());
+    state.bindVertexArray(batchVAO);
+    state.bindBuffer(GL_ARRAY_BUFFER, batchVBO);
+    state.setBlend(true);
 
-    GLuint program = glCreateProgram();
-    glAttachShader(program, vertexShader);
-    glAttachShader(program, fragmentShader);
-    glLinkProgram(program);
-
-    // Check for linking errors
-    GLint success;
-    glGetProgramiv(program, GL_LINK_STATUS, &success);
-    if (!success) {
-        char infoLog[512];
-        glGetProgramInfoLog(program, 512, nullptr, infoLog);
-        std::cerr << "Shader program linking failed:\n" << infoLog << "\n";
-        glDeleteShader(vertexShader);
-        glDeleteShader(fragmentShader);
-        return 0;
+    // Grow storage geometrically; otherwise orphan it so the driver never
+    // stalls on last frame's draws, then upload this frame's vertices
+    GLsizeiptr bytes = batchVertices.size() * sizeof(float);
+    if (bytes > batchCapacity) {
+        batchCapacity = std::max<GLsizeiptr>(bytes, batchCapacity * 2);
+    }
+    glBufferData(GL_ARRAY_BUFFER, batchCapacity, nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, batchVertices.data());
+    state.countCall(2);
+
+    // Painter's order is preserved: only adjacent quads sharing a texture are merged
+    for (const auto& batch : batches) {
+        state.bindTexture(batch.texture);
+        glDrawArrays(GL_TRIANGLES, batch.first, batch.count);
+        state.countCall();
     }
 
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
+    // Program and VAO stay bound across frames; textures are released because
+    // the compositor may delete (and recycle the name of) a video texture
+    state.bindTexture(0);
 
-    return program;
+    batchVertices.clear();
+    batches.clear();
 }
 
-void Renderer::drawTexture(GLuint texture, const Rect& rect) {
-    if (texture == 0) return;
+void Renderer::setViewport(int x, int y, int width, int height) {
+    // The compositor leaves the viewport at output size, so always restore it
+    glViewport(x, y, width, height);
+    GLState::get().countCall();
+
+    viewportWidth = width;
+    viewportHeight = height;
+    setProjection({0, 0, width, height});
+}
 
-    // Get current viewport
-    GLint viewport[4];
-    glGetIntegerv(GL_VIEWPORT, viewport);
-    int viewportWidth = viewport[2];
-    int viewportHeight = viewport[3];
-
-    // Convert screen coordinates to normalized device coordinates
-    float x1 = (rect.x * 2.0f / viewportWidth) - 1.0f;
-    float y1 = (rect.y * 2.0f / viewportHeight) - 1.0f;
-    float x2 = ((rect.x + rect.width) * 2.0f / viewportWidth) - 1.0f;
-    float y2 = ((rect.y + rect.height) * 2.0f / viewportHeight) - 1.0f;
-
-    // Vertex data: position (x, y) and texture coordinates (u, v)
-    float vertices[] = {
-        // Bottom-left
-        x1, y1, 0.0f, 0.0f,
-        // Bottom-right
-        x2, y1, 1.0f, 0.0f,
-        // Top-right
-        x2, y2, 1.0f, 1.0f,
-        // Bottom-left
-        x1, y1, 0.0f, 0.0f,
-        // Top-right
-        x2, y2, 1.0f, 1.0f,
-        // Top-left
-        x1, y2, 0.0f, 1.0f
+void Renderer::setProjection(const Rect& region) {
+    if (region.x == projectionRegion.x && region.y == projectionRegion.y &&
+        region.width == projectionRegion.width && region.height == projectionRegion.height) {
+        return;
+    }
+    projectionRegion = region;
+
+    // Orthographic projection: region pixels (origin bottom-left) to NDC, column-major
+    float sx = 2.0f / region.width;
+    float sy = 2.0f / region.height;
+    const float projection[16] = {
+        sx,                     0.0f,                   0.0f, 0.0f,
+        0.0f,                   sy,                     0.0f, 0.0f,
+        0.0f,                   0.0f,                  -1.0f, 0.0f,
+        -1.0f - region.x * sx,  -1.0f - region.y * sy,  0.0f, 1.0f
     };
+    GLState& state = GLState::get();
+    state.bindBuffer(GL_UNIFORM_BUFFER, projectionUBO);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(projection), projection);
+    state.countCall();
+}
 
-    glUseProgram(textureShaderProgram);
-    glBindVertexArray(textureVAO);
+void Renderer::beginTarget(DisplayBuffer& target, const Rect& region) {
+    // Set the frame's pending quads aside; offscreen quads batch on their own
+    std::swap(batchVertices, stashedVertices);
+    std::swap(batches, stashedBatches);
 
-    // Bind texture
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, texture);
-    GLint texLoc = glGetUniformLocation(textureShaderProgram, "uTexture");
-    glUniform1i(texLoc, 0);
+    target.bind();
+    setProjection(region);
+    activeTarget = &target;
+}
 
-    // Upload vertices
-    glBindBuffer(GL_ARRAY_BUFFER, textureVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_DYNAMIC_DRAW);
+void Renderer::endTarget() {
+    if (!activeTarget) return;
 
-    // Draw
-    glDrawArrays(GL_TRIANGLES, 0, 6);
+    flush();
+    activeTarget->unbind();
+    activeTarget = nullptr;
 
-    glBindVertexArray(0);
-    glBindTexture(GL_TEXTURE_2D, 0);
-    glUseProgram(0);
+    std::swap(batchVertices, stashedVertices);
+    std::swap(batches, stashedBatches);
+    setViewport(0, 0, viewportWidth, viewportHeight);
 }
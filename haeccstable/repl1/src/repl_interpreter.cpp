@@ -4,11 +4,13 @@
 #include "layer.h"
 #include "output_variable.h"
 #include "dossier_manager.h"
-#include <sstream>
-#include <algorithm>
+#include "render_graph.h"
 #include <iostream>
 
-ReplInterpreter::ReplInterpreter() : lastWasPrintln(true), dossierManager(nullptr) {
+ReplInterpreter::ReplInterpreter()
+    : dossierManager(nullptr), lastWasPrintln(true), hasQueuedCode(false), bindingsChanged(false),
+      startTime(std::chrono::steady_clock::now()), pipelineTime(0.0), hasPipelineTime(false),
+      lastBindingMicros(0.0) {
     // Initialize virtual monitors at startup
     // They will display black screens until layers are projected onto them
 
@@ -23,19 +25,19 @@ ReplInterpreter::ReplInterpreter() : lastWasPrintln(true), dossierManager(nullpt
     std::cout << "Initialized virtual monitor2 (1080x1920 mobile)\n";
 }
 
-std::string ReplInterpreter::trim(const std::string& str) {
-    size_t start = str.find_first_not_of(" \t\n\r");
-    if (start == std::string::npos) return "";
-    size_t end = str.find_last_not_of(" \t\n\r");
-    return str.substr(start, end - start + 1);
-}
-
 void ReplInterpreter::clear() {
     variables.clear();
     videoVariables.clear();
     layers.clear();
     outputVariables.clear();
     inputSources.clear();
+    processSources.clear();
+    declaredObjects.clear();
+    sourceSignatures.clear();
+    layerSignatures.clear();
+    outputSignatures.clear();
+    layerBindings.clear();
+    bindingsChanged = true;
     lastWasPrintln = true;
 }
 
@@ -43,6 +45,10 @@ void ReplInterpreter::setDossierManager(std::shared_ptr<DossierManager> dossier)
     dossierManager = dossier;
 }
 
+void ReplInterpreter::setVideoSourceFactory(std::function<std::shared_ptr<VideoSource>(int)> factory) {
+    videoSourceFactory = factory;
+}
+
 std::shared_ptr<VideoVariable> ReplInterpreter::getVideoVariable(const std::string& name) {
     auto it = videoVariables.find(name);
     if (it != videoVariables.end()) {
@@ -67,7 +73,78 @@ std::shared_ptr<OutputVariable> ReplInterpreter::getOutputVariable(const std::st
     return nullptr;
 }
 
+void ReplInterpreter::setPipelineTime(double seconds) {
+    pipelineTime = seconds;
+    hasPipelineTime = true;
+}
+
+size_t ReplInterpreter::getBindingCount() const {
+    size_t count = 0;
+    for (const auto& [name, bindings] : layerBindings) {
+        count += bindings.size();
+    }
+    return count;
+}
+
+void ReplInterpreter::packBindings() {
+    packedCode.clear();
+    packedBindings.clear();
+    for (const auto& [name, bindings] : layerBindings) {
+        bool first = true;
+        for (const auto& binding : bindings) {
+            PackedBinding packed;
+            packed.layer = binding.layer.get();
+            packed.method = binding.method;
+            packed.firstOfLayer = first;
+            packed.x = (uint32_t)packedCode.size();
+            packed.xCount = (uint32_t)binding.x.code.size();
+            packedCode.insert(packedCode.end(), binding.x.code.begin(), binding.x.code.end());
+            packed.y = (uint32_t)packedCode.size();
+            packed.yCount = (uint32_t)binding.y.code.size();
+            packedCode.insert(packedCode.end(), binding.y.code.begin(), binding.y.code.end());
+            packedBindings.push_back(packed);
+            first = false;
+        }
+    }
+    bindingsChanged = false;
+}
+
+void ReplInterpreter::evaluateBindings(float t) {
+    if (bindingsChanged) {
+        packBindings();
+    }
+
+    const ReplBytecode::Instruction* code = packedCode.data();
+    for (const auto& binding : packedBindings) {
+        // All of a layer's bindings are re-applied from scratch each frame
+        Layer& layer = *binding.layer;
+        if (binding.firstOfLayer) {
+            layer.clearAnimation();
+        }
+
+        float x = ReplBytecode::run(code + binding.x, binding.xCount, t);
+        float y = ReplBytecode::run(code + binding.y, binding.yCount, t);
+        switch (binding.method) {
+        case ReplMethod::TRANSFORM: layer.animateTransform(x, y); break;
+        case ReplMethod::SCALE:     layer.animateScale(x, y); break;
+        case ReplMethod::ROT:       layer.animateRot(x, y); break;
+        case ReplMethod::OPACITY:   layer.animateOpacity(x); break;
+        default: break;
+        }
+    }
+}
+
 void ReplInterpreter::executeVideoPipeline() {
+    // Animated layer properties for this frame
+    if (!layerBindings.empty() || bindingsChanged) {
+        using Clock = std::chrono::steady_clock;
+        double t = hasPipelineTime ? pipelineTime
+                                   : std::chrono::duration<double>(Clock::now() - startTime).count();
+        auto bindingStart = Clock::now();
+        evaluateBindings((float)t);
+        lastBindingMicros = std::chrono::duration<double, std::micro>(Clock::now() - bindingStart).count();
+    }
+
     // Execute all video variables (lazy: only fetches new frames) - legacy
     for (auto& [name, var] : videoVariables) {
         if (var->getType() == VideoVarType::INPUT) {
@@ -85,9 +162,20 @@ void ReplInterpreter::executeVideoPipeline() {
     // Composite all output variables
     for (auto& [name, output] : outputVariables) {
         if (output) {
-            // TODO: Get actual output dimensions from target display
-            // For now, use default 1920x1080
-            output->composite(1920, 1080);
+            // Physical monitor targets composite at the monitor's native resolution
+            int width = 1920;
+            int height = 1080;
+            if (dossierManager) {
+                int monitorIndex = dossierManager->findPhysicalMonitor(output->getTarget());
+                if (monitorIndex >= 0) {
+                    const auto& monitor = dossierManager->getMonitors()[monitorIndex];
+                    if (monitor.width > 0 && monitor.height > 0) {
+                        width = monitor.width;
+                        height = monitor.height;
+                    }
+                }
+            }
+            output->composite(width, height);
         }
     }
 }
@@ -96,369 +184,951 @@ void ReplInterpreter::setOutputCallback(std::function<void(const std::string&)>
     outputCallback = callback;
 }
 
+std::shared_ptr<const ReplProgram> ReplInterpreter::compile(const std::string& code) {
+    std::lock_guard<std::mutex> lock(programCacheMutex);
+    uint64_t hash = hashReplSource(code);
+    auto it = programCache.find(hash);
+    if (it != programCache.end() && it->second->source == code) {
+        return it->second;
+    }
+
+    // Edited buffers produce a new program per run; drop old ones wholesale
+    const size_t maxCachedPrograms = 32;
+    if (programCache.size() >= maxCachedPrograms) {
+        programCache.clear();
+    }
+
+    std::shared_ptr<const ReplProgram> program = compileReplProgram(code);
+    programCache[hash] = program;
+    std::cout << "Compiled REPL program: " << program->statements.size() << " statements, "
+              << program->errors.size() << " errors\n";
+    return program;
+}
+
 std::vector<std::string> ReplInterpreter::execute(const std::string& code) {
-    outputLines.clear();
-    lastWasPrintln = true;  // Start fresh
+    return execute(*compile(code));
+}
 
-    // Split code into lines
-    std::istringstream stream(code);
-    std::string line;
+void ReplInterpreter::submit(const std::string& code) {
+    if (pendingRun) {
+        queuedCode = code;
+        hasQueuedCode = true;
+        std::cout << "REPL run queued behind the pending one\n";
+        return;
+    }
+    startRun(code);
+}
 
-    while (std::getline(stream, line)) {
-        line = trim(line);
-        if (!line.empty() && line[0] != '/' && line[0] != '#') {  // Skip comments
-            executeLine(line);
+void ReplInterpreter::startRun(const std::string& code) {
+    // Device in_vars that are open now, with the text that declared them. The
+    // worker opens every other device in_var; one whose text is unchanged is
+    // kept by execute() and never reopened (same rule as sourceSignatures).
+    std::map<std::string, std::string> openSources;
+    for (const auto& [name, source] : inputSources) {
+        auto signature = sourceSignatures.find(name);
+        if (signature != sourceSignatures.end()) {
+            openSources[name] = signature->second;
         }
     }
 
-    return outputLines;
-}
-
-void ReplInterpreter::executeLine(const std::string& line) {
-    // Remove trailing semicolon
-    std::string stmt = line;
-    if (!stmt.empty() && stmt.back() == ';') {
-        stmt = stmt.substr(0, stmt.length() - 1);
-    }
-    stmt = trim(stmt);
-
-    // Check for in_var (video input): in_var videoIn = 0;
-    if (stmt.find("in_var ") == 0) {
-        size_t equalPos = stmt.find('=');
-        if (equalPos != std::string::npos) {
-            std::string varPart = stmt.substr(7, equalPos - 7);
-            std::string valuePart = stmt.substr(equalPos + 1);
-
-            std::string varName = trim(varPart);
-            std::string deviceStr = trim(valuePart);
-
-            // Open video source
-            auto source = std::make_shared<VideoSource>();
-            int deviceIndex = std::stoi(deviceStr);  // Simple: assume device index for now
-            if (source->open(deviceIndex)) {
-                // Store source for layer casting
-                inputSources[varName] = source;
-
-                // Also create legacy video variable for backward compatibility
-                auto videoVar = std::make_shared<VideoVariable>(varName, VideoVarType::INPUT);
-                videoVar->setSource(source);
-                videoVariables[varName] = videoVar;
-
-                std::cout << "Created in_var " << varName << " (device " << deviceIndex << ")\n";
-
-                // Register with dossier
-                if (dossierManager) {
-                    dossierManager->registerInputVariable(varName, deviceIndex, source);
-                }
+    auto factory = videoSourceFactory;
+    auto run = std::make_shared<PreparedRun>();
+    pendingRun = run;
+    prepareTasks.run([this, run, code, factory, openSources]() {
+        auto start = std::chrono::steady_clock::now();
+        run->program = compile(code);
+
+        for (const auto& statement : run->program->statements) {
+            if (statement.type != ReplStatementType::IN_VAR || statement.process) continue;
+            auto open = openSources.find(statement.name);
+            if (open != openSources.end() && open->second == statement.text + "\n") continue;
+
+            std::shared_ptr<VideoSource> source;
+            if (factory) {
+                source = factory(statement.deviceIndex);
             } else {
-                std::cerr << "Failed to open video device " << deviceIndex << "\n";
+                source = std::make_shared<VideoSource>();
+                if (!source->open(statement.deviceIndex)) {
+                    source.reset();
+                }
             }
+            run->sources[statement.name] = source;
         }
-        return;
+
+        run->prepareMillis =
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    });
+}
+
+bool ReplInterpreter::applyPendingRun(std::vector<std::string>& outputs) {
+    if (!pendingRun || !prepareTasks.isDone()) {
+        return false;
     }
 
-    // Check for out_var (video output): out_var videoOut = monitor1;
-    if (stmt.find("out_var ") == 0) {
-        size_t equalPos = stmt.find('=');
-        if (equalPos != std::string::npos) {
-            std::string varPart = stmt.substr(8, equalPos - 8);
-            std::string valuePart = stmt.substr(equalPos + 1);
+    auto run = std::move(pendingRun);
+    pendingRun.reset();
+    auto start = std::chrono::steady_clock::now();
+    preparedSources = std::move(run->sources);
+    outputs = execute(*run->program);
+    preparedSources.clear();  // Opened for in_vars that were kept after all
+    double applyMillis =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "REPL run prepared in " << run->prepareMillis << " ms off the render thread, applied in "
+              << applyMillis << " ms\n";
+
+    if (hasQueuedCode) {
+        hasQueuedCode = false;
+        startRun(queuedCode);
+        queuedCode.clear();
+    }
+    return true;
+}
 
-            std::string varName = trim(varPart);
-            std::string target = trim(valuePart);
+std::vector<std::string> ReplInterpreter::execute(const ReplProgram& program) {
+    outputLines.clear();
+    lastWasPrintln = true;  // Start fresh
 
-            // Create output variable with layer stack
-            auto output = std::make_shared<OutputVariable>(varName, target);
-            outputVariables[varName] = output;
+    for (const auto& error : program.errors) {
+        std::cerr << "ERROR: REPL " << error << "\n";
+    }
 
-            // Also create legacy video variable for backward compatibility
-            auto videoVar = std::make_shared<VideoVariable>(varName, VideoVarType::OUTPUT);
-            videoVar->setTarget(target);
-            videoVariables[varName] = videoVar;
+    // Objects this program declares
+    std::map<std::string, ReplStatementType> declared;
+    for (const auto& statement : program.statements) {
+        if (statement.type == ReplStatementType::IN_VAR ||
+            statement.type == ReplStatementType::OUT_VAR ||
+            statement.type == ReplStatementType::LAYER_OBJ) {
+            declared[statement.name] = statement.type;
+        }
+    }
+    auto isDeclared = [&declared](const std::string& name, ReplStatementType kind) {
+        auto it = declared.find(name);
+        return it != declared.end() && it->second == kind;
+    };
+
+    // The object a statement creates or configures; false for var/print and
+    // statements on unknown objects, which always run
+    struct Owner {
+        ReplStatementType kind;
+        const std::string* name;
+    };
+    auto ownerOf = [&](const ReplStatement& statement, Owner& owner) {
+        switch (statement.type) {
+        case ReplStatementType::IN_VAR:
+        case ReplStatementType::OUT_VAR:
+        case ReplStatementType::LAYER_OBJ:
+            owner = {statement.type, &statement.name};
+            return true;
+        case ReplStatementType::SET_CANVAS:
+            owner = {ReplStatementType::LAYER_OBJ, &statement.name};
+            return isDeclared(statement.name, ReplStatementType::LAYER_OBJ);
+        case ReplStatementType::METHOD_CALL:
+            if (isDeclared(statement.name, ReplStatementType::LAYER_OBJ)) {
+                owner = {ReplStatementType::LAYER_OBJ, &statement.name};
+                return true;
+            }
+            if (statement.method == ReplMethod::CAST &&
+                isDeclared(statement.args[0].text, ReplStatementType::LAYER_OBJ)) {
+                owner = {ReplStatementType::LAYER_OBJ, &statement.args[0].text};
+                return true;
+            }
+            if (statement.method == ReplMethod::PROJECT &&
+                (isDeclared(statement.name, ReplStatementType::OUT_VAR) ||
+                 (!declared.count(statement.name) && outputVariables.count(statement.name)))) {
+                owner = {ReplStatementType::OUT_VAR, &statement.name};
+                return true;
+            }
+            return false;
+        default:
+            return false;
+        }
+    };
+
+    // Method arguments can read vars, whose values come from the var statements
+    std::string varTexts;
+    bool haveVarTexts = false;
+    auto getVarTexts = [&]() -> const std::string& {
+        if (!haveVarTexts) {
+            for (const auto& statement : program.statements) {
+                if (statement.type == ReplStatementType::VAR) {
+                    varTexts += statement.text;
+                    varTexts += '\n';
+                }
+            }
+            haveVarTexts = true;
+        }
+        return varTexts;
+    };
+
+    // Signature of each object: the statements that build it, in order.
+    // A layer also depends on the sources cast to it, and on the vars when it reads them.
+    std::map<std::string, std::string> sources, layerTexts, outputTexts;
+    std::map<std::string, bool> projectsNewLayer;
+    for (const auto& statement : program.statements) {
+        Owner owner;
+        if (!ownerOf(statement, owner)) continue;
+
+        auto& signatures = owner.kind == ReplStatementType::IN_VAR ? sources
+                         : owner.kind == ReplStatementType::LAYER_OBJ ? layerTexts : outputTexts;
+        std::string& signature = signatures[*owner.name];
+        signature += statement.text;
+        signature += '\n';
+        if (statement.type == ReplStatementType::METHOD_CALL && statement.method != ReplMethod::CAST &&
+            statement.method != ReplMethod::PROJECT) {
+            for (const auto& arg : statement.args) {
+                if (arg.bytecode.usesVariables) {
+                    signature += "{" + getVarTexts() + "}\n";
+                    break;
+                }
+            }
+        }
+        if (statement.method == ReplMethod::CAST && statement.type == ReplStatementType::METHOD_CALL) {
+            signature += "<" + sources[statement.name] + ">\n";
+        }
+        if (statement.process) {
+            // A process in_var is rebuilt when any process block or earlier source changes
+            for (const auto& [processName, process] : program.processes) {
+                signature += process.text + "\n";
+            }
+            for (const auto& [sourceName, sourceSignature] : sources) {
+                if (sourceName != statement.name) signature += "<" + sourceSignature + ">\n";
+            }
+        }
+        if (statement.method == ReplMethod::PROJECT && !layers.count(statement.args[0].text)) {
+            projectsNewLayer[*owner.name] = true;
+        }
+    }
 
-            std::cout << "Created out_var " << varName << " -> " << target << "\n";
+    // Tear down objects the program no longer declares
+    int removed = 0;
+    for (const auto& [name, kind] : declaredObjects) {
+        if (!isDeclared(name, kind)) {
+            removeObject(name, kind);
+            removed++;
+        }
+    }
 
-            // Register with dossier
-            if (dossierManager) {
-                dossierManager->registerOutputVariable(varName, target, output);
+    // Decide what survives: unchanged sources stay open, changed layers and
+    // outputs are reset in place (keeping their GL resources) and replayed
+    std::map<std::string, bool> keepSource, replayLayer, replayOutput;
+    int kept = 0;
+    for (const auto& [name, signature] : sources) {
+        auto previous = sourceSignatures.find(name);
+        keepSource[name] = (inputSources.count(name) || processSources.count(name)) &&
+                           previous != sourceSignatures.end() &&
+                           previous->second == signature;
+        if (keepSource[name]) kept++;
+    }
+    for (const auto& [name, signature] : layerTexts) {
+        auto layer = getLayer(name);
+        auto previous = layerSignatures.find(name);
+        bool changed = previous == layerSignatures.end() || previous->second != signature;
+        replayLayer[name] = !layer || changed;
+        if (layer && changed) {
+            layer->reset();
+            bindingsChanged = bindingsChanged || layerBindings.erase(name) > 0;
+        } else if (layer) {
+            kept++;
+        }
+    }
+    for (const auto& statement : program.statements) {
+        // A changed out_var target needs a new output
+        if (statement.type == ReplStatementType::OUT_VAR) {
+            auto output = getOutputVariable(statement.name);
+            if (output && output->getTarget() != statement.target) {
+                removeObject(statement.name, ReplStatementType::OUT_VAR);
             }
         }
-        return;
+    }
+    for (const auto& [name, output] : outputVariables) {
+        auto text = outputTexts.find(name);
+        auto previous = outputSignatures.find(name);
+        std::string signature = text != outputTexts.end() ? text->second : "";
+        std::string previousSignature = previous != outputSignatures.end() ? previous->second : "";
+        replayOutput[name] = signature != previousSignature || projectsNewLayer[name];
+        if (replayOutput[name]) {
+            if (!output->getLayerStack().empty()) {
+                output->clearLayers();
+            }
+        } else {
+            kept++;
+        }
     }
 
-    // Check for variable assignment: var x = "value";
-    if (stmt.find("var ") == 0) {
-        size_t equalPos = stmt.find('=');
-        if (equalPos != std::string::npos) {
-            std::string varPart = stmt.substr(4, equalPos - 4);
-            std::string valuePart = stmt.substr(equalPos + 1);
+    auto shouldRun = [&](const ReplStatement& statement) {
+        Owner owner;
+        if (!ownerOf(statement, owner)) return true;
+
+        const std::string& name = *owner.name;
+        if (owner.kind == ReplStatementType::IN_VAR) {
+            return !keepSource[name];
+        }
+        if (owner.kind == ReplStatementType::LAYER_OBJ) {
+            // A reset layer is reused rather than declared again
+            return replayLayer[name] &&
+                   (statement.type != ReplStatementType::LAYER_OBJ || !getLayer(name));
+        }
+        if (statement.type == ReplStatementType::OUT_VAR) {
+            return !getOutputVariable(name);
+        }
+        // Outputs created during this run aren't in replayOutput
+        auto replay = replayOutput.find(name);
+        return replay == replayOutput.end() || replay->second;
+    };
+
+    // Statements run one by one, except ';' groups: checked as a whole first,
+    // then applied together or not at all
+    int executed = 0;
+    const auto& statements = program.statements;
+    std::vector<const ReplStatement*> group;
+    for (size_t i = 0; i < statements.size();) {
+        size_t end = i + 1;
+        while (statements[i].group != 0 && end < statements.size() &&
+               statements[end].group == statements[i].group) {
+            end++;
+        }
 
-            std::string varName = trim(varPart);
-            std::string value = evaluateExpression(trim(valuePart));
+        group.clear();
+        for (size_t k = i; k < end; k++) {
+            if (shouldRun(statements[k])) {
+                group.push_back(&statements[k]);
+            }
+        }
+        i = end;
 
-            variables[varName] = value;
-            std::cout << "Set variable " << varName << " = " << value << "\n";
+        std::string error;
+        if (group.size() > 1 && !checkGroup(group, program, error)) {
+            std::cerr << "ERROR: REPL line " << group[0]->line << ": group not applied: " << error << "\n";
+            continue;
+        }
+        for (const ReplStatement* statement : group) {
+            executeStatement(*statement, program);
+            executed++;
         }
-        return;
     }
+    preparedGraphs.clear();  // Left over only when a group declared a name twice
+    commitDossier();
 
-    // Check for layer_obj declaration: layer_obj myLayer;
-    if (stmt.find("layer_obj ") == 0) {
-        std::string layerName = trim(stmt.substr(10));
-        auto layer = std::make_shared<Layer>(layerName);
-        layers[layerName] = layer;
-        std::cout << "Created layer_obj '" << layerName << "'\n";
+    declaredObjects = std::move(declared);
+    lastProgramSource = program.source;
+    sourceSignatures = std::move(sources);
+    layerSignatures = std::move(layerTexts);
+    outputSignatures = std::move(outputTexts);
 
-        // Register with dossier
-        if (dossierManager) {
-            dossierManager->registerLayer(layerName, layer);
+    std::cout << "REPL run: executed " << executed << " of " << program.statements.size()
+              << " statements, kept " << kept << " objects, removed " << removed << "\n";
+    return outputLines;
+}
+
+void ReplInterpreter::captureSnapshot(SessionSnapshot& snapshot) {
+    snapshot = SessionSnapshot();
+    snapshot.program = lastProgramSource;
+
+    // Device indices are in the program (cached, so this doesn't recompile)
+    std::map<std::string, int> deviceIndices;
+    for (const auto& statement : compile(lastProgramSource)->statements) {
+        if (statement.type == ReplStatementType::IN_VAR && !statement.process) {
+            deviceIndices[statement.name] = statement.deviceIndex;
         }
-        return;
     }
 
-    // Check for property assignment with dot notation: layer.canvas = (1920, 1080);
-    size_t dotPos = stmt.find('.');
-    size_t equalPos = stmt.find('=');
-    if (dotPos != std::string::npos && equalPos != std::string::npos && dotPos < equalPos) {
-        std::string objectName = trim(stmt.substr(0, dotPos));
-        std::string propertyName = trim(stmt.substr(dotPos + 1, equalPos - dotPos - 1));
-        std::string valuePart = trim(stmt.substr(equalPos + 1));
-
-        auto layer = getLayer(objectName);
-        if (layer) {
-            if (propertyName == "canvas") {
-                auto values = parseTuple(valuePart);
-                if (values.size() == 2) {
-                    int w = std::stoi(values[0]);
-                    int h = std::stoi(values[1]);
-                    layer->setCanvas(w, h);
-                    std::cout << "Layer '" << objectName << "' canvas = (" << w << ", " << h << ")\n";
-
-                    // Register with dossier
-                    if (dossierManager) {
-                        dossierManager->registerLayer(objectName, layer);
-                    }
-                }
+    for (const auto& [name, source] : inputSources) {
+        SessionSnapshot::Source record;
+        record.name = name;
+        auto device = deviceIndices.find(name);
+        record.deviceIndex = device != deviceIndices.end() ? device->second : -1;
+        if (dossierManager) {
+            auto info = dossierManager->getInputVariables().find(name);
+            if (info != dossierManager->getInputVariables().end()) {
+                record.deviceName = info->second.deviceName;
             }
         }
-        return;
+        if (source && source->isOpen()) {
+            record.width = source->getWidth();
+            record.height = source->getHeight();
+        }
+        snapshot.sources.push_back(std::move(record));
+    }
+    for (const auto& [name, graph] : processSources) {
+        SessionSnapshot::Source record;
+        record.name = name;
+        record.width = graph->getWidth();
+        record.height = graph->getHeight();
+        for (const auto& input : graph->getInputs()) {
+            record.inputSizes.push_back({input->getWidth(), input->getHeight()});
+        }
+        snapshot.sources.push_back(std::move(record));
     }
 
-    // Check for method call: object.method(args);
-    MethodCall call;
-    if (parseMethodCall(stmt, call)) {
-        executeMethodCall(call);
-        return;
+    for (const auto& [name, layer] : layers) {
+        if (!layer) continue;
+        SessionSnapshot::Layer record;
+        record.name = name;
+        record.canvasWidth = layer->getCanvasWidth();
+        record.canvasHeight = layer->getCanvasHeight();
+        record.framebufferWidth = layer->getFramebufferWidth();
+        record.framebufferHeight = layer->getFramebufferHeight();
+        Layer::Transform transform = layer->getTransform();
+        record.posX = transform.posX;
+        record.posY = transform.posY;
+        record.scaleX = transform.scaleX;
+        record.scaleY = transform.scaleY;
+        record.rotXY = transform.rotXY;
+        record.rotY = transform.rotY;
+        record.opacity = transform.opacity;
+        for (const auto& [sourceName, source] : inputSources) {
+            if (layer->getSource() && source == layer->getSource()) record.sourceName = sourceName;
+        }
+        for (const auto& [sourceName, graph] : processSources) {
+            if (layer->getProcess() && graph == layer->getProcess()) record.sourceName = sourceName;
+        }
+        snapshot.layers.push_back(std::move(record));
     }
 
-    // Check for println(x)
-    if (stmt.find("println(") == 0) {
-        size_t endParen = stmt.find(')');
-        if (endParen != std::string::npos) {
-            std::string expr = stmt.substr(8, endParen - 8);
-            std::string result = evaluateExpression(trim(expr));
-            outputLines.push_back(result);
-            lastWasPrintln = true;  // Mark that we completed a line
-            if (outputCallback) {
-                outputCallback(result);
-            }
+    for (const auto& [name, output] : outputVariables) {
+        if (!output) continue;
+        SessionSnapshot::Output record;
+        record.name = name;
+        record.target = output->getTarget();
+        record.width = output->getOutputWidth();
+        record.height = output->getOutputHeight();
+        for (const auto& entry : output->getLayerStack()) {
+            if (entry.layer) record.stack.push_back({entry.layer->getName(), entry.zIndex});
         }
-        return;
+        snapshot.outputs.push_back(std::move(record));
     }
+}
 
-    // Check for print(x)
-    if (stmt.find("print(") == 0) {
-        size_t endParen = stmt.find(')');
-        if (endParen != std::string::npos) {
-            std::string expr = stmt.substr(6, endParen - 6);
-            std::string result = evaluateExpression(trim(expr));
+std::vector<std::string> ReplInterpreter::restoreSnapshot(const SessionSnapshot& snapshot) {
+    std::vector<std::string> outputs = execute(snapshot.program);
 
-            // If last operation was println, start a new line
-            // Otherwise append to current line
-            if (lastWasPrintln || outputLines.empty()) {
-                outputLines.push_back(result);
-            } else {
-                outputLines.back() += result;
-            }
-            lastWasPrintln = false;  // Mark that we're continuing a line
+    std::map<std::string, const SessionSnapshot::Source*> sourceRecords;
+    for (const auto& record : snapshot.sources) {
+        sourceRecords[record.name] = &record;
+
+        // Process passes planned for the recorded input sizes
+        auto graph = processSources.find(record.name);
+        if (graph != processSources.end() && !record.inputSizes.empty()) {
+            graph->second->prepare(record.inputSizes);
+        }
+    }
+
+    for (const auto& record : snapshot.layers) {
+        auto layer = getLayer(record.name);
+        if (!layer) continue;
+        layer->setTransform({record.posX, record.posY, record.scaleX, record.scaleY,
+                             record.rotXY, record.rotY, record.opacity});
+        auto source = sourceRecords.find(record.sourceName);
+        int sourceWidth = source != sourceRecords.end() ? source->second->width : 0;
+        int sourceHeight = source != sourceRecords.end() ? source->second->height : 0;
+        layer->prepare(record.framebufferWidth, record.framebufferHeight, sourceWidth, sourceHeight);
+        touchedLayers.insert(record.name);
+    }
+
+    for (const auto& record : snapshot.outputs) {
+        auto output = getOutputVariable(record.name);
+        if (output) {
+            output->prepare(record.width, record.height);
+        }
+    }
+    commitDossier();
+    return outputs;
+}
 
-            if (outputCallback) {
-                outputCallback(result);
+void ReplInterpreter::commitDossier() {
+    if (dossierManager) {
+        for (const auto& name : touchedLayers) {
+            auto layer = getLayer(name);
+            if (layer) {
+                dossierManager->registerLayer(name, layer);
+            }
+        }
+        for (const auto& name : touchedOutputs) {
+            auto output = getOutputVariable(name);
+            if (output) {
+                dossierManager->registerOutputVariable(name, output->getTarget(), output);
             }
         }
-        return;
     }
+    touchedLayers.clear();
+    touchedOutputs.clear();
 }
 
-std::string ReplInterpreter::evaluateExpression(const std::string& expr) {
-    std::string result;
-    std::string current = trim(expr);
+bool ReplInterpreter::checkGroup(const std::vector<const ReplStatement*>& group,
+                                 const ReplProgram& program, std::string& error) {
+    std::set<std::string> newLayers, newSources, newOutputs;
+    std::set<ReplSymbol> newVariables;
+    auto isLayer = [&](const std::string& name) { return getLayer(name) || newLayers.count(name); };
+
+    // Device in_vars a process in the group can read: the live ones plus the
+    // group's own, as executeStatement will have them when it builds
+    std::map<std::string, std::shared_ptr<VideoSource>> groupSources = inputSources;
+
+    // A group that isn't applied releases what the check opened or built
+    std::vector<std::string> opened;
+    auto fail = [&]() {
+        for (const auto& name : opened) {
+            preparedSources.erase(name);
+        }
+        preparedGraphs.clear();
+        return false;
+    };
+
+    for (const ReplStatement* statement : group) {
+        const std::string& name = statement->name;
+        switch (statement->type) {
+        case ReplStatementType::IN_VAR: {
+            if (statement->process) {
+                auto graph = std::make_shared<RenderGraph>();
+                graph->setCpuKernels(cpuKernels);
+                if (!graph->build(*statement->process, program.processes, groupSources, error)) {
+                    error = "in_var " + name + ": " + error;
+                    return fail();
+                }
+                preparedGraphs[name] = graph;
+                groupSources.erase(name);
+                newSources.insert(name);
+                break;
+            }
 
-    // Handle string concatenation with +
-    size_t pos = 0;
-    while (pos < current.length()) {
-        // Skip whitespace
-        while (pos < current.length() && (current[pos] == ' ' || current[pos] == '\t')) {
-            pos++;
+            // Submitted runs opened the device on the worker; otherwise open it now
+            auto prepared = preparedSources.find(name);
+            if (prepared == preparedSources.end()) {
+                prepared = preparedSources.emplace(name, openSource(statement->deviceIndex)).first;
+                opened.push_back(name);
+            }
+            if (!prepared->second) {
+                error = "video device " + std::to_string(statement->deviceIndex) + " failed to open";
+                return fail();
+            }
+            groupSources[name] = prepared->second;
+            newSources.insert(name);
+            break;
         }
+        case ReplStatementType::OUT_VAR:    newOutputs.insert(name); break;
+        case ReplStatementType::LAYER_OBJ:  newLayers.insert(name); break;
+        case ReplStatementType::VAR:        newVariables.insert(statement->symbol); break;
+
+        case ReplStatementType::SET_CANVAS:
+            if (!isLayer(name)) {
+                error = "layer '" + name + "' not found";
+                return fail();
+            }
+            break;
+
+        case ReplStatementType::METHOD_CALL:
+            if (statement->method == ReplMethod::CAST || statement->method == ReplMethod::PROJECT) {
+                bool owner = statement->method == ReplMethod::CAST
+                    ? inputSources.count(name) || processSources.count(name) || newSources.count(name)
+                    : getOutputVariable(name) || newOutputs.count(name);
+                if (!owner) {
+                    error = "unknown method call: " + name + "." + statement->methodName + "()";
+                    return fail();
+                }
+                if (!isLayer(statement->args[0].text)) {
+                    error = "layer '" + statement->args[0].text + "' not found";
+                    return fail();
+                }
+                break;
+            }
+            if (!isLayer(name) || statement->method == ReplMethod::UNKNOWN) {
+                error = "unknown method call: " + name + "." + statement->methodName + "()";
+                return fail();
+            }
+            // Variables must be numbers (or be set earlier in the group)
+            for (const auto& arg : statement->args) {
+                for (const auto& instruction : arg.bytecode.code) {
+                    if (instruction.op != ReplBytecode::Op::LOAD_VAR ||
+                        newVariables.count(instruction.symbol)) {
+                        continue;
+                    }
+                    const ReplValue* value = lookupValue(instruction.symbol);
+                    if (!value || value->type != ReplValue::Type::NUMBER) {
+                        error = "variable '" + replSymbolName(instruction.symbol) + "' " +
+                                (value ? "is not a number" : "is not defined");
+                        return fail();
+                    }
+                }
+            }
+            break;
 
-        if (pos >= current.length()) break;
+        default:
+            break;
+        }
+    }
+    return true;
+}
 
-        // Check for string literal
-        if (current[pos] == '"' || current[pos] == '\'') {
-            char quote = current[pos];
-            pos++;
-            std::string literal;
-            while (pos < current.length() && current[pos] != quote) {
-                literal += current[pos];
-                pos++;
-            }
-            pos++; // Skip closing quote
-            result += literal;
-        }
-        // Check for variable
-        else if (isalpha(current[pos]) || current[pos] == '_') {
-            std::string varName;
-            while (pos < current.length() && (isalnum(current[pos]) || current[pos] == '_')) {
-                varName += current[pos];
-                pos++;
+void ReplInterpreter::removeObject(const std::string& name, ReplStatementType kind) {
+    if (kind == ReplStatementType::IN_VAR) {
+        inputSources.erase(name);
+        processSources.erase(name);
+        videoVariables.erase(name);
+        if (dossierManager) {
+            dossierManager->unregisterInputVariable(name);
+        }
+        std::cout << "Removed in_var " << name << "\n";
+    } else if (kind == ReplStatementType::LAYER_OBJ) {
+        auto layer = getLayer(name);
+        if (layer) {
+            for (auto& [outputName, output] : outputVariables) {
+                output->removeLayer(layer);
             }
+        }
+        layers.erase(name);
+        bindingsChanged = bindingsChanged || layerBindings.erase(name) > 0;
+        if (dossierManager) {
+            dossierManager->unregisterLayer(name);
+        }
+        std::cout << "Removed layer_obj '" << name << "'\n";
+    } else if (kind == ReplStatementType::OUT_VAR) {
+        outputVariables.erase(name);
+        videoVariables.erase(name);
+        if (dossierManager) {
+            dossierManager->unregisterOutputVariable(name);
+        }
+        std::cout << "Removed out_var " << name << "\n";
+    }
+}
+
+std::shared_ptr<VideoSource> ReplInterpreter::openSource(int deviceIndex) {
+    if (videoSourceFactory) {
+        return videoSourceFactory(deviceIndex);
+    }
+    auto source = std::make_shared<VideoSource>();
+    if (!source->open(deviceIndex)) {
+        source.reset();
+    }
+    return source;
+}
 
-            // Look up variable
-            if (variables.find(varName) != variables.end()) {
-                result += variables[varName];
+void ReplInterpreter::executeStatement(const ReplStatement& statement, const ReplProgram& program) {
+    const std::string& varName = statement.name;
+
+    switch (statement.type) {
+    case ReplStatementType::IN_VAR: {
+        // Process output: compiled to GPU passes, planned on its first frame
+        if (statement.process) {
+            // Already built when the statement's group was checked
+            std::shared_ptr<RenderGraph> graph;
+            std::string error;
+            auto prepared = preparedGraphs.find(varName);
+            if (prepared != preparedGraphs.end()) {
+                graph = std::move(prepared->second);
+                preparedGraphs.erase(prepared);
+            } else {
+                graph = std::make_shared<RenderGraph>();
+                graph->setCpuKernels(cpuKernels);
+                if (!graph->build(*statement.process, program.processes, inputSources, error)) {
+                    graph.reset();
+                }
+            }
+            if (graph) {
+                processSources[varName] = graph;
+                inputSources.erase(varName);
+                videoVariables.erase(varName);
+                std::cout << "Created in_var " << varName << " = $" << statement.process->name
+                          << " (" << graph->getNodeCount() << " nodes)\n";
             } else {
-                result += "[undefined:" + varName + "]";
+                std::cerr << "ERROR: in_var " << varName << ": " << error << "\n";
             }
+            break;
         }
-        // Check for + operator
-        else if (current[pos] == '+') {
-            pos++;
-            // Continue to next term
+
+        // Open video source (already opened on the worker thread for submitted runs)
+        int deviceIndex = statement.deviceIndex;
+        std::shared_ptr<VideoSource> source;
+        auto prepared = preparedSources.find(varName);
+        if (prepared != preparedSources.end()) {
+            source = std::move(prepared->second);
+            preparedSources.erase(prepared);
+        } else {
+            source = openSource(deviceIndex);
         }
-        // Skip other characters
-        else {
-            pos++;
+        if (source) {
+            // Store source for layer casting
+            inputSources[varName] = source;
+            processSources.erase(varName);
+
+            // Also create legacy video variable for backward compatibility
+            auto videoVar = std::make_shared<VideoVariable>(varName, VideoVarType::INPUT);
+            videoVar->setSource(source);
+            videoVariables[varName] = videoVar;
+
+            std::cout << "Created in_var " << varName << " (device " << deviceIndex << ")\n";
+
+            // Register with dossier
+            if (dossierManager) {
+                dossierManager->registerInputVariable(varName, deviceIndex, source);
+            }
+        } else {
+            std::cerr << "Failed to open video device " << deviceIndex << "\n";
         }
+        break;
     }
 
-    return result;
-}
+    case ReplStatementType::OUT_VAR: {
+        const std::string& target = statement.target;
+
+        // Create output variable with layer stack
+        auto output = std::make_shared<OutputVariable>(varName, target);
+        outputVariables[varName] = output;
+
+        // Also create legacy video variable for backward compatibility
+        auto videoVar = std::make_shared<VideoVariable>(varName, VideoVarType::OUTPUT);
+        videoVar->setTarget(target);
+        videoVariables[varName] = videoVar;
 
-std::vector<std::string> ReplInterpreter::parseTuple(const std::string& tupleStr) {
-    std::vector<std::string> values;
-    std::string cleaned = trim(tupleStr);
+        std::cout << "Created out_var " << varName << " -> " << target << "\n";
 
-    // Remove parentheses if present
-    if (!cleaned.empty() && cleaned.front() == '(') {
-        cleaned = cleaned.substr(1);
+        // Dossier entry refreshed when the run commits
+        touchedOutputs.insert(varName);
+        break;
     }
-    if (!cleaned.empty() && cleaned.back() == ')') {
-        cleaned = cleaned.substr(0, cleaned.length() - 1);
+
+    case ReplStatementType::VAR: {
+        ReplValue value = evaluateExpression(statement.expression);
+        std::cout << "Set variable " << varName << " = " << value.toString() << "\n";
+        if (variables.size() <= statement.symbol) {
+            variables.resize(replSymbolCount());
+        }
+        variables[statement.symbol] = std::move(value);
+        break;
+    }
+
+    case ReplStatementType::LAYER_OBJ: {
+        auto layer = std::make_shared<Layer>(varName);
+        layers[varName] = layer;
+        std::cout << "Created layer_obj '" << varName << "'\n";
+
+        // Dossier entry refreshed when the run commits
+        touchedLayers.insert(varName);
+        break;
+    }
+
+    case ReplStatementType::SET_CANVAS: {
+        auto layer = getLayer(varName);
+        if (layer) {
+            layer->setCanvas(statement.width, statement.height);
+            std::cout << "Layer '" << varName << "' canvas = (" << statement.width << ", "
+                      << statement.height << ")\n";
+
+            // Dossier entry refreshed when the run commits
+            touchedLayers.insert(varName);
+        }
+        break;
     }
 
-    // Split by comma
-    std::istringstream stream(cleaned);
-    std::string token;
-    while (std::getline(stream, token, ',')) {
-        values.push_back(trim(token));
+    case ReplStatementType::METHOD_CALL:
+        executeMethodCall(statement);
+        break;
+
+    case ReplStatementType::PRINTLN: {
+        std::string result = evaluateExpression(statement.expression).toString();
+        outputLines.push_back(result);
+        lastWasPrintln = true;  // Mark that we completed a line
+        if (outputCallback) {
+            outputCallback(result);
+        }
+        break;
     }
 
-    return values;
+    case ReplStatementType::PRINT: {
+        std::string result = evaluateExpression(statement.expression).toString();
+
+        // If last operation was println, start a new line
+        // Otherwise append to current line
+        if (lastWasPrintln || outputLines.empty()) {
+            outputLines.push_back(result);
+        } else {
+            outputLines.back() += result;
+        }
+        lastWasPrintln = false;  // Mark that we're continuing a line
+
+        if (outputCallback) {
+            outputCallback(result);
+        }
+        break;
+    }
+    }
 }
 
-bool ReplInterpreter::parseMethodCall(const std::string& stmt, MethodCall& result) {
-    // Find the dot
-    size_t dotPos = stmt.find('.');
-    if (dotPos == std::string::npos) {
-        return false;
+const ReplValue* ReplInterpreter::lookupValue(ReplSymbol symbol) {
+    if (symbol < variables.size() && variables[symbol].type != ReplValue::Type::NONE) {
+        return &variables[symbol];
     }
 
-    // Find the opening parenthesis
-    size_t openParen = stmt.find('(', dotPos);
-    if (openParen == std::string::npos) {
-        return false;
+    const std::string& name = replSymbolName(symbol);
+    if (layers.count(name) || inputSources.count(name) || processSources.count(name) ||
+        outputVariables.count(name)) {
+        objectValue = ReplValue::makeObject(symbol);
+        return &objectValue;
     }
+    return nullptr;
+}
 
-    // Find the closing parenthesis
-    size_t closeParen = stmt.find(')', openParen);
-    if (closeParen == std::string::npos) {
-        return false;
+ReplValue ReplInterpreter::evaluateExpression(const ReplExpression& expression) {
+    if (expression.isNumeric) {
+        ReplBytecode bytecode = expression.bytecode;
+        if (resolveVariables(bytecode)) {
+            return ReplValue::makeNumber(bytecode.evaluate(0.0f));
+        }
+        return ReplValue();
     }
 
-    // Extract parts
-    result.object = trim(stmt.substr(0, dotPos));
-    result.method = trim(stmt.substr(dotPos + 1, openParen - dotPos - 1));
+    // Numbers add until a non-number joins; from then on it is string concatenation
+    ReplValue result;
+    for (const auto& part : expression.parts) {
+        const ReplValue* value = part.isVariable ? lookupValue(part.symbol) : &part.value;
+        if (result.type == ReplValue::Type::NONE && value) {
+            result = *value;
+            continue;
+        }
+        if (result.type == ReplValue::Type::NUMBER && value && value->type == ReplValue::Type::NUMBER) {
+            result.number += value->number;
+            continue;
+        }
 
-    // Extract arguments
-    std::string argsStr = stmt.substr(openParen + 1, closeParen - openParen - 1);
-    if (!argsStr.empty()) {
-        result.args = parseTuple(argsStr);
+        if (result.type != ReplValue::Type::STRING) {
+            result = ReplValue::makeString(result.toString());
+        }
+        if (value) {
+            value->appendTo(result.text);
+        } else {
+            result.text += "[undefined:";
+            result.text += replSymbolName(part.symbol);
+            result.text += ']';
+        }
     }
+    return result;
+}
 
+bool ReplInterpreter::resolveVariables(ReplBytecode& bytecode) {
+    if (!bytecode.usesVariables) return true;
+
+    for (auto& instruction : bytecode.code) {
+        if (instruction.op != ReplBytecode::Op::LOAD_VAR) continue;
+
+        const ReplValue* value = lookupValue(instruction.symbol);
+        if (!value || value->type != ReplValue::Type::NUMBER) {
+            std::cerr << "ERROR: Variable '" << replSymbolName(instruction.symbol) << "' "
+                      << (value ? "is not a number" : "is not defined") << "\n";
+            return false;
+        }
+        instruction.op = ReplBytecode::Op::LOAD_CONST;
+        instruction.constant = (float)value->number;
+    }
+    bytecode.usesVariables = false;
     return true;
 }
 
-void ReplInterpreter::executeMethodCall(const MethodCall& call) {
+void ReplInterpreter::executeMethodCall(const ReplStatement& call) {
+    // Argument counts and numeric types were checked when the program was compiled.
+    // Vars are substituted here, once, so bindings never look names up per frame.
+    // (cast and project take object names, which also compile as LOAD_VAR)
+    bool usesVariables = false;
+    if (call.method != ReplMethod::CAST && call.method != ReplMethod::PROJECT) {
+        for (const auto& arg : call.args) {
+            usesVariables = usesVariables || arg.bytecode.usesVariables;
+        }
+    }
+    std::vector<ReplArgument> resolved;
+    if (usesVariables) {
+        resolved = call.args;
+        for (auto& arg : resolved) {
+            if (!arg.bytecode.usesVariables) continue;
+            if (!resolveVariables(arg.bytecode)) return;
+            arg.isAnimated = arg.bytecode.usesTime;
+            if (!arg.isAnimated) {
+                arg.isNumber = true;
+                arg.number = arg.bytecode.evaluate(0.0f);
+            }
+        }
+    }
+    const auto& args = usesVariables ? resolved : call.args;
+
     // Check if object is a layer
-    auto layer = getLayer(call.object);
+    auto layer = getLayer(call.name);
     if (layer) {
+        // Arguments that depend on t bind the method to the layer; it is applied every frame
+        bool animated = false;
+        for (const auto& arg : args) {
+            animated = animated || arg.isAnimated;
+        }
+        if (animated && call.method != ReplMethod::UNKNOWN) {
+            LayerBinding binding;
+            binding.layer = layer;
+            binding.method = call.method;
+            binding.x = args[0].bytecode;
+            if (args.size() > 1) {
+                binding.y = args[1].bytecode;
+            }
+            layerBindings[call.name].push_back(std::move(binding));
+            bindingsChanged = true;
+            std::cout << "Layer '" << call.name << "' " << call.methodName << " bound per frame: "
+                      << call.text << "\n";
+            return;
+        }
+
         // Layer methods
-        if (call.method == "transform" && call.args.size() == 2) {
-            float x = std::stof(call.args[0]);
-            float y = std::stof(call.args[1]);
+        if (call.method == ReplMethod::TRANSFORM) {
+            float x = (float)args[0].number;
+            float y = (float)args[1].number;
             layer->transform(x, y);
-            std::cout << "Layer '" << call.object << "' transform(" << x << ", " << y << ")\n";
-
-            // Update dossier
-            if (dossierManager) {
-                dossierManager->registerLayer(call.object, layer);
-            }
+            std::cout << "Layer '" << call.name << "' transform(" << x << ", " << y << ")\n";
         }
-        else if (call.method == "scale" && call.args.size() == 2) {
-            float w = std::stof(call.args[0]);
-            float h = std::stof(call.args[1]);
+        else if (call.method == ReplMethod::SCALE) {
+            float w = (float)args[0].number;
+            float h = (float)args[1].number;
             layer->scale(w, h);
-            std::cout << "Layer '" << call.object << "' scale(" << w << ", " << h << ")\n";
-
-            if (dossierManager) {
-                dossierManager->registerLayer(call.object, layer);
-            }
+            std::cout << "Layer '" << call.name << "' scale(" << w << ", " << h << ")\n";
         }
-        else if (call.method == "rot" && call.args.size() == 2) {
-            float xy = std::stof(call.args[0]);
-            float y = std::stof(call.args[1]);
+        else if (call.method == ReplMethod::ROT) {
+            float xy = (float)args[0].number;
+            float y = (float)args[1].number;
             layer->rot(xy, y);
-            std::cout << "Layer '" << call.object << "' rot(" << xy << ", " << y << ")\n";
-
-            if (dossierManager) {
-                dossierManager->registerLayer(call.object, layer);
-            }
+            std::cout << "Layer '" << call.name << "' rot(" << xy << ", " << y << ")\n";
         }
-        else if (call.method == "opacity" && call.args.size() == 1) {
-            float opacity = std::stof(call.args[0]);
+        else if (call.method == ReplMethod::OPACITY) {
+            float opacity = (float)args[0].number;
             layer->setOpacity(opacity);
-            std::cout << "Layer '" << call.object << "' opacity(" << opacity << ")\n";
+            std::cout << "Layer '" << call.name << "' opacity(" << opacity << ")\n";
+        }
+        else {
+            return;
+        }
 
-            if (dossierManager) {
-                dossierManager->registerLayer(call.object, layer);
-            }
+        // Dossier entry refreshed when the run commits
+        touchedLayers.insert(call.name);
+        return;
+    }
+
+    // Process outputs cast like any in_var
+    auto processSource = processSources.find(call.name);
+    if (processSource != processSources.end() && call.method == ReplMethod::CAST) {
+        const std::string& layerName = args[0].text;
+        auto targetLayer = getLayer(layerName);
+        if (targetLayer) {
+            targetLayer->setProcess(processSource->second);
+            std::cout << "Cast " << call.name << " to layer '" << layerName << "'\n";
+
+            touchedLayers.insert(layerName);
+        } else {
+            std::cerr << "ERROR: Layer '" << layerName << "' not found\n";
         }
         return;
     }
 
     // Check if object is an input source (for cast method)
-    auto inputSource = inputSources.find(call.object);
-    if (inputSource != inputSources.end() && call.method == "cast" && call.args.size() == 1) {
-        std::string layerName = call.args[0];
+    auto inputSource = inputSources.find(call.name);
+    if (inputSource != inputSources.end() && call.method == ReplMethod::CAST) {
+        const std::string& layerName = args[0].text;
         auto targetLayer = getLayer(layerName);
         if (targetLayer) {
             targetLayer->setSource(inputSource->second);
-            std::cout << "Cast " << call.object << " to layer '" << layerName << "'\n";
+            std::cout << "Cast " << call.name << " to layer '" << layerName << "'\n";
 
-            if (dossierManager) {
-                dossierManager->registerLayer(layerName, targetLayer);
-            }
+            touchedLayers.insert(layerName);
         } else {
             std::cerr << "ERROR: Layer '" << layerName << "' not found\n";
         }
@@ -466,24 +1136,22 @@ void ReplInterpreter::executeMethodCall(const MethodCall& call) {
     }
 
     // Check if object is an output variable (for project method)
-    auto output = getOutputVariable(call.object);
-    if (output && call.method == "project" && call.args.size() == 2) {
-        std::string layerName = call.args[0];
-        int zIndex = std::stoi(call.args[1]);
+    auto output = getOutputVariable(call.name);
+    if (output && call.method == ReplMethod::PROJECT) {
+        const std::string& layerName = args[0].text;
+        int zIndex = (int)args[1].number;
         auto targetLayer = getLayer(layerName);
         if (targetLayer) {
             output->project(targetLayer, zIndex);
-            std::cout << "Project layer '" << layerName << "' to " << call.object
+            std::cout << "Project layer '" << layerName << "' to " << call.name
                       << " at z-index " << zIndex << "\n";
 
-            if (dossierManager) {
-                dossierManager->registerOutputVariable(call.object, output->getTarget(), output);
-            }
+            touchedOutputs.insert(call.name);
         } else {
             std::cerr << "ERROR: Layer '" << layerName << "' not found\n";
         }
         return;
     }
 
-    std::cerr << "ERROR: Unknown method call: " << call.object << "." << call.method << "()\n";
+    std::cerr << "ERROR: Unknown method call: " << call.name << "." << call.methodName << "()\n";
 }
@@ -0,0 +1,779 @@
+#include "repl_program.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+
+uint64_t hashReplSource(const std::string& source) {
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : source) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+float ReplBytecode::run(const Instruction* code, size_t count, float t) {
+    float r[maxRegisters];
+    for (const Instruction* end = code + count; code != end; ++code) {
+        const Instruction& in = *code;
+        switch (in.op) {
+        case Op::LOAD_CONST: r[in.dst] = in.constant; break;
+        case Op::LOAD_TIME:  r[in.dst] = t; break;
+        case Op::LOAD_VAR:   r[in.dst] = 0.0f; break;  // Unresolved
+        case Op::ADD:        r[in.dst] = r[in.a] + r[in.b]; break;
+        case Op::SUB:        r[in.dst] = r[in.a] - r[in.b]; break;
+        case Op::MUL:        r[in.dst] = r[in.a] * r[in.b]; break;
+        case Op::DIV:        r[in.dst] = r[in.b] != 0.0f ? r[in.a] / r[in.b] : 0.0f; break;
+        case Op::NEG:        r[in.dst] = -r[in.a]; break;
+        case Op::SIN:        r[in.dst] = std::sin(r[in.a]); break;
+        case Op::COS:        r[in.dst] = std::cos(r[in.a]); break;
+        case Op::ABS:        r[in.dst] = std::fabs(r[in.a]); break;
+        case Op::FLOOR:      r[in.dst] = std::floor(r[in.a]); break;
+        case Op::SQRT:       r[in.dst] = std::sqrt(std::max(0.0f, r[in.a])); break;
+        case Op::MIN:        r[in.dst] = std::min(r[in.a], r[in.b]); break;
+        case Op::MAX:        r[in.dst] = std::max(r[in.a], r[in.b]); break;
+        }
+    }
+    return count == 0 ? 0.0f : r[0];
+}
+
+std::vector<ReplToken> tokenizeReplLine(const std::string& line) {
+    std::vector<ReplToken> tokens;
+    size_t length = line.length();
+    size_t pos = 0;
+    tokens.reserve(length / 4 + 4);  // Typical density; avoids regrowing per token
+
+    while (pos < length) {
+        char c = line[pos];
+        if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+            pos++;
+            continue;
+        }
+
+        ReplToken token;
+        token.number = 0.0;
+        token.begin = pos;
+
+        if (isalpha((unsigned char)c) || c == '_') {
+            while (pos < length && (isalnum((unsigned char)line[pos]) || line[pos] == '_')) {
+                pos++;
+            }
+            token.type = ReplTokenType::IDENTIFIER;
+            token.text = line.substr(token.begin, pos - token.begin);
+        } else if (isdigit((unsigned char)c) ||
+                   (c == '.' && pos + 1 < length && isdigit((unsigned char)line[pos + 1]))) {
+            while (pos < length && (isdigit((unsigned char)line[pos]) || line[pos] == '.')) {
+                pos++;
+            }
+            token.type = ReplTokenType::NUMBER;
+            token.text = line.substr(token.begin, pos - token.begin);
+            token.number = std::strtod(token.text.c_str(), nullptr);
+        } else if (c == '"' || c == '\'') {
+            // No escapes; an unterminated string runs to the end of the line
+            size_t close = line.find(c, pos + 1);
+            size_t contentEnd = close == std::string::npos ? length : close;
+            token.type = ReplTokenType::STRING;
+            token.text = line.substr(pos + 1, contentEnd - pos - 1);
+            pos = close == std::string::npos ? length : close + 1;
+        } else {
+            token.type = ReplTokenType::SYMBOL;
+            token.text = std::string(1, c);
+            pos++;
+        }
+
+        token.end = pos;
+        tokens.push_back(std::move(token));
+    }
+
+    return tokens;
+}
+
+namespace {
+
+// Parses the tokens of one non-comment line into a statement
+class LineParser {
+public:
+    LineParser(const std::string& line, int lineNumber, std::vector<std::string>& errors)
+        : line(line), tokens(tokenizeReplLine(line)), lineNumber(lineNumber), errors(errors) {
+        // Trailing semicolon is optional
+        if (isSymbol(tokens.size() - 1, ';')) {
+            tokens.pop_back();
+        }
+    }
+
+    bool parse(ReplStatement& statement) {
+        statement.line = lineNumber;
+        if (tokens.empty()) return false;
+        statement.text = sourceText(0, tokens.size());
+
+        if (isKeyword(0, "in_var")) {
+            if (isIdentifier(1) && isSymbol(2, '=') && isSymbol(3, '$')) {
+                statement.type = ReplStatementType::IN_VAR;
+                statement.name = tokens[1].text;
+                statement.process = std::make_shared<ReplProcessCall>();
+                size_t pos = 3;
+                if (!parseProcessCall(pos, *statement.process) || pos != tokens.size()) {
+                    return fail("expected: in_var NAME = $PROCESS(ARGS)");
+                }
+                return true;
+            }
+            if (!isIdentifier(1) || !isSymbol(2, '=') || tokens.size() != 4 || !isNumber(3)) {
+                return fail("expected: in_var NAME = DEVICE_INDEX");
+            }
+            statement.type = ReplStatementType::IN_VAR;
+            statement.name = tokens[1].text;
+            statement.deviceIndex = (int)tokens[3].number;
+            return true;
+        }
+
+        if (isKeyword(0, "out_var")) {
+            if (!isIdentifier(1) || !isSymbol(2, '=') || tokens.size() < 4) {
+                return fail("expected: out_var NAME = TARGET");
+            }
+            statement.type = ReplStatementType::OUT_VAR;
+            statement.name = tokens[1].text;
+            statement.target = sourceText(3, tokens.size());
+            return true;
+        }
+
+        if (isKeyword(0, "var")) {
+            if (!isIdentifier(1) || !isSymbol(2, '=')) {
+                return fail("expected: var NAME = EXPRESSION");
+            }
+            statement.type = ReplStatementType::VAR;
+            statement.name = tokens[1].text;
+            statement.symbol = internReplSymbol(statement.name);
+            statement.expression = parseExpression(3, tokens.size());
+            return true;
+        }
+
+        if (isKeyword(0, "layer_obj")) {
+            if (!isIdentifier(1) || tokens.size() != 2) {
+                return fail("expected: layer_obj NAME");
+            }
+            statement.type = ReplStatementType::LAYER_OBJ;
+            statement.name = tokens[1].text;
+            return true;
+        }
+
+        // object.property = value / object.method(args)
+        if (isIdentifier(0) && isSymbol(1, '.') && isIdentifier(2)) {
+            statement.name = tokens[0].text;
+            if (isSymbol(3, '=')) {
+                return parseProperty(statement);
+            }
+            if (isSymbol(3, '(')) {
+                return parseMethodCall(statement);
+            }
+            return fail("expected '=' or '(' after " + tokens[0].text + "." + tokens[2].text);
+        }
+
+        if ((isKeyword(0, "println") || isKeyword(0, "print")) && isSymbol(1, '(')) {
+            size_t close = findClose(1);
+            if (close == std::string::npos) {
+                return fail("missing ')' in " + tokens[0].text + "(...)");
+            }
+            statement.type = tokens[0].text == "println" ? ReplStatementType::PRINTLN
+                                                         : ReplStatementType::PRINT;
+            statement.expression = parseExpression(2, close);
+            return true;
+        }
+
+        return fail("unrecognized statement");
+    }
+
+    // process $name(param, ...) { out = $op(args) ... return out }
+    // The whole block is one "line" here; newlines are just whitespace to the tokenizer.
+    bool parseProcess(ReplProcessDef& def) {
+        def.line = lineNumber;
+        def.text = line;
+        if (!isKeyword(0, "process") || !isSymbol(1, '$') || !isIdentifier(2) || !isSymbol(3, '(')) {
+            return fail("expected: process $NAME(PARAMS) { ... }");
+        }
+        def.name = tokens[2].text;
+
+        size_t close = findClose(3);
+        if (close == std::string::npos) {
+            return fail("missing ')' in process $" + def.name);
+        }
+        for (size_t i = 4; i < close; i++) {
+            if (isIdentifier(i)) {
+                def.params.push_back(tokens[i].text);
+            } else if (!isSymbol(i, ',')) {
+                return fail("process $" + def.name + ": parameters must be names");
+            }
+        }
+
+        size_t pos = close + 1;
+        if (!isSymbol(pos, '{') || !isSymbol(tokens.size() - 1, '}')) {
+            return fail("process $" + def.name + ": expected { ... }");
+        }
+        pos++;
+        size_t bodyEnd = tokens.size() - 1;
+        bool hasResult = false;
+        while (pos < bodyEnd) {
+            if (isSymbol(pos, ';')) {
+                pos++;
+                continue;
+            }
+            if (isKeyword(pos, "return")) {
+                size_t end = pos + 1;
+                while (end < bodyEnd && !isSymbol(end, ';')) end++;
+                if (!parseProcessArg(pos + 1, end, def.result)) {
+                    return fail("process $" + def.name + ": bad return value");
+                }
+                hasResult = true;
+                pos = end;
+                continue;
+            }
+            if (!isIdentifier(pos) || !isSymbol(pos + 1, '=') || !isSymbol(pos + 2, '$')) {
+                return fail("process $" + def.name + ": expected NAME = $OP(...) near '" +
+                            sourceText(pos, std::min(pos + 3, bodyEnd)) + "'");
+            }
+            std::pair<std::string, ReplProcessCall> step;
+            step.first = tokens[pos].text;
+            pos += 2;
+            if (!parseProcessCall(pos, step.second)) {
+                return fail("process $" + def.name + ": bad call for '" + step.first + "'");
+            }
+            def.steps.push_back(std::move(step));
+        }
+        if (!hasResult) {
+            return fail("process $" + def.name + ": missing return");
+        }
+        return true;
+    }
+
+private:
+    const std::string& line;
+    std::vector<ReplToken> tokens;
+    int lineNumber;
+    std::vector<std::string>& errors;
+
+    bool isSymbol(size_t index, char c) const {
+        return index < tokens.size() && tokens[index].type == ReplTokenType::SYMBOL &&
+               tokens[index].text[0] == c;
+    }
+    bool isIdentifier(size_t index) const {
+        return index < tokens.size() && tokens[index].type == ReplTokenType::IDENTIFIER;
+    }
+    bool isNumber(size_t index) const {
+        return index < tokens.size() && tokens[index].type == ReplTokenType::NUMBER;
+    }
+    bool isKeyword(size_t index, const char* keyword) const {
+        return isIdentifier(index) && tokens[index].text == keyword;
+    }
+
+    bool fail(const std::string& message) {
+        errors.push_back("line " + std::to_string(lineNumber) + ": " + message);
+        return false;
+    }
+
+    // Source text spanned by tokens [first, last)
+    std::string sourceText(size_t first, size_t last) const {
+        if (first >= last) return "";
+        return line.substr(tokens[first].begin, tokens[last - 1].end - tokens[first].begin);
+    }
+
+    // Index of the ')' matching the '(' at open, or npos
+    size_t findClose(size_t open) const {
+        int depth = 0;
+        for (size_t i = open; i < tokens.size(); i++) {
+            if (isSymbol(i, '(')) {
+                depth++;
+            } else if (isSymbol(i, ')') && --depth == 0) {
+                return i;
+            }
+        }
+        return std::string::npos;
+    }
+
+    // Operands joined by '+': strings, numbers, constant tuples and names.
+    // Other operators make it a numeric expression when it compiles as one.
+    ReplExpression parseExpression(size_t first, size_t last) const {
+        ReplExpression expression;
+        expression.parts.reserve((last - first + 1) / 2);  // Operands alternate with '+'
+        bool onlySums = true;
+        for (size_t i = first; i < last; i++) {
+            const ReplToken& token = tokens[i];
+            if (token.type == ReplTokenType::STRING) {
+                expression.parts.push_back({false, 0, ReplValue::makeString(token.text)});
+            } else if (token.type == ReplTokenType::NUMBER) {
+                expression.parts.push_back({false, 0, ReplValue::makeNumber(token.number)});
+            } else if (isSymbol(i, '-') && isNumber(i + 1) && (i == first || isSymbol(i - 1, '+'))) {
+                expression.parts.push_back({false, 0, ReplValue::makeNumber(-tokens[++i].number)});
+            } else if (token.type == ReplTokenType::IDENTIFIER && !isSymbol(i + 1, '(')) {
+                expression.parts.push_back({true, internReplSymbol(token.text), ReplValue()});
+            } else if (isSymbol(i, '(') && !isIdentifier(i - 1)) {
+                size_t close = findClose(i);
+                auto values = parseArguments(i + 1, close == std::string::npos ? last : close);
+                if (close == std::string::npos || close >= last || values.size() < 2 ||
+                    !allNumbers(values, values.size())) {
+                    onlySums = false;
+                    continue;
+                }
+                std::vector<double> tuple;
+                for (const auto& value : values) {
+                    tuple.push_back(value.number);
+                }
+                expression.parts.push_back({false, 0, ReplValue::makeTuple(std::move(tuple))});
+                i = close;
+            } else if (!isSymbol(i, '+')) {
+                onlySums = false;
+            }
+        }
+
+        if (!onlySums && compileNumeric(first, last, expression.bytecode) &&
+            !expression.bytecode.usesTime) {
+            expression.isNumeric = true;
+        }
+        return expression;
+    }
+
+    // Comma-separated arguments in tokens [first, last)
+    std::vector<ReplArgument> parseArguments(size_t first, size_t last) const {
+        std::vector<ReplArgument> args;
+        if (first >= last) return args;
+
+        size_t groupStart = first;
+        int depth = 0;
+        for (size_t i = first; i <= last; i++) {
+            if (i < last) {
+                if (isSymbol(i, '(')) depth++;
+                if (isSymbol(i, ')')) depth--;
+                if (!isSymbol(i, ',') || depth > 0) continue;
+            }
+
+            ReplArgument arg;
+            arg.text = sourceText(groupStart, i);
+            arg.isNumber = false;
+            arg.number = 0.0;
+            arg.isAnimated = false;
+            size_t count = i - groupStart;
+            if (count == 1 && isNumber(groupStart)) {
+                arg.isNumber = true;
+                arg.number = tokens[groupStart].number;
+            } else if (count == 2 && (isSymbol(groupStart, '-') || isSymbol(groupStart, '+')) &&
+                       isNumber(groupStart + 1)) {
+                arg.isNumber = true;
+                arg.number = isSymbol(groupStart, '-') ? -tokens[groupStart + 1].number
+                                                       : tokens[groupStart + 1].number;
+            } else if (compileNumeric(groupStart, i, arg.bytecode)) {
+                // Fold expressions without t or vars into a plain number
+                arg.isAnimated = arg.bytecode.usesTime && !arg.bytecode.usesVariables;
+                if (!arg.bytecode.usesTime && !arg.bytecode.usesVariables) {
+                    arg.isNumber = true;
+                    arg.number = arg.bytecode.evaluate(0.0f);
+                }
+            }
+            if (arg.isNumber) {
+                arg.bytecode.code = {{ReplBytecode::Op::LOAD_CONST, 0, 0, 0, (float)arg.number}};
+                arg.bytecode.usesTime = false;
+            }
+            args.push_back(std::move(arg));
+            groupStart = i + 1;
+        }
+        return args;
+    }
+
+    static bool allNumbers(const std::vector<ReplArgument>& args, size_t count) {
+        if (args.size() != count) return false;
+        for (const auto& arg : args) {
+            if (!arg.isNumber) return false;
+        }
+        return true;
+    }
+
+    // Numbers or per-frame expressions (layer property methods)
+    static bool allNumeric(const std::vector<ReplArgument>& args, size_t count) {
+        if (args.size() != count) return false;
+        for (const auto& arg : args) {
+            if (!arg.isNumber && !arg.isAnimated && !arg.bytecode.usesVariables) return false;
+        }
+        return true;
+    }
+
+    // Numeric expression in tokens [first, last) -> bytecode, result in register 0
+    // Recursive descent; each level evaluates into dst and uses dst+1 for its right operand
+    bool compileNumeric(size_t first, size_t last, ReplBytecode& bytecode) const {
+        bytecode.code.clear();
+        bytecode.usesTime = false;
+        bytecode.usesVariables = false;
+        size_t pos = first;
+        return compileSum(pos, last, 0, bytecode) && pos == last;
+    }
+
+    bool emit(ReplBytecode& bytecode, ReplBytecode::Op op, int dst, int a, int b, float constant = 0.0f) const {
+        if (dst + 1 >= ReplBytecode::maxRegisters) return false;
+        bytecode.code.push_back({op, (uint8_t)dst, (uint8_t)a, (uint8_t)b, {constant}});
+        return true;
+    }
+
+    bool compileSum(size_t& pos, size_t last, int dst, ReplBytecode& bytecode) const {
+        if (!compileProduct(pos, last, dst, bytecode)) return false;
+        while (pos < last && (isSymbol(pos, '+') || isSymbol(pos, '-'))) {
+            auto op = isSymbol(pos, '+') ? ReplBytecode::Op::ADD : ReplBytecode::Op::SUB;
+            pos++;
+            if (!compileProduct(pos, last, dst + 1, bytecode)) return false;
+            if (!emit(bytecode, op, dst, dst, dst + 1)) return false;
+        }
+        return true;
+    }
+
+    bool compileProduct(size_t& pos, size_t last, int dst, ReplBytecode& bytecode) const {
+        if (!compileUnary(pos, last, dst, bytecode)) return false;
+        while (pos < last && (isSymbol(pos, '*') || isSymbol(pos, '/'))) {
+            auto op = isSymbol(pos, '*') ? ReplBytecode::Op::MUL : ReplBytecode::Op::DIV;
+            pos++;
+            if (!compileUnary(pos, last, dst + 1, bytecode)) return false;
+            if (!emit(bytecode, op, dst, dst, dst + 1)) return false;
+        }
+        return true;
+    }
+
+    bool compileUnary(size_t& pos, size_t last, int dst, ReplBytecode& bytecode) const {
+        if (pos < last && isSymbol(pos, '-')) {
+            pos++;
+            return compileUnary(pos, last, dst, bytecode) &&
+                   emit(bytecode, ReplBytecode::Op::NEG, dst, dst, 0);
+        }
+        if (pos < last && isSymbol(pos, '+')) {
+            pos++;
+            return compileUnary(pos, last, dst, bytecode);
+        }
+        return compilePrimary(pos, last, dst, bytecode);
+    }
+
+    bool compilePrimary(size_t& pos, size_t last, int dst, ReplBytecode& bytecode) const {
+        if (pos >= last) return false;
+
+        if (isNumber(pos)) {
+            return emit(bytecode, ReplBytecode::Op::LOAD_CONST, dst, 0, 0, (float)tokens[pos++].number);
+        }
+
+        if (isSymbol(pos, '(')) {
+            size_t close = findClose(pos);
+            if (close == std::string::npos || close >= last) return false;
+            pos++;
+            if (!compileSum(pos, close, dst, bytecode) || pos != close) return false;
+            pos++;
+            return true;
+        }
+
+        if (!isIdentifier(pos)) return false;
+        const std::string& name = tokens[pos].text;
+        if (name == "t") {
+            pos++;
+            bytecode.usesTime = true;
+            return emit(bytecode, ReplBytecode::Op::LOAD_TIME, dst, 0, 0);
+        }
+        if (name == "pi") {
+            pos++;
+            return emit(bytecode, ReplBytecode::Op::LOAD_CONST, dst, 0, 0, 3.14159265f);
+        }
+
+        // Function call
+        ReplBytecode::Op op;
+        int arity = 1;
+        if (name == "sin") op = ReplBytecode::Op::SIN;
+        else if (name == "cos") op = ReplBytecode::Op::COS;
+        else if (name == "abs") op = ReplBytecode::Op::ABS;
+        else if (name == "floor") op = ReplBytecode::Op::FLOOR;
+        else if (name == "sqrt") op = ReplBytecode::Op::SQRT;
+        else if (name == "min") { op = ReplBytecode::Op::MIN; arity = 2; }
+        else if (name == "max") { op = ReplBytecode::Op::MAX; arity = 2; }
+        else if (isSymbol(pos + 1, '(')) return false;
+        else {
+            // var name, looked up when the statement runs
+            if (!emit(bytecode, ReplBytecode::Op::LOAD_VAR, dst, 0, 0)) return false;
+            bytecode.code.back().symbol = internReplSymbol(tokens[pos++].text);
+            bytecode.usesVariables = true;
+            return true;
+        }
+
+        if (!isSymbol(pos + 1, '(')) return false;
+        size_t close = findClose(pos + 1);
+        if (close == std::string::npos || close >= last) return false;
+        pos += 2;
+        if (!compileSum(pos, close, dst, bytecode)) return false;
+        if (arity == 2) {
+            if (!isSymbol(pos, ',')) return false;
+            pos++;
+            if (!compileSum(pos, close, dst + 1, bytecode)) return false;
+        }
+        if (pos != close) return false;
+        pos++;
+        return emit(bytecode, op, dst, dst, dst + 1);
+    }
+
+    // $name(args) starting at pos; pos ends just past the ')'
+    bool parseProcessCall(size_t& pos, ReplProcessCall& call) const {
+        if (!isSymbol(pos, '$') || !isIdentifier(pos + 1) || !isSymbol(pos + 2, '(')) return false;
+        call.name = tokens[pos + 1].text;
+        size_t close = findClose(pos + 2);
+        if (close == std::string::npos) return false;
+
+        size_t groupStart = pos + 3;
+        int depth = 0;
+        for (size_t i = groupStart; i <= close && groupStart < close; i++) {
+            if (i < close) {
+                if (isSymbol(i, '(')) depth++;
+                if (isSymbol(i, ')')) depth--;
+                if (!isSymbol(i, ',') || depth > 0) continue;
+            }
+            ReplProcessArg arg;
+            if (!parseProcessArg(groupStart, i, arg)) return false;
+            call.args.push_back(std::move(arg));
+            groupStart = i + 1;
+        }
+        pos = close + 1;
+        return true;
+    }
+
+    // [key=] name | number | "string" | (n, n, ...) | $call(...) in tokens [first, last)
+    bool parseProcessArg(size_t first, size_t last, ReplProcessArg& arg) const {
+        if (isIdentifier(first) && isSymbol(first + 1, '=')) {
+            arg.key = tokens[first].text;
+            first += 2;
+        }
+        if (first >= last) return false;
+
+        if (isSymbol(first, '$')) {
+            arg.kind = ReplProcessArg::Kind::CALL;
+            arg.call = std::make_shared<ReplProcessCall>();
+            size_t pos = first;
+            return parseProcessCall(pos, *arg.call) && pos == last;
+        }
+        if (last - first == 1 && tokens[first].type == ReplTokenType::STRING) {
+            arg.kind = ReplProcessArg::Kind::STRING;
+            arg.text = tokens[first].text;
+            return true;
+        }
+        if (last - first == 1 && isIdentifier(first)) {
+            arg.kind = ReplProcessArg::Kind::NAME;
+            arg.text = tokens[first].text;
+            return true;
+        }
+
+        // Numbers and tuples are folded constants (no t: parameters are baked into shaders)
+        bool tuple = isSymbol(first, '(') && findClose(first) == last - 1;
+        auto values = tuple ? parseArguments(first + 1, last - 1) : parseArguments(first, last);
+        if (!allNumbers(values, values.size()) || values.empty()) return false;
+        arg.kind = tuple ? ReplProcessArg::Kind::TUPLE : ReplProcessArg::Kind::NUMBER;
+        for (const auto& value : values) {
+            arg.numbers.push_back((float)value.number);
+        }
+        return tuple || values.size() == 1;
+    }
+
+    bool parseProperty(ReplStatement& statement) {
+        const std::string& property = tokens[2].text;
+        if (property != "canvas") {
+            return fail("unknown property '" + property + "'");
+        }
+
+        // Parentheses around the tuple are optional
+        size_t first = 4;
+        size_t last = tokens.size();
+        if (isSymbol(first, '(') && findClose(first) == last - 1) {
+            first++;
+            last--;
+        }
+        auto values = parseArguments(first, last);
+        if (!allNumbers(values, 2)) {
+            return fail("expected: " + statement.name + ".canvas = (WIDTH, HEIGHT)");
+        }
+
+        statement.type = ReplStatementType::SET_CANVAS;
+        statement.width = (int)values[0].number;
+        statement.height = (int)values[1].number;
+        return true;
+    }
+
+    bool parseMethodCall(ReplStatement& statement) {
+        size_t close = findClose(3);
+        if (close == std::string::npos) {
+            return fail("missing ')' in method call");
+        }
+
+        statement.type = ReplStatementType::METHOD_CALL;
+        statement.methodName = tokens[2].text;
+        statement.args = parseArguments(4, close);
+
+        // Argument shapes are fixed per method, so check them here rather than every run
+        const std::string& method = statement.methodName;
+        const auto& args = statement.args;
+        bool valid = true;
+        if (method == "transform") {
+            statement.method = ReplMethod::TRANSFORM;
+            valid = allNumeric(args, 2);
+        } else if (method == "scale") {
+            statement.method = ReplMethod::SCALE;
+            valid = allNumeric(args, 2);
+        } else if (method == "rot") {
+            statement.method = ReplMethod::ROT;
+            valid = allNumeric(args, 2);
+        } else if (method == "opacity") {
+            statement.method = ReplMethod::OPACITY;
+            valid = allNumeric(args, 1);
+        } else if (method == "cast") {
+            statement.method = ReplMethod::CAST;
+            valid = args.size() == 1;
+        } else if (method == "project") {
+            statement.method = ReplMethod::PROJECT;
+            valid = args.size() == 2 && args[1].isNumber;
+        }
+        if (!valid) {
+            return fail("bad arguments to " + statement.name + "." + method + "()");
+        }
+        return true;
+    }
+};
+
+// Split a line at ';' outside quotes and parentheses; empty pieces are dropped
+std::vector<std::string> splitStatements(const std::string& line) {
+    std::vector<std::string> pieces;
+    char quote = 0;
+    int depth = 0;
+    size_t start = 0;
+    for (size_t i = 0; i <= line.length(); i++) {
+        char c = i < line.length() ? line[i] : ';';
+        if (quote) {
+            if (c == quote) quote = 0;
+            continue;
+        }
+        if (c == '"' || c == '\'') {
+            quote = c;
+        } else if (c == '(') {
+            depth++;
+        } else if (c == ')') {
+            depth--;
+        } else if (c == ';' && (depth <= 0 || i == line.length())) {
+            std::string piece = line.substr(start, i - start);
+            if (piece.find_first_not_of(" \t\r") != std::string::npos) {
+                pieces.push_back(std::move(piece));
+            }
+            start = i + 1;
+        }
+    }
+    return pieces;
+}
+
+// Drop a trailing // comment (outside quotes) from one line
+std::string stripLineComment(const std::string& line) {
+    char quote = 0;
+    for (size_t i = 0; i < line.length(); i++) {
+        char c = line[i];
+        if (quote) {
+            if (c == quote) quote = 0;
+        } else if (c == '"' || c == '\'') {
+            quote = c;
+        } else if (c == '/' && i + 1 < line.length() && line[i + 1] == '/') {
+            return line.substr(0, i);
+        }
+    }
+    return line;
+}
+
+// Net '{' minus '}' outside quotes
+int braceDelta(const std::string& line) {
+    int delta = 0;
+    char quote = 0;
+    for (char c : line) {
+        if (quote) {
+            if (c == quote) quote = 0;
+        } else if (c == '"' || c == '\'') {
+            quote = c;
+        } else if (c == '{') {
+            delta++;
+        } else if (c == '}') {
+            delta--;
+        }
+    }
+    return delta;
+}
+
+} // namespace
+
+std::shared_ptr<ReplProgram> compileReplProgram(const std::string& source) {
+    auto program = std::make_shared<ReplProgram>();
+    program->source = source;
+    program->hash = hashReplSource(source);
+    program->statements.reserve(std::count(source.begin(), source.end(), '\n') + 1);
+
+    size_t start = 0;
+    int lineNumber = 0;
+    while (start < source.length()) {
+        size_t newline = source.find('\n', start);
+        size_t end = newline == std::string::npos ? source.length() : newline;
+        std::string line = source.substr(start, end - start);
+        start = end + 1;
+        lineNumber++;
+
+        // Skip blank lines and comments
+        size_t first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '/' || line[first] == '#') {
+            continue;
+        }
+
+        // process blocks run to the matching '}' and are parsed as one unit
+        if (line.compare(first, 7, "process") == 0 &&
+            (first + 7 == line.length() || !isalnum((unsigned char)line[first + 7]))) {
+            int blockLine = lineNumber;
+            std::string block = stripLineComment(line);
+            int depth = braceDelta(block);
+            bool opened = depth > 0 || block.find('{') != std::string::npos;
+            while ((!opened || depth > 0) && start < source.length()) {
+                newline = source.find('\n', start);
+                end = newline == std::string::npos ? source.length() : newline;
+                std::string next = stripLineComment(source.substr(start, end - start));
+                start = end + 1;
+                lineNumber++;
+                block += "\n" + next;
+                depth += braceDelta(next);
+                opened = opened || next.find('{') != std::string::npos;
+            }
+
+            ReplProcessDef def;
+            LineParser parser(block, blockLine, program->errors);
+            if (parser.parseProcess(def)) {
+                std::string name = def.name;
+                program->processes[name] = std::move(def);
+            }
+            continue;
+        }
+
+        // "a; b; c" is one group, applied all or nothing; a bad piece drops the group
+        std::vector<std::string> pieces = splitStatements(stripLineComment(line));
+        if (pieces.empty()) {
+            continue;
+        }
+        if (pieces.size() == 1) {
+            ReplStatement statement;
+            LineParser parser(pieces[0], lineNumber, program->errors);
+            if (parser.parse(statement)) {
+                program->statements.push_back(std::move(statement));
+            }
+            continue;
+        }
+
+        std::vector<ReplStatement> group(pieces.size());
+        bool valid = true;
+        for (size_t i = 0; i < pieces.size(); i++) {
+            LineParser parser(pieces[i], lineNumber, program->errors);
+            valid = parser.parse(group[i]) && valid;
+            group[i].group = lineNumber;
+        }
+        if (!valid) {
+            program->errors.push_back("line " + std::to_string(lineNumber) +
+                                      ": ';' group dropped (it applies all or nothing)");
+            continue;
+        }
+        for (auto& statement : group) {
+            program->statements.push_back(std::move(statement));
+        }
+    }
+
+    return program;
+}
@@ -0,0 +1,157 @@
+#include "repl_value.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+
+namespace {
+
+// Open addressing over FNV-1a hashes; programs intern every identifier they
+// mention, so this lookup is a large share of compiling a long preset
+struct SymbolTable {
+    struct Slot {
+        ReplSymbol symbol;  // symbol + 1, 0 = empty
+        uint32_t hash;      // Low bits of the name's hash, checked before the name
+        uint32_t offset;    // Name in chars
+        uint32_t length;
+    };
+    std::vector<Slot> slots;        // Power-of-two size
+    std::vector<char> chars;        // All names back to back (compared without chasing pointers)
+    std::vector<uint64_t> hashes;   // By symbol (for rehashing)
+    std::deque<std::string> names;  // By symbol; stable references for replSymbolName
+    std::mutex mutex;
+};
+
+SymbolTable& symbolTable() {
+    static SymbolTable table;
+    return table;
+}
+
+void appendNumber(double number, std::string& out) {
+    char buffer[32];
+    if (std::floor(number) == number && std::fabs(number) < 1e15) {
+        std::snprintf(buffer, sizeof(buffer), "%.0f", number);
+    } else {
+        std::snprintf(buffer, sizeof(buffer), "%.6g", number);
+    }
+    out += buffer;
+}
+
+} // namespace
+
+ReplSymbol internReplSymbol(const std::string& name) {
+    SymbolTable& table = symbolTable();
+    std::lock_guard<std::mutex> lock(table.mutex);
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : name) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+
+    size_t mask = table.slots.size() - 1;
+    size_t slot = hash & mask;
+    if (!table.slots.empty()) {
+        for (; table.slots[slot].symbol != 0; slot = (slot + 1) & mask) {
+            const SymbolTable::Slot& entry = table.slots[slot];
+            if (entry.hash == (uint32_t)hash && entry.length == name.length() &&
+                name.compare(0, name.length(), table.chars.data() + entry.offset, entry.length) == 0) {
+                return entry.symbol - 1;
+            }
+        }
+    }
+
+    ReplSymbol symbol = (ReplSymbol)table.names.size();
+    SymbolTable::Slot entry = {symbol + 1, (uint32_t)hash, (uint32_t)table.chars.size(),
+                               (uint32_t)name.length()};
+    table.chars.insert(table.chars.end(), name.begin(), name.end());
+    table.names.push_back(name);
+    table.hashes.push_back(hash);
+
+    // Keep the load under one half
+    if (table.names.size() * 2 > table.slots.size()) {
+        std::vector<SymbolTable::Slot> old(std::max<size_t>(64, table.slots.size() * 2));
+        old.swap(table.slots);
+        mask = table.slots.size() - 1;
+        old.push_back(entry);
+        for (const auto& moved : old) {
+            if (moved.symbol == 0) continue;
+            size_t free = table.hashes[moved.symbol - 1] & mask;
+            while (table.slots[free].symbol != 0) free = (free + 1) & mask;
+            table.slots[free] = moved;
+        }
+    } else {
+        table.slots[slot] = entry;
+    }
+    return symbol;
+}
+
+const std::string& replSymbolName(ReplSymbol symbol) {
+    SymbolTable& table = symbolTable();
+    std::lock_guard<std::mutex> lock(table.mutex);
+    return table.names[symbol];
+}
+
+size_t replSymbolCount() {
+    SymbolTable& table = symbolTable();
+    std::lock_guard<std::mutex> lock(table.mutex);
+    return table.names.size();
+}
+
+ReplValue ReplValue::makeNumber(double number) {
+    ReplValue value;
+    value.type = Type::NUMBER;
+    value.number = number;
+    return value;
+}
+
+ReplValue ReplValue::makeString(std::string text) {
+    ReplValue value;
+    value.type = Type::STRING;
+    value.text = std::move(text);
+    return value;
+}
+
+ReplValue ReplValue::makeTuple(std::vector<double> tuple) {
+    ReplValue value;
+    value.type = Type::TUPLE;
+    value.tuple = std::move(tuple);
+    return value;
+}
+
+ReplValue ReplValue::makeObject(ReplSymbol object) {
+    ReplValue value;
+    value.type = Type::OBJECT;
+    value.object = object;
+    return value;
+}
+
+void ReplValue::appendTo(std::string& out) const {
+    switch (type) {
+    case Type::NONE:
+        break;
+    case Type::NUMBER:
+        appendNumber(number, out);
+        break;
+    case Type::STRING:
+        out += text;
+        break;
+    case Type::TUPLE:
+        out += '(';
+        for (size_t i = 0; i < tuple.size(); i++) {
+            if (i > 0) out += ", ";
+            appendNumber(tuple[i], out);
+        }
+        out += ')';
+        break;
+    case Type::OBJECT:
+        out += replSymbolName(object);
+        break;
+    }
+}
+
+std::string ReplValue::toString() const {
+    std::string out;
+    appendTo(out);
+    return out;
+}
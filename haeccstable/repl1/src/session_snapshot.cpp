@@ -0,0 +1,269 @@
+#include "session_snapshot.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace {
+
+const char magic[8] = {'R', 'E', 'P', 'L', '1', 'S', 'N', 'P'};
+const size_t headerSize = sizeof(magic) + 4 + 4 + 8;  // magic, version, payload size, checksum
+
+uint64_t checksum(const char* data, size_t size) {
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= (unsigned char)data[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// Little-endian fields, whatever the host order
+class Writer {
+public:
+    explicit Writer(std::string& out) : out(out) {}
+
+    void u32(uint32_t value) {
+        for (int i = 0; i < 4; i++) out += (char)((value >> (8 * i)) & 0xff);
+    }
+    void u64(uint64_t value) {
+        for (int i = 0; i < 8; i++) out += (char)((value >> (8 * i)) & 0xff);
+    }
+    void i32(int value) { u32((uint32_t)value); }
+    void f32(float value) {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        u32(bits);
+    }
+    void str(const std::string& value) {
+        u32((uint32_t)value.size());
+        out += value;
+    }
+
+private:
+    std::string& out;
+};
+
+// Reads past the end set failed and return zeros, so a truncated file is one check
+class Reader {
+public:
+    Reader(const char* data, size_t size) : data(data), size(size), offset(0), failed(false) {}
+
+    bool ok() const { return !failed && offset == size; }
+
+    uint32_t u32() {
+        if (!take(4)) return 0;
+        uint32_t value = 0;
+        for (int i = 0; i < 4; i++) value |= (uint32_t)(unsigned char)data[offset - 4 + i] << (8 * i);
+        return value;
+    }
+    int i32() { return (int)u32(); }
+    float f32() {
+        uint32_t bits = u32();
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+    std::string str() {
+        uint32_t length = u32();
+        if (!take(length)) return "";
+        return std::string(data + offset - length, length);
+    }
+
+    // Element count, bounded by what the remaining bytes could hold
+    uint32_t count(size_t minElementSize) {
+        uint32_t value = u32();
+        if (value > (size - offset) / minElementSize) {
+            failed = true;
+            return 0;
+        }
+        return value;
+    }
+
+private:
+    const char* data;
+    size_t size;
+    size_t offset;
+    bool failed;
+
+    bool take(size_t bytes) {
+        if (failed || bytes > size - offset) {
+            failed = true;
+            return false;
+        }
+        offset += bytes;
+        return true;
+    }
+};
+
+} // namespace
+
+void encodeSessionSnapshot(const SessionSnapshot& snapshot, std::string& out) {
+    out.assign(headerSize, '\0');
+    Writer writer(out);
+
+    writer.str(snapshot.program);
+
+    writer.u32((uint32_t)snapshot.sources.size());
+    for (const auto& source : snapshot.sources) {
+        writer.str(source.name);
+        writer.i32(source.deviceIndex);
+        writer.str(source.deviceName);
+        writer.i32(source.width);
+        writer.i32(source.height);
+        writer.u32((uint32_t)source.inputSizes.size());
+        for (const auto& size : source.inputSizes) {
+            writer.i32(size.first);
+            writer.i32(size.second);
+        }
+    }
+
+    writer.u32((uint32_t)snapshot.layers.size());
+    for (const auto& layer : snapshot.layers) {
+        writer.str(layer.name);
+        writer.i32(layer.canvasWidth);
+        writer.i32(layer.canvasHeight);
+        writer.i32(layer.framebufferWidth);
+        writer.i32(layer.framebufferHeight);
+        writer.f32(layer.posX);
+        writer.f32(layer.posY);
+        writer.f32(layer.scaleX);
+        writer.f32(layer.scaleY);
+        writer.f32(layer.rotXY);
+        writer.f32(layer.rotY);
+        writer.f32(layer.opacity);
+        writer.str(layer.sourceName);
+    }
+
+    writer.u32((uint32_t)snapshot.outputs.size());
+    for (const auto& output : snapshot.outputs) {
+        writer.str(output.name);
+        writer.str(output.target);
+        writer.i32(output.width);
+        writer.i32(output.height);
+        writer.u32((uint32_t)output.stack.size());
+        for (const auto& entry : output.stack) {
+            writer.str(entry.first);
+            writer.i32(entry.second);
+        }
+    }
+
+    // Header last: it covers the payload
+    std::string header;
+    Writer headerWriter(header);
+    header.append(magic, sizeof(magic));
+    headerWriter.u32(SessionSnapshot::VERSION);
+    headerWriter.u32((uint32_t)(out.size() - headerSize));
+    headerWriter.u64(checksum(out.data() + headerSize, out.size() - headerSize));
+    out.replace(0, headerSize, header);
+}
+
+bool decodeSessionSnapshot(const std::string& data, SessionSnapshot& snapshot, std::string& error) {
+    if (data.size() < headerSize || std::memcmp(data.data(), magic, sizeof(magic)) != 0) {
+        error = "not a session snapshot";
+        return false;
+    }
+    Reader header(data.data() + sizeof(magic), headerSize - sizeof(magic));
+    uint32_t version = header.u32();
+    uint32_t payloadSize = header.u32();
+    uint64_t expected = (uint64_t)header.u32() | ((uint64_t)header.u32() << 32);
+    if (version != SessionSnapshot::VERSION) {
+        error = "snapshot version " + std::to_string(version) + ", expected " +
+                std::to_string(SessionSnapshot::VERSION);
+        return false;
+    }
+    if (payloadSize != data.size() - headerSize ||
+        checksum(data.data() + headerSize, payloadSize) != expected) {
+        error = "snapshot is damaged (size or checksum mismatch)";
+        return false;
+    }
+
+    Reader reader(data.data() + headerSize, payloadSize);
+    SessionSnapshot result;
+    result.program = reader.str();
+
+    result.sources.resize(reader.count(24));
+    for (auto& source : result.sources) {
+        source.name = reader.str();
+        source.deviceIndex = reader.i32();
+        source.deviceName = reader.str();
+        source.width = reader.i32();
+        source.height = reader.i32();
+        source.inputSizes.resize(reader.count(8));
+        for (auto& size : source.inputSizes) {
+            size.first = reader.i32();
+            size.second = reader.i32();
+        }
+    }
+
+    result.layers.resize(reader.count(52));
+    for (auto& layer : result.layers) {
+        layer.name = reader.str();
+        layer.canvasWidth = reader.i32();
+        layer.canvasHeight = reader.i32();
+        layer.framebufferWidth = reader.i32();
+        layer.framebufferHeight = reader.i32();
+        layer.posX = reader.f32();
+        layer.posY = reader.f32();
+        layer.scaleX = reader.f32();
+        layer.scaleY = reader.f32();
+        layer.rotXY = reader.f32();
+        layer.rotY = reader.f32();
+        layer.opacity = reader.f32();
+        layer.sourceName = reader.str();
+    }
+
+    result.outputs.resize(reader.count(20));
+    for (auto& output : result.outputs) {
+        output.name = reader.str();
+        output.target = reader.str();
+        output.width = reader.i32();
+        output.height = reader.i32();
+        output.stack.resize(reader.count(8));
+        for (auto& entry : output.stack) {
+            entry.first = reader.str();
+            entry.second = reader.i32();
+        }
+    }
+
+    if (!reader.ok()) {
+        error = "snapshot is damaged (bad layout)";
+        return false;
+    }
+    snapshot = std::move(result);
+    return true;
+}
+
+bool writeSessionSnapshot(const std::string& filename, const std::string& encoded, std::string& error) {
+    std::string tempFilename = filename + ".tmp";
+    std::ofstream file(tempFilename, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        error = "Failed to open " + tempFilename + " for writing";
+        return false;
+    }
+    file.write(encoded.data(), (std::streamsize)encoded.size());
+    file.close();
+    if (!file) {
+        error = "Failed to write " + tempFilename;
+        return false;
+    }
+    if (std::rename(tempFilename.c_str(), filename.c_str()) != 0) {
+        error = "Failed to replace " + filename;
+        return false;
+    }
+    return true;
+}
+
+bool readSessionSnapshot(const std::string& filename, SessionSnapshot& snapshot, std::string& error) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        error = "Could not open " + filename;
+        return false;
+    }
+    std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (!decodeSessionSnapshot(data, snapshot, error)) {
+        error = filename + ": " + error;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,100 @@
+#include "shader.h"
+#include <iostream>
+
+// OpenGL constants missing from minimal GLAD loader
+#ifndef GL_ACTIVE_UNIFORMS
+#define GL_ACTIVE_UNIFORMS 0x8B86
+#endif
+#ifndef GL_INVALID_INDEX
+#define GL_INVALID_INDEX 0xFFFFFFFFu
+#endif
+
+Shader::Shader() : program(0) {
+}
+
+Shader::~Shader() {
+    if (program) glDeleteProgram(program);
+}
+
+GLuint Shader::compileShader(const char* source, GLenum shaderType) {
+    GLuint shader = glCreateShader(shaderType);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+
+    // Check for compilation errors
+    GLint success;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        char infoLog[512];
+        glGetShaderInfoLog(shader, 512, nullptr, infoLog);
+        std::cerr << "Shader compilation failed:\n" << infoLog << "\n";
+        glDeleteShader(shader);
+        return 0;
+    }
+
+    return shader;
+}
+
+bool Shader::load(const char* vertexSrc, const char* fragmentSrc) {
+    GLuint vertexShader = compileShader(vertexSrc, GL_VERTEX_SHADER);
+    if (vertexShader == 0) return false;
+
+    GLuint fragmentShader = compileShader(fragmentSrc, GL_FRAGMENT_SHADER);
+    if (fragmentShader == 0) {
+        glDeleteShader(vertexShader);
+        return false;
+    }
+
+    program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glLinkProgram(program);
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+
+    // Check for linking errors
+    GLint success;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        char infoLog[512];
+        glGetProgramInfoLog(program, 512, nullptr, infoLog);
+        std::cerr << "Shader program linking failed:\n" << infoLog << "\n";
+        glDeleteProgram(program);
+        program = 0;
+        return false;
+    }
+
+    // Resolve every active uniform once so draws never do string lookups
+    GLint uniformCount = 0;
+    glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &uniformCount);
+    for (GLint i = 0; i < uniformCount; i++) {
+        char name[128];
+        GLsizei length = 0;
+        GLint size;
+        GLenum type;
+        glGetActiveUniform(program, i, sizeof(name), &length, &size, &type, name);
+
+        // Members of uniform blocks report -1 and are reached through the UBO
+        GLint location = glGetUniformLocation(program, name);
+        if (location >= 0) {
+            uniformLocations[std::string(name, length)] = location;
+        }
+    }
+
+    return true;
+}
+
+GLint Shader::uniform(const std::string& name) const {
+    auto it = uniformLocations.find(name);
+    return it != uniformLocations.end() ? it->second : -1;
+}
+
+bool Shader::bindUniformBlock(const char* blockName, GLuint binding) {
+    GLuint index = glGetUniformBlockIndex(program, blockName);
+    if (index == GL_INVALID_INDEX) {
+        std::cerr << "ERROR: Uniform block '" << blockName << "' not found\n";
+        return false;
+    }
+    glUniformBlockBinding(program, index, binding);
+    return true;
+}
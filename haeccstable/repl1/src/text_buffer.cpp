@@ -3,7 +3,7 @@
 
 TextBuffer::TextBuffer(int maxLines)
     : cursorRow(0), cursorCol(0), mode(VimMode::NORMAL),
-      maxLines(maxLines), scrollOffset(0), visibleLines(20) {
+      maxLines(maxLines), scrollOffset(0), visibleLines(20), revision(0), evictedLines(0) {
     // Start with one empty line
     lines.push_back("");
 }
@@ -133,24 +133,22 @@ void TextBuffer::insertChar(char c) {
 
     lines[cursorRow].insert(cursorCol, 1, c);
     cursorCol++;
+    revision++;
 }
 
 void TextBuffer::insertNewline() {
     if (cursorRow >= lines.size()) return;
 
-    std::string currentLine = lines[cursorRow];
-    std::string afterCursor = currentLine.substr(cursorCol);
-    lines[cursorRow] = currentLine.substr(0, cursorCol);
+    std::string afterCursor = lines[cursorRow].substr(cursorCol);
+    lines[cursorRow].erase(cursorCol);
 
     cursorRow++;
     cursorCol = 0;
-    lines.insert(lines.begin() + cursorRow, afterCursor);
+    lines.insert(cursorRow, afterCursor);
+    revision++;
 
     // Trim if exceeding max lines
-    while (lines.size() > maxLines) {
-        lines.erase(lines.begin());
-        cursorRow--;
-    }
+    trimToMaxLines();
 }
 
 void TextBuffer::deleteChar() {
@@ -161,8 +159,9 @@ void TextBuffer::deleteChar() {
     } else if (cursorRow < lines.size() - 1) {
         // Join with next line
         lines[cursorRow] += lines[cursorRow + 1];
-        lines.erase(lines.begin() + cursorRow + 1);
+        lines.erase(cursorRow + 1);
     }
+    revision++;
     ensureCursorValid();
 }
 
@@ -174,9 +173,10 @@ void TextBuffer::deleteCharBefore() {
         // Join with previous line
         int prevLineLen = lines[cursorRow - 1].length();
         lines[cursorRow - 1] += lines[cursorRow];
-        lines.erase(lines.begin() + cursorRow);
+        lines.erase(cursorRow);
         cursorRow--;
         cursorCol = prevLineLen;
+        revision++;
     }
 }
 
@@ -186,15 +186,125 @@ void TextBuffer::deleteLine() {
         lines[0] = "";
         cursorCol = 0;
     } else {
-        lines.erase(lines.begin() + cursorRow);
+        lines.erase(cursorRow);
         if (cursorRow >= lines.size()) {
             cursorRow = lines.size() - 1;
         }
         cursorCol = 0;
     }
+    revision++;
+    ensureCursorValid();
+}
+
+void TextBuffer::setText(const std::string& text) {
+    lines.clear();
+    lines.push_back("");
+    cursorRow = 0;
+    cursorCol = 0;
+    scrollOffset = 0;
+
+    // Same line split as std::getline: a trailing newline ends the last line
+    std::string body = text;
+    if (!body.empty() && body.back() == '\n') {
+        body.pop_back();
+    }
+    insertText(0, 0, body);
+
+    cursorRow = 0;
+    cursorCol = 0;
+    ensureCursorValid();
+}
+
+void TextBuffer::insertText(int row, int col, const std::string& text) {
+    if (lines.empty()) {
+        lines.push_back("");
+    }
+    row = std::max(0, std::min(row, (int)lines.size() - 1));
+    col = std::max(0, std::min(col, (int)lines[row].length()));
+
+    // Split once; the text after the insertion point moves to the last new line
+    std::vector<std::string> newLines;
+    size_t start = 0;
+    size_t newline = text.find('\n');
+    std::string& line = lines[row];
+    std::string tail = line.substr(col);
+    line.erase(col);
+    line.append(text, 0, newline == std::string::npos ? std::string::npos : newline);
+    while (newline != std::string::npos) {
+        start = newline + 1;
+        newline = text.find('\n', start);
+        newLines.push_back(text.substr(start, newline == std::string::npos ? std::string::npos : newline - start));
+    }
+
+    cursorRow = row + (int)newLines.size();
+    if (newLines.empty()) {
+        cursorCol = (int)line.length();
+        line += tail;
+    } else {
+        cursorCol = (int)newLines.back().length();
+        newLines.back() += tail;
+        lines.insert(row + 1, std::move(newLines));
+    }
+    revision++;
+
+    trimToMaxLines();
     ensureCursorValid();
 }
 
+void TextBuffer::replaceRange(int startRow, int startCol, int endRow, int endCol, const std::string& text) {
+    if (lines.empty()) {
+        lines.push_back("");
+    }
+    int lastRow = (int)lines.size() - 1;
+    startRow = std::max(0, std::min(startRow, lastRow));
+    endRow = std::max(startRow, std::min(endRow, lastRow));
+    startCol = std::max(0, std::min(startCol, (int)lines[startRow].length()));
+    endCol = std::max(0, std::min(endCol, (int)lines[endRow].length()));
+    if (endRow == startRow) {
+        endCol = std::max(endCol, startCol);
+    }
+
+    // Join the kept head of startRow with the kept tail of endRow, drop the rows between
+    std::string tail = lines[endRow].substr(endCol);
+    lines[startRow].erase(startCol);
+    lines[startRow] += tail;
+    if (endRow > startRow) {
+        lines.erase(startRow + 1, endRow - startRow);
+    }
+
+    insertText(startRow, startCol, text);
+}
+
+void TextBuffer::clear() {
+    lines.clear();
+    lines.push_back("");
+    cursorRow = 0;
+    cursorCol = 0;
+    scrollOffset = 0;
+    revision++;
+}
+
+std::string TextBuffer::getText() const {
+    size_t length = 0;
+    for (const auto& line : lines) {
+        length += line.length() + 1;
+    }
+
+    std::string text;
+    text.reserve(length);
+    for (const auto& line : lines) {
+        text += line;
+        text += '\n';
+    }
+    return text;
+}
+
+void TextBuffer::trimToMaxLines() {
+    while (lines.size() > maxLines) {
+        evictOldestLine();
+    }
+}
+
 std::string TextBuffer::getCurrentLine() const {
     if (cursorRow < lines.size()) {
         return lines[cursorRow];
@@ -220,13 +330,23 @@ void TextBuffer::scrollDown() {
 
 void TextBuffer::addOutputLine(const std::string& line) {
     lines.push_back(line);
+    revision++;
 
     // Trim if exceeding max lines
-    while (lines.size() > maxLines) {
-        lines.erase(lines.begin());
-        if (scrollOffset > 0) {
-            scrollOffset--;
-        }
+    trimToMaxLines();
+}
+
+void TextBuffer::evictOldestLine() {
+    // O(1): the ring drops its first line without shifting the rest
+    lines.pop_front();
+    evictedLines++;
+
+    // Row indices all moved up by one; follow the text that stays
+    if (scrollOffset > 0) {
+        scrollOffset--;
+    }
+    if (cursorRow > 0) {
+        cursorRow--;
     }
 }
 
@@ -0,0 +1,257 @@
+#include "thread_pool.h"
+#include <algorithm>
+#include <chrono>
+
+namespace {
+
+// Which pool (if any) the current thread works for, and its slot there
+thread_local const ThreadPool* currentPool = nullptr;
+thread_local int currentIndex = 0;
+
+// State of one parallelFor, shared with its helper tasks: a helper that only
+// starts after the loop has returned finds the counter exhausted and leaves
+struct LoopState {
+    const std::function<void(int, int, int)>* fn;
+    int count;
+    int grain;
+    std::atomic<int> nextIndex;
+    std::atomic<int> remaining;  // Indices not finished yet
+    std::mutex mutex;
+    std::condition_variable done;
+};
+
+void runChunks(LoopState& loop, int worker) {
+    for (;;) {
+        int begin = loop.nextIndex.fetch_add(loop.grain);
+        if (begin >= loop.count) return;
+        int end = std::min(loop.count, begin + loop.grain);
+        (*loop.fn)(begin, end, worker);
+        if (loop.remaining.fetch_sub(end - begin) == end - begin) {
+            std::lock_guard<std::mutex> lock(loop.mutex);
+            loop.done.notify_all();
+        }
+    }
+}
+
+} // namespace
+
+ThreadPool::ThreadPool(int threads)
+    : queuedTasks(0), stopping(false), mainThreadWakeup(nullptr) {
+    if (threads <= 0) {
+        threads = std::max(1, (int)std::thread::hardware_concurrency());
+    }
+    for (int i = 0; i < threads; i++) {
+        queues.push_back(std::make_unique<WorkerQueue>());
+    }
+    for (int i = 1; i < threads; i++) {
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+ThreadPool& ThreadPool::shared() {
+    static ThreadPool pool(std::max(2, (int)std::thread::hardware_concurrency()));
+    return pool;
+}
+
+int ThreadPool::currentWorker() const {
+    return currentPool == this ? currentIndex : 0;
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    if (workers.empty()) {
+        task();  // Nobody else to run it
+        return;
+    }
+
+    WorkerQueue& queue = *queues[currentWorker()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+        queuedTasks.fetch_add(1);
+    }
+    {
+        // Empty critical section: a worker between its check and its wait holds this
+        std::lock_guard<std::mutex> lock(sleepMutex);
+    }
+    wake.notify_one();
+}
+
+bool ThreadPool::popTask(int worker, std::function<void()>& task) {
+    {
+        WorkerQueue& own = *queues[worker];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            queuedTasks.fetch_sub(1);
+            return true;
+        }
+    }
+
+    int count = (int)queues.size();
+    for (int i = 1; i < count; i++) {
+        WorkerQueue& victim = *queues[(worker + i) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            queuedTasks.fetch_sub(1);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ThreadPool::runOneTask() {
+    std::function<void()> task;
+    if (!popTask(currentWorker(), task)) return false;
+    task();
+    return true;
+}
+
+void ThreadPool::workerLoop(int worker) {
+    currentPool = this;
+    currentIndex = worker;
+
+    std::function<void()> task;
+    for (;;) {
+        if (popTask(worker, task)) {
+            task();
+            task = nullptr;  // Release captures before sleeping
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wake.wait(lock, [&] { return stopping || queuedTasks.load() > 0; });
+        if (stopping && queuedTasks.load() == 0) return;
+    }
+}
+
+void ThreadPool::parallelFor(int count, int grain, const std::function<void(int, int, int)>& fn) {
+    if (count <= 0) return;
+    grain = std::max(1, grain);
+
+    // Nothing to share: skip the hand-off
+    int chunks = (count + grain - 1) / grain;
+    int helpers = std::min((int)workers.size(), chunks - 1);
+    if (helpers <= 0) {
+        fn(0, count, currentWorker());
+        return;
+    }
+
+    auto loop = std::make_shared<LoopState>();
+    loop->fn = &fn;
+    loop->count = count;
+    loop->grain = grain;
+    loop->nextIndex = 0;
+    loop->remaining = count;
+    for (int i = 0; i < helpers; i++) {
+        submit([this, loop]() { runChunks(*loop, currentWorker()); });
+    }
+
+    runChunks(*loop, currentWorker());
+
+    // Only chunks already running elsewhere are left
+    std::unique_lock<std::mutex> lock(loop->mutex);
+    loop->done.wait(lock, [&] { return loop->remaining.load() == 0; });
+}
+
+void ThreadPool::runOnMainThread(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mainThreadMutex);
+        mainThreadTasks.push_back(std::move(task));
+    }
+    if (auto wakeup = mainThreadWakeup.load()) {
+        wakeup();
+    }
+}
+
+int ThreadPool::runMainThreadTasks() {
+    std::vector<std::function<void()>> tasks;
+    {
+        std::lock_guard<std::mutex> lock(mainThreadMutex);
+        tasks.swap(mainThreadTasks);
+    }
+    // Tasks queued while these run wait for the next frame
+    for (auto& task : tasks) {
+        task();
+    }
+    return (int)tasks.size();
+}
+
+TaskGroup::TaskGroup(ThreadPool& pool)
+    : pool(pool), pending(0), continuationOnMainThread(false) {
+}
+
+TaskGroup::~TaskGroup() {
+    wait();
+}
+
+void TaskGroup::run(std::function<void()> task) {
+    pending.fetch_add(1);
+    pool.submit([this, task = std::move(task)]() {
+        task();
+        finishTask();
+    });
+}
+
+void TaskGroup::finishTask() {
+    ThreadPool& target = pool;  // The group may be gone once the lock is released
+    std::function<void()> next;
+    bool onMainThread = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (pending.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+        next.swap(continuation);
+        onMainThread = continuationOnMainThread;
+        finished.notify_all();
+    }
+    if (next) {
+        if (onMainThread) target.runOnMainThread(std::move(next));
+        else target.submit(std::move(next));
+    }
+}
+
+void TaskGroup::then(std::function<void()> task, bool onMainThread) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (pending.load() > 0) {
+            continuation = std::move(task);
+            continuationOnMainThread = onMainThread;
+            return;
+        }
+    }
+    dispatch(std::move(task), onMainThread);
+}
+
+void TaskGroup::dispatch(std::function<void()> task, bool onMainThread) {
+    if (onMainThread) pool.runOnMainThread(std::move(task));
+    else pool.submit(std::move(task));
+}
+
+void TaskGroup::wait() {
+    // A worker keeps its thread busy with queued tasks (often this group's own)
+    if (pool.currentWorker() != 0) {
+        while (!isDone()) {
+            if (!pool.runOneTask()) {
+                std::unique_lock<std::mutex> lock(mutex);
+                finished.wait_for(lock, std::chrono::milliseconds(1), [&] { return isDone(); });
+            }
+        }
+    }
+
+    // Taking the lock also waits out the last finishTask()
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [&] { return isDone(); });
+}
@@ -1,7 +1,9 @@
 #include "video_source.h"
+#include "thread_pool.h"
 #import <AVFoundation/AVFoundation.h>
 #import <CoreMedia/CoreMedia.h>
 #import <CoreGraphics/CoreGraphics.h>
+#include <algorithm>
 #include <iostream>
 #include <mutex>
 
@@ -49,20 +51,23 @@
     OSType pixelFormat = CVPixelBufferGetPixelFormatType(imageBuffer);
 
     if (pixelFormat == kCVPixelFormatType_32BGRA) {
-        // Convert BGRA to RGB
+        // Convert BGRA to RGB, rows split across the shared pool
         uint8_t* src = (uint8_t*)CVPixelBufferGetBaseAddress(imageBuffer);
         size_t bytesPerRow = CVPixelBufferGetBytesPerRow(imageBuffer);
 
-        for (size_t y = 0; y < height; y++) {
-            for (size_t x = 0; x < width; x++) {
-                size_t srcIdx = y * bytesPerRow + x * 4;
-                size_t dstIdx = (y * width + x) * 3;
-
-                frame->data[dstIdx + 0] = src[srcIdx + 2];  // R
-                frame->data[dstIdx + 1] = src[srcIdx + 1];  // G
-                frame->data[dstIdx + 2] = src[srcIdx + 0];  // B
+        uint8_t* dst = frame->data.get();
+        ThreadPool::shared().parallelFor((int)height, std::max(1, 65536 / (int)std::max<size_t>(1, width)),
+                                         [&](int begin, int end, int) {
+            for (size_t y = (size_t)begin; y < (size_t)end; y++) {
+                const uint8_t* srcRow = src + y * bytesPerRow;
+                uint8_t* dstRow = dst + y * width * 3;
+                for (size_t x = 0; x < width; x++) {
+                    dstRow[x * 3 + 0] = srcRow[x * 4 + 2];  // R
+                    dstRow[x * 3 + 1] = srcRow[x * 4 + 1];  // G
+                    dstRow[x * 3 + 2] = srcRow[x * 4 + 0];  // B
+                }
             }
-        }
+        });
     }
 
     // Set timestamp
@@ -92,7 +97,8 @@ VideoSource::VideoSource()
     : captureSession(nil), captureDevice(nil), deviceInput(nil),
       videoOutput(nil), frameDelegate(nil),
       isActive(false), frameWidth(0), frameHeight(0),
-      hasNewFrame(false) {
+      middleSlot(1), backSlot(0), frontSlot(2), frontUnread(false),
+      deliveredFrames(0), droppedFrames(0) {
 }
 
 VideoSource::~VideoSource() {
@@ -206,19 +212,19 @@ bool VideoSource::open(const std::string& deviceId) {
 }
 
 void VideoSource::onNewFrame(std::shared_ptr<VideoFrame> frame) {
-    // Called from delegate thread - store latest frame
-    latestFrame = frame;
-    hasNewFrame = true;
+    // Called from delegate thread - publish as the latest frame (never waits)
+    putFrame(std::move(frame));
 }
 
 std::optional<std::shared_ptr<VideoFrame>> VideoSource::getFrame() {
     // Lazy evaluation: only return frame if new one is available
-    if (!isActive || !hasNewFrame) {
+    takeNewFrame();
+    if (!isActive || !frontUnread) {
         return std::nullopt;
     }
 
-    hasNewFrame = false;  // Mark as consumed
-    return latestFrame;   // Return shared_ptr (zero-copy)
+    frontUnread = false;  // Mark as consumed
+    return frameSlots[frontSlot];  // Return shared_ptr (zero-copy)
 }
 
 void VideoSource::close() {
@@ -234,8 +240,14 @@ void VideoSource::close() {
     frameDelegate = nil;
     captureDevice = nil;
 
-    latestFrame.reset();
-    hasNewFrame = false;
+    // Capture has stopped: the mailbox is ours
+    for (auto& slot : frameSlots) {
+        slot.reset();
+    }
+    middleSlot.store(1, std::memory_order_relaxed);
+    backSlot = 0;
+    frontSlot = 2;
+    frontUnread = false;
     isActive = false;
 
     std::cout << "Video source closed" << std::endl;
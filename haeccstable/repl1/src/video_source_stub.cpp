@@ -0,0 +1,61 @@
+#include "video_source.h"
+#include <iostream>
+
+// Non-Apple build of VideoSource (Linux CI / Xvfb)
+// AVFoundation capture is unavailable, so no devices are enumerated or opened
+
+VideoFrame::VideoFrame(int w, int h)
+    : width(w), height(h), dataSize(w * h * 3), timestamp(0.0) {
+    data = std::make_unique<uint8_t[]>(dataSize);
+}
+
+VideoSource::VideoSource()
+    : captureSession(nullptr), captureDevice(nullptr), deviceInput(nullptr),
+      videoOutput(nullptr), frameDelegate(nullptr),
+      isActive(false), frameWidth(0), frameHeight(0),
+      middleSlot(1), backSlot(0), frontSlot(2), frontUnread(false),
+      deliveredFrames(0), droppedFrames(0) {
+}
+
+VideoSource::~VideoSource() {
+    close();
+}
+
+std::vector<VideoSource::DeviceInfo> VideoSource::enumerateDevices() {
+    return {};
+}
+
+bool VideoSource::open(int deviceIndex) {
+    std::cerr << "Video capture not supported on this platform (device " << deviceIndex << ")" << std::endl;
+    return false;
+}
+
+bool VideoSource::open(const std::string& deviceId) {
+    std::cerr << "Video capture not supported on this platform (device " << deviceId << ")" << std::endl;
+    return false;
+}
+
+void VideoSource::onNewFrame(std::shared_ptr<VideoFrame> frame) {
+    putFrame(std::move(frame));
+}
+
+std::optional<std::shared_ptr<VideoFrame>> VideoSource::getFrame() {
+    takeNewFrame();
+    if (!isActive || !frontUnread) {
+        return std::nullopt;
+    }
+
+    frontUnread = false;
+    return frameSlots[frontSlot];
+}
+
+void VideoSource::close() {
+    for (auto& slot : frameSlots) {
+        slot.reset();
+    }
+    middleSlot.store(1, std::memory_order_relaxed);
+    backSlot = 0;
+    frontSlot = 2;
+    frontUnread = false;
+    isActive = false;
+}
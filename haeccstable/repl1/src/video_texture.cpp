@@ -3,7 +3,7 @@
 
 VideoTexture::VideoTexture()
     : textureID(0), pboID(0), width(0), height(0),
-      usePBO(false), lastFrameTimestamp(-1.0) {  // Disable PBO - GLAD loader too minimal
+      usePBO(true), lastFrameTimestamp(-1.0) {
 }
 
 VideoTexture::~VideoTexture() {
@@ -33,39 +33,49 @@ bool VideoTexture::init(int w, int h) {
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, width, height, 0,
                  GL_RGB, GL_UNSIGNED_BYTE, nullptr);
 
-    // Create PBO for async uploads (if supported)
-    if (usePBO) {
-        glGenBuffers(1, &pboID);
-        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pboID);
-        glBufferData(GL_PIXEL_UNPACK_BUFFER, width * height * 3,
-                     nullptr, GL_STREAM_DRAW);
-        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
-    }
-
     glBindTexture(GL_TEXTURE_2D, 0);
 
-    std::cout << "VideoTexture initialized: " << width << "x" << height
-              << (usePBO ? " (with PBO)" : "") << std::endl;
+    std::cout << "VideoTexture initialized: " << width << "x" << height << std::endl;
 
     return true;
 }
 
-void VideoTexture::update(std::shared_ptr<VideoFrame> frame) {
-    if (!frame || !textureID) return;
+bool VideoTexture::update(std::shared_ptr<VideoFrame> frame) {
+    if (!frame || !textureID) return false;
 
     // Lazy update: skip if same frame
     if (frame->timestamp == lastFrameTimestamp) {
-        return;
+        return false;
     }
 
     glBindTexture(GL_TEXTURE_2D, textureID);
 
-    // Direct upload (synchronous) - using glTexImage2D since glTexSubImage2D not in minimal GLAD
-    // This re-uploads the entire texture, which is less efficient but works
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, frame->width, frame->height, 0,
-                 GL_RGB, GL_UNSIGNED_BYTE, frame->data.get());
+    // Storage is allocated once; only a source changing size re-specifies it
+    if (frame->width != width || frame->height != height) {
+        width = frame->width;
+        height = frame->height;
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, width, height, 0,
+                     GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+    }
+
+    if (usePBO) {
+        // Orphan the buffer so the copy never waits for the GPU to finish reading
+        // the previous frame; the PBO-to-texture transfer then runs on the GPU's
+        // timeline while the CPU moves on to the next frame
+        if (!pboID) {
+            glGenBuffers(1, &pboID);  // First upload (render targets never get one)
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pboID);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, frame->dataSize, nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_PIXEL_UNPACK_BUFFER, 0, frame->dataSize, frame->data.get());
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    } else {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, frame->data.get());
+    }
 
     glBindTexture(GL_TEXTURE_2D, 0);
 
     lastFrameTimestamp = frame->timestamp;
+    return true;
 }
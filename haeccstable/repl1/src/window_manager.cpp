@@ -12,7 +12,7 @@ static void framebufferSizeCallback(GLFWwindow* window, int width, int height) {
 
 WindowManager::WindowManager(int width, int height, const char* title)
     : window(nullptr), windowedWidth(width), windowedHeight(height),
-      windowedPosX(0), windowedPosY(0), isFullscreen(false) {
+      windowedPosX(0), windowedPosY(0), isFullscreen(false), swapInterval(1) {
 }
 
 WindowManager::~WindowManager() {
@@ -54,7 +54,7 @@ bool WindowManager::init() {
     glfwSetFramebufferSizeCallback(window, framebufferSizeCallback);
 
     // Enable vsync
-    glfwSwapInterval(1);
+    glfwSwapInterval(swapInterval);
 
     return true;
 }
@@ -92,6 +92,48 @@ void WindowManager::pollEvents() {
     glfwPollEvents();
 }
 
+void WindowManager::waitEvents(double timeoutSeconds) {
+    glfwWaitEventsTimeout(timeoutSeconds);
+}
+
+void WindowManager::setSwapInterval(int interval) {
+    if (interval == swapInterval) return;
+    swapInterval = interval;
+
+    GLFWwindow* previous = glfwGetCurrentContext();
+    glfwMakeContextCurrent(window);
+    glfwSwapInterval(interval);
+    glfwMakeContextCurrent(previous);
+}
+
+int WindowManager::getMonitorIndex() {
+    int count = 0;
+    GLFWmonitor** monitors = glfwGetMonitors(&count);
+
+    GLFWmonitor* fullscreenMonitor = glfwGetWindowMonitor(window);
+    int x, y, width, height;
+    glfwGetWindowPos(window, &x, &y);
+    glfwGetWindowSize(window, &width, &height);
+    int centerX = x + width / 2;
+    int centerY = y + height / 2;
+
+    for (int i = 0; i < count; i++) {
+        if (fullscreenMonitor) {
+            if (monitors[i] == fullscreenMonitor) return i;
+            continue;
+        }
+        const GLFWvidmode* mode = glfwGetVideoMode(monitors[i]);
+        if (!mode) continue;
+        int monitorX, monitorY;
+        glfwGetMonitorPos(monitors[i], &monitorX, &monitorY);
+        if (centerX >= monitorX && centerX < monitorX + mode->width &&
+            centerY >= monitorY && centerY < monitorY + mode->height) {
+            return i;
+        }
+    }
+    return -1;
+}
+
 void WindowManager::getFramebufferSize(int* width, int* height) {
     glfwGetFramebufferSize(window, width, height);
 }